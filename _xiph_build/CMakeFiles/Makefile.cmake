@@ -0,0 +1,233 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/addons/CMakeLists.txt"
+  "/root/repo/addons/acodec/CMakeLists.txt"
+  "/root/repo/addons/acodec/allegro5/internal/aintern_acodec_cfg.h.cmake"
+  "/root/repo/addons/audio/CMakeLists.txt"
+  "/root/repo/addons/audio/allegro5/internal/aintern_audio_cfg.h.cmake"
+  "/root/repo/addons/color/CMakeLists.txt"
+  "/root/repo/addons/font/CMakeLists.txt"
+  "/root/repo/addons/image/CMakeLists.txt"
+  "/root/repo/addons/image/allegro5/internal/aintern_image_cfg.h.cmake"
+  "/root/repo/addons/main/CMakeLists.txt"
+  "/root/repo/addons/memfile/CMakeLists.txt"
+  "/root/repo/addons/native_dialog/CMakeLists.txt"
+  "/root/repo/addons/primitives/CMakeLists.txt"
+  "/root/repo/addons/ttf/CMakeLists.txt"
+  "/root/repo/addons/ttf/allegro5/internal/aintern_ttf_cfg.h.cmake"
+  "/root/repo/addons/video/CMakeLists.txt"
+  "/root/repo/cmake/AllegroFindFFMPEG.cmake"
+  "/root/repo/cmake/AllegroFindOSS.cmake"
+  "/root/repo/cmake/Common.cmake"
+  "/root/repo/cmake/FileList.cmake"
+  "/root/repo/cmake/FindDUMB.cmake"
+  "/root/repo/cmake/FindFLAC.cmake"
+  "/root/repo/cmake/FindOgg.cmake"
+  "/root/repo/cmake/FindOpenSL.cmake"
+  "/root/repo/cmake/FindTheora.cmake"
+  "/root/repo/cmake/FindVorbis.cmake"
+  "/root/repo/include/allegro5/platform/alplatf.h.cmake"
+  "/root/repo/misc/allegro.pc.in"
+  "/root/repo/misc/allegro_acodec.pc.in"
+  "/root/repo/misc/allegro_audio.pc.in"
+  "/root/repo/misc/allegro_color.pc.in"
+  "/root/repo/misc/allegro_font.pc.in"
+  "/root/repo/misc/allegro_image.pc.in"
+  "/root/repo/misc/allegro_main.pc.in"
+  "/root/repo/misc/allegro_memfile.pc.in"
+  "/root/repo/misc/allegro_primitives.pc.in"
+  "/root/repo/misc/allegro_ttf.pc.in"
+  "/root/repo/tests/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCCompiler.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCCompilerABI.c"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXCompiler.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXCompilerABI.cpp"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCompilerIdDetection.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCXXCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCompileFeatures.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCompilerABI.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCompilerId.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeFindBinUtils.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeParseImplicitIncludeInfo.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeParseImplicitLinkInfo.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeParseLibraryArchitecture.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystem.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeTestCCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeTestCXXCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeTestCompilerCommon.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeUnixFindMake.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckFunctionExists.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFileCXX.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckSymbolExists.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckTypeSize.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/ADSP-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/ARMCC-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/ARMClang-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/AppleClang-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Borland-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Bruce-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Clang-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Clang-DetermineCompilerInternal.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Comeau-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Compaq-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Compaq-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Cray-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Embarcadero-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Fujitsu-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/FujitsuClang-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GHS-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-FindBinUtils.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/HP-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/HP-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IAR-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IBMCPP-C-DetermineVersionInternal.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IBMCPP-CXX-DetermineVersionInternal.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IBMClang-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IBMClang-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Intel-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IntelLLVM-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/LCC-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/LCC-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/MSVC-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/NVHPC-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/NVIDIA-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/OpenWatcom-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/PGI-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/PathScale-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/SCO-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/SDCC-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/SunPro-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/SunPro-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/TI-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Tasking-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/TinyCC-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/VisualAge-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/VisualAge-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Watcom-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/XL-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/XL-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/XLClang-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/XLClang-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/zOS-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/zOS-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/FindFreetype.cmake"
+  "/usr/share/cmake-3.25/Modules/FindJPEG.cmake"
+  "/usr/share/cmake-3.25/Modules/FindOpenAL.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPNG.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPhysFS.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPkgConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/FindZLIB.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/FeatureTesting.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-Determine-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/SelectLibraryConfigurations.cmake"
+  "/usr/share/cmake-3.25/Modules/TestBigEndian.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "include/allegro5/platform/alplatf.h"
+  "lib/pkgconfig/allegro-5.pc"
+  "lib/pkgconfig/allegro_primitives-5.pc"
+  "lib/pkgconfig/allegro_image-5.pc"
+  "lib/pkgconfig/allegro_font-5.pc"
+  "lib/pkgconfig/allegro_audio-5.pc"
+  "lib/pkgconfig/allegro_acodec-5.pc"
+  "lib/pkgconfig/allegro_ttf-5.pc"
+  "lib/pkgconfig/allegro_color-5.pc"
+  "lib/pkgconfig/allegro_memfile-5.pc"
+  "lib/pkgconfig/allegro_main-5.pc"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "addons/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "addons/primitives/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "include/allegro5/internal/aintern_image_cfg.h"
+  "addons/image/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "addons/font/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "include/allegro5/internal/aintern_audio_cfg.h"
+  "addons/audio/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "include/allegro5/internal/aintern_acodec_cfg.h"
+  "addons/acodec/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "include/allegro5/internal/aintern_ttf_cfg.h"
+  "addons/ttf/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "addons/color/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "addons/memfile/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "addons/native_dialog/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "addons/video/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "addons/main/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/allegro.dir/DependInfo.cmake"
+  "addons/primitives/CMakeFiles/allegro_primitives.dir/DependInfo.cmake"
+  "addons/image/CMakeFiles/allegro_image.dir/DependInfo.cmake"
+  "addons/font/CMakeFiles/allegro_font.dir/DependInfo.cmake"
+  "addons/audio/CMakeFiles/allegro_audio.dir/DependInfo.cmake"
+  "addons/acodec/CMakeFiles/allegro_acodec.dir/DependInfo.cmake"
+  "addons/ttf/CMakeFiles/allegro_ttf.dir/DependInfo.cmake"
+  "addons/color/CMakeFiles/allegro_color.dir/DependInfo.cmake"
+  "addons/memfile/CMakeFiles/allegro_memfile.dir/DependInfo.cmake"
+  "addons/main/CMakeFiles/allegro_main.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_driver.dir/DependInfo.cmake"
+  "tests/CMakeFiles/run_tests.dir/DependInfo.cmake"
+  "tests/CMakeFiles/run_tests_gl.dir/DependInfo.cmake"
+  "tests/CMakeFiles/run_tests_gl12.dir/DependInfo.cmake"
+  "tests/CMakeFiles/run_tests_gl20.dir/DependInfo.cmake"
+  "tests/CMakeFiles/run_tests_d3d.dir/DependInfo.cmake"
+  "tests/CMakeFiles/run_tests_wine.dir/DependInfo.cmake"
+  "tests/CMakeFiles/run_tests_wine_gl.dir/DependInfo.cmake"
+  "tests/CMakeFiles/run_tests_shaders.dir/DependInfo.cmake"
+  )
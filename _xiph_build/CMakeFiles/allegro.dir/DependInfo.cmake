@@ -0,0 +1,89 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/allegro.c" "CMakeFiles/allegro.dir/src/allegro.c.o" "gcc" "CMakeFiles/allegro.dir/src/allegro.c.o.d"
+  "/root/repo/src/bitmap.c" "CMakeFiles/allegro.dir/src/bitmap.c.o" "gcc" "CMakeFiles/allegro.dir/src/bitmap.c.o.d"
+  "/root/repo/src/bitmap_draw.c" "CMakeFiles/allegro.dir/src/bitmap_draw.c.o" "gcc" "CMakeFiles/allegro.dir/src/bitmap_draw.c.o.d"
+  "/root/repo/src/bitmap_io.c" "CMakeFiles/allegro.dir/src/bitmap_io.c.o" "gcc" "CMakeFiles/allegro.dir/src/bitmap_io.c.o.d"
+  "/root/repo/src/bitmap_lock.c" "CMakeFiles/allegro.dir/src/bitmap_lock.c.o" "gcc" "CMakeFiles/allegro.dir/src/bitmap_lock.c.o.d"
+  "/root/repo/src/bitmap_pixel.c" "CMakeFiles/allegro.dir/src/bitmap_pixel.c.o" "gcc" "CMakeFiles/allegro.dir/src/bitmap_pixel.c.o.d"
+  "/root/repo/src/bitmap_type.c" "CMakeFiles/allegro.dir/src/bitmap_type.c.o" "gcc" "CMakeFiles/allegro.dir/src/bitmap_type.c.o.d"
+  "/root/repo/src/blenders.c" "CMakeFiles/allegro.dir/src/blenders.c.o" "gcc" "CMakeFiles/allegro.dir/src/blenders.c.o.d"
+  "/root/repo/src/clipboard.c" "CMakeFiles/allegro.dir/src/clipboard.c.o" "gcc" "CMakeFiles/allegro.dir/src/clipboard.c.o.d"
+  "/root/repo/src/config.c" "CMakeFiles/allegro.dir/src/config.c.o" "gcc" "CMakeFiles/allegro.dir/src/config.c.o.d"
+  "/root/repo/src/convert.c" "CMakeFiles/allegro.dir/src/convert.c.o" "gcc" "CMakeFiles/allegro.dir/src/convert.c.o.d"
+  "/root/repo/src/cpu.c" "CMakeFiles/allegro.dir/src/cpu.c.o" "gcc" "CMakeFiles/allegro.dir/src/cpu.c.o.d"
+  "/root/repo/src/debug.c" "CMakeFiles/allegro.dir/src/debug.c.o" "gcc" "CMakeFiles/allegro.dir/src/debug.c.o.d"
+  "/root/repo/src/display.c" "CMakeFiles/allegro.dir/src/display.c.o" "gcc" "CMakeFiles/allegro.dir/src/display.c.o.d"
+  "/root/repo/src/display_settings.c" "CMakeFiles/allegro.dir/src/display_settings.c.o" "gcc" "CMakeFiles/allegro.dir/src/display_settings.c.o.d"
+  "/root/repo/src/drawing.c" "CMakeFiles/allegro.dir/src/drawing.c.o" "gcc" "CMakeFiles/allegro.dir/src/drawing.c.o.d"
+  "/root/repo/src/dtor.c" "CMakeFiles/allegro.dir/src/dtor.c.o" "gcc" "CMakeFiles/allegro.dir/src/dtor.c.o.d"
+  "/root/repo/src/events.c" "CMakeFiles/allegro.dir/src/events.c.o" "gcc" "CMakeFiles/allegro.dir/src/events.c.o.d"
+  "/root/repo/src/evtsrc.c" "CMakeFiles/allegro.dir/src/evtsrc.c.o" "gcc" "CMakeFiles/allegro.dir/src/evtsrc.c.o.d"
+  "/root/repo/src/exitfunc.c" "CMakeFiles/allegro.dir/src/exitfunc.c.o" "gcc" "CMakeFiles/allegro.dir/src/exitfunc.c.o.d"
+  "/root/repo/src/file.c" "CMakeFiles/allegro.dir/src/file.c.o" "gcc" "CMakeFiles/allegro.dir/src/file.c.o.d"
+  "/root/repo/src/file_slice.c" "CMakeFiles/allegro.dir/src/file_slice.c.o" "gcc" "CMakeFiles/allegro.dir/src/file_slice.c.o.d"
+  "/root/repo/src/file_stdio.c" "CMakeFiles/allegro.dir/src/file_stdio.c.o" "gcc" "CMakeFiles/allegro.dir/src/file_stdio.c.o.d"
+  "/root/repo/src/fshook.c" "CMakeFiles/allegro.dir/src/fshook.c.o" "gcc" "CMakeFiles/allegro.dir/src/fshook.c.o.d"
+  "/root/repo/src/fshook_stdio.c" "CMakeFiles/allegro.dir/src/fshook_stdio.c.o" "gcc" "CMakeFiles/allegro.dir/src/fshook_stdio.c.o.d"
+  "/root/repo/src/fullscreen_mode.c" "CMakeFiles/allegro.dir/src/fullscreen_mode.c.o" "gcc" "CMakeFiles/allegro.dir/src/fullscreen_mode.c.o.d"
+  "/root/repo/src/haptic.c" "CMakeFiles/allegro.dir/src/haptic.c.o" "gcc" "CMakeFiles/allegro.dir/src/haptic.c.o.d"
+  "/root/repo/src/inline.c" "CMakeFiles/allegro.dir/src/inline.c.o" "gcc" "CMakeFiles/allegro.dir/src/inline.c.o.d"
+  "/root/repo/src/joynu.c" "CMakeFiles/allegro.dir/src/joynu.c.o" "gcc" "CMakeFiles/allegro.dir/src/joynu.c.o.d"
+  "/root/repo/src/keybdnu.c" "CMakeFiles/allegro.dir/src/keybdnu.c.o" "gcc" "CMakeFiles/allegro.dir/src/keybdnu.c.o.d"
+  "/root/repo/src/libc.c" "CMakeFiles/allegro.dir/src/libc.c.o" "gcc" "CMakeFiles/allegro.dir/src/libc.c.o.d"
+  "/root/repo/src/math.c" "CMakeFiles/allegro.dir/src/math.c.o" "gcc" "CMakeFiles/allegro.dir/src/math.c.o.d"
+  "/root/repo/src/memblit.c" "CMakeFiles/allegro.dir/src/memblit.c.o" "gcc" "CMakeFiles/allegro.dir/src/memblit.c.o.d"
+  "/root/repo/src/memdraw.c" "CMakeFiles/allegro.dir/src/memdraw.c.o" "gcc" "CMakeFiles/allegro.dir/src/memdraw.c.o.d"
+  "/root/repo/src/memory.c" "CMakeFiles/allegro.dir/src/memory.c.o" "gcc" "CMakeFiles/allegro.dir/src/memory.c.o.d"
+  "/root/repo/src/misc/aatree.c" "CMakeFiles/allegro.dir/src/misc/aatree.c.o" "gcc" "CMakeFiles/allegro.dir/src/misc/aatree.c.o.d"
+  "/root/repo/src/misc/bstrlib.c" "CMakeFiles/allegro.dir/src/misc/bstrlib.c.o" "gcc" "CMakeFiles/allegro.dir/src/misc/bstrlib.c.o.d"
+  "/root/repo/src/misc/list.c" "CMakeFiles/allegro.dir/src/misc/list.c.o" "gcc" "CMakeFiles/allegro.dir/src/misc/list.c.o.d"
+  "/root/repo/src/misc/vector.c" "CMakeFiles/allegro.dir/src/misc/vector.c.o" "gcc" "CMakeFiles/allegro.dir/src/misc/vector.c.o.d"
+  "/root/repo/src/monitor.c" "CMakeFiles/allegro.dir/src/monitor.c.o" "gcc" "CMakeFiles/allegro.dir/src/monitor.c.o.d"
+  "/root/repo/src/mouse_cursor.c" "CMakeFiles/allegro.dir/src/mouse_cursor.c.o" "gcc" "CMakeFiles/allegro.dir/src/mouse_cursor.c.o.d"
+  "/root/repo/src/mousenu.c" "CMakeFiles/allegro.dir/src/mousenu.c.o" "gcc" "CMakeFiles/allegro.dir/src/mousenu.c.o.d"
+  "/root/repo/src/path.c" "CMakeFiles/allegro.dir/src/path.c.o" "gcc" "CMakeFiles/allegro.dir/src/path.c.o.d"
+  "/root/repo/src/pixels.c" "CMakeFiles/allegro.dir/src/pixels.c.o" "gcc" "CMakeFiles/allegro.dir/src/pixels.c.o.d"
+  "/root/repo/src/render_stats.c" "CMakeFiles/allegro.dir/src/render_stats.c.o" "gcc" "CMakeFiles/allegro.dir/src/render_stats.c.o.d"
+  "/root/repo/src/shader.c" "CMakeFiles/allegro.dir/src/shader.c.o" "gcc" "CMakeFiles/allegro.dir/src/shader.c.o.d"
+  "/root/repo/src/system.c" "CMakeFiles/allegro.dir/src/system.c.o" "gcc" "CMakeFiles/allegro.dir/src/system.c.o.d"
+  "/root/repo/src/threads.c" "CMakeFiles/allegro.dir/src/threads.c.o" "gcc" "CMakeFiles/allegro.dir/src/threads.c.o.d"
+  "/root/repo/src/timernu.c" "CMakeFiles/allegro.dir/src/timernu.c.o" "gcc" "CMakeFiles/allegro.dir/src/timernu.c.o.d"
+  "/root/repo/src/tls.c" "CMakeFiles/allegro.dir/src/tls.c.o" "gcc" "CMakeFiles/allegro.dir/src/tls.c.o.d"
+  "/root/repo/src/touch_input.c" "CMakeFiles/allegro.dir/src/touch_input.c.o" "gcc" "CMakeFiles/allegro.dir/src/touch_input.c.o.d"
+  "/root/repo/src/transformations.c" "CMakeFiles/allegro.dir/src/transformations.c.o" "gcc" "CMakeFiles/allegro.dir/src/transformations.c.o.d"
+  "/root/repo/src/tri_soft.c" "CMakeFiles/allegro.dir/src/tri_soft.c.o" "gcc" "CMakeFiles/allegro.dir/src/tri_soft.c.o.d"
+  "/root/repo/src/unix/udrvlist.c" "CMakeFiles/allegro.dir/src/unix/udrvlist.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/udrvlist.c.o.d"
+  "/root/repo/src/unix/ufdwatch.c" "CMakeFiles/allegro.dir/src/unix/ufdwatch.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/ufdwatch.c.o.d"
+  "/root/repo/src/unix/ugfxdrv.c" "CMakeFiles/allegro.dir/src/unix/ugfxdrv.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/ugfxdrv.c.o.d"
+  "/root/repo/src/unix/uhapdrv.c" "CMakeFiles/allegro.dir/src/unix/uhapdrv.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/uhapdrv.c.o.d"
+  "/root/repo/src/unix/ujoydrv.c" "CMakeFiles/allegro.dir/src/unix/ujoydrv.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/ujoydrv.c.o.d"
+  "/root/repo/src/unix/ukeybd.c" "CMakeFiles/allegro.dir/src/unix/ukeybd.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/ukeybd.c.o.d"
+  "/root/repo/src/unix/umouse.c" "CMakeFiles/allegro.dir/src/unix/umouse.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/umouse.c.o.d"
+  "/root/repo/src/unix/upath.c" "CMakeFiles/allegro.dir/src/unix/upath.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/upath.c.o.d"
+  "/root/repo/src/unix/utime.c" "CMakeFiles/allegro.dir/src/unix/utime.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/utime.c.o.d"
+  "/root/repo/src/unix/uxthread.c" "CMakeFiles/allegro.dir/src/unix/uxthread.c.o" "gcc" "CMakeFiles/allegro.dir/src/unix/uxthread.c.o.d"
+  "/root/repo/src/utf8.c" "CMakeFiles/allegro.dir/src/utf8.c.o" "gcc" "CMakeFiles/allegro.dir/src/utf8.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_xiph_build/lib/liballegro.so" "/root/repo/_xiph_build/lib/liballegro.so.5.1.13"
+  "/root/repo/_xiph_build/lib/liballegro.so.5.1" "/root/repo/_xiph_build/lib/liballegro.so.5.1.13"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,139 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/allegro.dir/src/allegro.c.o"
+  "CMakeFiles/allegro.dir/src/allegro.c.o.d"
+  "CMakeFiles/allegro.dir/src/bitmap.c.o"
+  "CMakeFiles/allegro.dir/src/bitmap.c.o.d"
+  "CMakeFiles/allegro.dir/src/bitmap_draw.c.o"
+  "CMakeFiles/allegro.dir/src/bitmap_draw.c.o.d"
+  "CMakeFiles/allegro.dir/src/bitmap_io.c.o"
+  "CMakeFiles/allegro.dir/src/bitmap_io.c.o.d"
+  "CMakeFiles/allegro.dir/src/bitmap_lock.c.o"
+  "CMakeFiles/allegro.dir/src/bitmap_lock.c.o.d"
+  "CMakeFiles/allegro.dir/src/bitmap_pixel.c.o"
+  "CMakeFiles/allegro.dir/src/bitmap_pixel.c.o.d"
+  "CMakeFiles/allegro.dir/src/bitmap_type.c.o"
+  "CMakeFiles/allegro.dir/src/bitmap_type.c.o.d"
+  "CMakeFiles/allegro.dir/src/blenders.c.o"
+  "CMakeFiles/allegro.dir/src/blenders.c.o.d"
+  "CMakeFiles/allegro.dir/src/clipboard.c.o"
+  "CMakeFiles/allegro.dir/src/clipboard.c.o.d"
+  "CMakeFiles/allegro.dir/src/config.c.o"
+  "CMakeFiles/allegro.dir/src/config.c.o.d"
+  "CMakeFiles/allegro.dir/src/convert.c.o"
+  "CMakeFiles/allegro.dir/src/convert.c.o.d"
+  "CMakeFiles/allegro.dir/src/cpu.c.o"
+  "CMakeFiles/allegro.dir/src/cpu.c.o.d"
+  "CMakeFiles/allegro.dir/src/debug.c.o"
+  "CMakeFiles/allegro.dir/src/debug.c.o.d"
+  "CMakeFiles/allegro.dir/src/display.c.o"
+  "CMakeFiles/allegro.dir/src/display.c.o.d"
+  "CMakeFiles/allegro.dir/src/display_settings.c.o"
+  "CMakeFiles/allegro.dir/src/display_settings.c.o.d"
+  "CMakeFiles/allegro.dir/src/drawing.c.o"
+  "CMakeFiles/allegro.dir/src/drawing.c.o.d"
+  "CMakeFiles/allegro.dir/src/dtor.c.o"
+  "CMakeFiles/allegro.dir/src/dtor.c.o.d"
+  "CMakeFiles/allegro.dir/src/events.c.o"
+  "CMakeFiles/allegro.dir/src/events.c.o.d"
+  "CMakeFiles/allegro.dir/src/evtsrc.c.o"
+  "CMakeFiles/allegro.dir/src/evtsrc.c.o.d"
+  "CMakeFiles/allegro.dir/src/exitfunc.c.o"
+  "CMakeFiles/allegro.dir/src/exitfunc.c.o.d"
+  "CMakeFiles/allegro.dir/src/file.c.o"
+  "CMakeFiles/allegro.dir/src/file.c.o.d"
+  "CMakeFiles/allegro.dir/src/file_slice.c.o"
+  "CMakeFiles/allegro.dir/src/file_slice.c.o.d"
+  "CMakeFiles/allegro.dir/src/file_stdio.c.o"
+  "CMakeFiles/allegro.dir/src/file_stdio.c.o.d"
+  "CMakeFiles/allegro.dir/src/fshook.c.o"
+  "CMakeFiles/allegro.dir/src/fshook.c.o.d"
+  "CMakeFiles/allegro.dir/src/fshook_stdio.c.o"
+  "CMakeFiles/allegro.dir/src/fshook_stdio.c.o.d"
+  "CMakeFiles/allegro.dir/src/fullscreen_mode.c.o"
+  "CMakeFiles/allegro.dir/src/fullscreen_mode.c.o.d"
+  "CMakeFiles/allegro.dir/src/haptic.c.o"
+  "CMakeFiles/allegro.dir/src/haptic.c.o.d"
+  "CMakeFiles/allegro.dir/src/inline.c.o"
+  "CMakeFiles/allegro.dir/src/inline.c.o.d"
+  "CMakeFiles/allegro.dir/src/joynu.c.o"
+  "CMakeFiles/allegro.dir/src/joynu.c.o.d"
+  "CMakeFiles/allegro.dir/src/keybdnu.c.o"
+  "CMakeFiles/allegro.dir/src/keybdnu.c.o.d"
+  "CMakeFiles/allegro.dir/src/libc.c.o"
+  "CMakeFiles/allegro.dir/src/libc.c.o.d"
+  "CMakeFiles/allegro.dir/src/math.c.o"
+  "CMakeFiles/allegro.dir/src/math.c.o.d"
+  "CMakeFiles/allegro.dir/src/memblit.c.o"
+  "CMakeFiles/allegro.dir/src/memblit.c.o.d"
+  "CMakeFiles/allegro.dir/src/memdraw.c.o"
+  "CMakeFiles/allegro.dir/src/memdraw.c.o.d"
+  "CMakeFiles/allegro.dir/src/memory.c.o"
+  "CMakeFiles/allegro.dir/src/memory.c.o.d"
+  "CMakeFiles/allegro.dir/src/misc/aatree.c.o"
+  "CMakeFiles/allegro.dir/src/misc/aatree.c.o.d"
+  "CMakeFiles/allegro.dir/src/misc/bstrlib.c.o"
+  "CMakeFiles/allegro.dir/src/misc/bstrlib.c.o.d"
+  "CMakeFiles/allegro.dir/src/misc/list.c.o"
+  "CMakeFiles/allegro.dir/src/misc/list.c.o.d"
+  "CMakeFiles/allegro.dir/src/misc/vector.c.o"
+  "CMakeFiles/allegro.dir/src/misc/vector.c.o.d"
+  "CMakeFiles/allegro.dir/src/monitor.c.o"
+  "CMakeFiles/allegro.dir/src/monitor.c.o.d"
+  "CMakeFiles/allegro.dir/src/mouse_cursor.c.o"
+  "CMakeFiles/allegro.dir/src/mouse_cursor.c.o.d"
+  "CMakeFiles/allegro.dir/src/mousenu.c.o"
+  "CMakeFiles/allegro.dir/src/mousenu.c.o.d"
+  "CMakeFiles/allegro.dir/src/path.c.o"
+  "CMakeFiles/allegro.dir/src/path.c.o.d"
+  "CMakeFiles/allegro.dir/src/pixels.c.o"
+  "CMakeFiles/allegro.dir/src/pixels.c.o.d"
+  "CMakeFiles/allegro.dir/src/render_stats.c.o"
+  "CMakeFiles/allegro.dir/src/render_stats.c.o.d"
+  "CMakeFiles/allegro.dir/src/shader.c.o"
+  "CMakeFiles/allegro.dir/src/shader.c.o.d"
+  "CMakeFiles/allegro.dir/src/system.c.o"
+  "CMakeFiles/allegro.dir/src/system.c.o.d"
+  "CMakeFiles/allegro.dir/src/threads.c.o"
+  "CMakeFiles/allegro.dir/src/threads.c.o.d"
+  "CMakeFiles/allegro.dir/src/timernu.c.o"
+  "CMakeFiles/allegro.dir/src/timernu.c.o.d"
+  "CMakeFiles/allegro.dir/src/tls.c.o"
+  "CMakeFiles/allegro.dir/src/tls.c.o.d"
+  "CMakeFiles/allegro.dir/src/touch_input.c.o"
+  "CMakeFiles/allegro.dir/src/touch_input.c.o.d"
+  "CMakeFiles/allegro.dir/src/transformations.c.o"
+  "CMakeFiles/allegro.dir/src/transformations.c.o.d"
+  "CMakeFiles/allegro.dir/src/tri_soft.c.o"
+  "CMakeFiles/allegro.dir/src/tri_soft.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/udrvlist.c.o"
+  "CMakeFiles/allegro.dir/src/unix/udrvlist.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/ufdwatch.c.o"
+  "CMakeFiles/allegro.dir/src/unix/ufdwatch.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/ugfxdrv.c.o"
+  "CMakeFiles/allegro.dir/src/unix/ugfxdrv.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/uhapdrv.c.o"
+  "CMakeFiles/allegro.dir/src/unix/uhapdrv.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/ujoydrv.c.o"
+  "CMakeFiles/allegro.dir/src/unix/ujoydrv.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/ukeybd.c.o"
+  "CMakeFiles/allegro.dir/src/unix/ukeybd.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/umouse.c.o"
+  "CMakeFiles/allegro.dir/src/unix/umouse.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/upath.c.o"
+  "CMakeFiles/allegro.dir/src/unix/upath.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/utime.c.o"
+  "CMakeFiles/allegro.dir/src/unix/utime.c.o.d"
+  "CMakeFiles/allegro.dir/src/unix/uxthread.c.o"
+  "CMakeFiles/allegro.dir/src/unix/uxthread.c.o.d"
+  "CMakeFiles/allegro.dir/src/utf8.c.o"
+  "CMakeFiles/allegro.dir/src/utf8.c.o.d"
+  "lib/liballegro.pdb"
+  "lib/liballegro.so"
+  "lib/liballegro.so.5.1"
+  "lib/liballegro.so.5.1.13"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/allegro.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
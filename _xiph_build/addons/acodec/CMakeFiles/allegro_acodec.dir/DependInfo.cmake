@@ -0,0 +1,33 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/addons/acodec/acodec.c" "addons/acodec/CMakeFiles/allegro_acodec.dir/acodec.c.o" "gcc" "addons/acodec/CMakeFiles/allegro_acodec.dir/acodec.c.o.d"
+  "/root/repo/addons/acodec/flac.c" "addons/acodec/CMakeFiles/allegro_acodec.dir/flac.c.o" "gcc" "addons/acodec/CMakeFiles/allegro_acodec.dir/flac.c.o.d"
+  "/root/repo/addons/acodec/helper.c" "addons/acodec/CMakeFiles/allegro_acodec.dir/helper.c.o" "gcc" "addons/acodec/CMakeFiles/allegro_acodec.dir/helper.c.o.d"
+  "/root/repo/addons/acodec/ogg.c" "addons/acodec/CMakeFiles/allegro_acodec.dir/ogg.c.o" "gcc" "addons/acodec/CMakeFiles/allegro_acodec.dir/ogg.c.o.d"
+  "/root/repo/addons/acodec/voc.c" "addons/acodec/CMakeFiles/allegro_acodec.dir/voc.c.o" "gcc" "addons/acodec/CMakeFiles/allegro_acodec.dir/voc.c.o.d"
+  "/root/repo/addons/acodec/wav.c" "addons/acodec/CMakeFiles/allegro_acodec.dir/wav.c.o" "gcc" "addons/acodec/CMakeFiles/allegro_acodec.dir/wav.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_xiph_build/lib/liballegro_acodec.so" "/root/repo/_xiph_build/lib/liballegro_acodec.so.5.1.13"
+  "/root/repo/_xiph_build/lib/liballegro_acodec.so.5.1" "/root/repo/_xiph_build/lib/liballegro_acodec.so.5.1.13"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_xiph_build/addons/audio/CMakeFiles/allegro_audio.dir/DependInfo.cmake"
+  "/root/repo/_xiph_build/CMakeFiles/allegro.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
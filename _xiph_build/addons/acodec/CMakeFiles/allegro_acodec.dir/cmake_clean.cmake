@@ -0,0 +1,23 @@
+file(REMOVE_RECURSE
+  "../../lib/liballegro_acodec.pdb"
+  "../../lib/liballegro_acodec.so"
+  "../../lib/liballegro_acodec.so.5.1"
+  "../../lib/liballegro_acodec.so.5.1.13"
+  "CMakeFiles/allegro_acodec.dir/acodec.c.o"
+  "CMakeFiles/allegro_acodec.dir/acodec.c.o.d"
+  "CMakeFiles/allegro_acodec.dir/flac.c.o"
+  "CMakeFiles/allegro_acodec.dir/flac.c.o.d"
+  "CMakeFiles/allegro_acodec.dir/helper.c.o"
+  "CMakeFiles/allegro_acodec.dir/helper.c.o.d"
+  "CMakeFiles/allegro_acodec.dir/ogg.c.o"
+  "CMakeFiles/allegro_acodec.dir/ogg.c.o.d"
+  "CMakeFiles/allegro_acodec.dir/voc.c.o"
+  "CMakeFiles/allegro_acodec.dir/voc.c.o.d"
+  "CMakeFiles/allegro_acodec.dir/wav.c.o"
+  "CMakeFiles/allegro_acodec.dir/wav.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/allegro_acodec.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
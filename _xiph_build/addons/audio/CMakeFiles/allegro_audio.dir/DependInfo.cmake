@@ -0,0 +1,43 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/addons/audio/audio.c" "addons/audio/CMakeFiles/allegro_audio.dir/audio.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/audio.c.o.d"
+  "/root/repo/addons/audio/audio_io.c" "addons/audio/CMakeFiles/allegro_audio.dir/audio_io.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/audio_io.c.o.d"
+  "/root/repo/addons/audio/audio_stats.c" "addons/audio/CMakeFiles/allegro_audio.dir/audio_stats.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/audio_stats.c.o.d"
+  "/root/repo/addons/audio/compressed_sample.c" "addons/audio/CMakeFiles/allegro_audio.dir/compressed_sample.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/compressed_sample.c.o.d"
+  "/root/repo/addons/audio/kcm_adpcm.c" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_adpcm.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_adpcm.c.o.d"
+  "/root/repo/addons/audio/kcm_dtor.c" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_dtor.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_dtor.c.o.d"
+  "/root/repo/addons/audio/kcm_instance.c" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_instance.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_instance.c.o.d"
+  "/root/repo/addons/audio/kcm_mixer.c" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_mixer.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_mixer.c.o.d"
+  "/root/repo/addons/audio/kcm_sample.c" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_sample.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_sample.c.o.d"
+  "/root/repo/addons/audio/kcm_stream.c" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_stream.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_stream.c.o.d"
+  "/root/repo/addons/audio/kcm_voice.c" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_voice.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/kcm_voice.c.o.d"
+  "/root/repo/addons/audio/null_audio.c" "addons/audio/CMakeFiles/allegro_audio.dir/null_audio.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/null_audio.c.o.d"
+  "/root/repo/addons/audio/oss.c" "addons/audio/CMakeFiles/allegro_audio.dir/oss.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/oss.c.o.d"
+  "/root/repo/addons/audio/recorder.c" "addons/audio/CMakeFiles/allegro_audio.dir/recorder.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/recorder.c.o.d"
+  "/root/repo/addons/audio/sample_batch.c" "addons/audio/CMakeFiles/allegro_audio.dir/sample_batch.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/sample_batch.c.o.d"
+  "/root/repo/addons/audio/sample_cache.c" "addons/audio/CMakeFiles/allegro_audio.dir/sample_cache.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/sample_cache.c.o.d"
+  "/root/repo/addons/audio/sample_convert.c" "addons/audio/CMakeFiles/allegro_audio.dir/sample_convert.c.o" "gcc" "addons/audio/CMakeFiles/allegro_audio.dir/sample_convert.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_xiph_build/lib/liballegro_audio.so" "/root/repo/_xiph_build/lib/liballegro_audio.so.5.1.13"
+  "/root/repo/_xiph_build/lib/liballegro_audio.so.5.1" "/root/repo/_xiph_build/lib/liballegro_audio.so.5.1.13"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_xiph_build/CMakeFiles/allegro.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
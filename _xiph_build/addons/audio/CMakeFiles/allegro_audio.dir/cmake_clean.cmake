@@ -0,0 +1,45 @@
+file(REMOVE_RECURSE
+  "../../lib/liballegro_audio.pdb"
+  "../../lib/liballegro_audio.so"
+  "../../lib/liballegro_audio.so.5.1"
+  "../../lib/liballegro_audio.so.5.1.13"
+  "CMakeFiles/allegro_audio.dir/audio.c.o"
+  "CMakeFiles/allegro_audio.dir/audio.c.o.d"
+  "CMakeFiles/allegro_audio.dir/audio_io.c.o"
+  "CMakeFiles/allegro_audio.dir/audio_io.c.o.d"
+  "CMakeFiles/allegro_audio.dir/audio_stats.c.o"
+  "CMakeFiles/allegro_audio.dir/audio_stats.c.o.d"
+  "CMakeFiles/allegro_audio.dir/compressed_sample.c.o"
+  "CMakeFiles/allegro_audio.dir/compressed_sample.c.o.d"
+  "CMakeFiles/allegro_audio.dir/kcm_adpcm.c.o"
+  "CMakeFiles/allegro_audio.dir/kcm_adpcm.c.o.d"
+  "CMakeFiles/allegro_audio.dir/kcm_dtor.c.o"
+  "CMakeFiles/allegro_audio.dir/kcm_dtor.c.o.d"
+  "CMakeFiles/allegro_audio.dir/kcm_instance.c.o"
+  "CMakeFiles/allegro_audio.dir/kcm_instance.c.o.d"
+  "CMakeFiles/allegro_audio.dir/kcm_mixer.c.o"
+  "CMakeFiles/allegro_audio.dir/kcm_mixer.c.o.d"
+  "CMakeFiles/allegro_audio.dir/kcm_sample.c.o"
+  "CMakeFiles/allegro_audio.dir/kcm_sample.c.o.d"
+  "CMakeFiles/allegro_audio.dir/kcm_stream.c.o"
+  "CMakeFiles/allegro_audio.dir/kcm_stream.c.o.d"
+  "CMakeFiles/allegro_audio.dir/kcm_voice.c.o"
+  "CMakeFiles/allegro_audio.dir/kcm_voice.c.o.d"
+  "CMakeFiles/allegro_audio.dir/null_audio.c.o"
+  "CMakeFiles/allegro_audio.dir/null_audio.c.o.d"
+  "CMakeFiles/allegro_audio.dir/oss.c.o"
+  "CMakeFiles/allegro_audio.dir/oss.c.o.d"
+  "CMakeFiles/allegro_audio.dir/recorder.c.o"
+  "CMakeFiles/allegro_audio.dir/recorder.c.o.d"
+  "CMakeFiles/allegro_audio.dir/sample_batch.c.o"
+  "CMakeFiles/allegro_audio.dir/sample_batch.c.o.d"
+  "CMakeFiles/allegro_audio.dir/sample_cache.c.o"
+  "CMakeFiles/allegro_audio.dir/sample_cache.c.o.d"
+  "CMakeFiles/allegro_audio.dir/sample_convert.c.o"
+  "CMakeFiles/allegro_audio.dir/sample_convert.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/allegro_audio.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../lib/liballegro_color.pdb"
+  "../../lib/liballegro_color.so"
+  "../../lib/liballegro_color.so.5.1"
+  "../../lib/liballegro_color.so.5.1.13"
+  "CMakeFiles/allegro_color.dir/color.c.o"
+  "CMakeFiles/allegro_color.dir/color.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/allegro_color.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
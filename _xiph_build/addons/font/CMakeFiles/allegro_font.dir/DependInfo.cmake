@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/addons/font/font.c" "addons/font/CMakeFiles/allegro_font.dir/font.c.o" "gcc" "addons/font/CMakeFiles/allegro_font.dir/font.c.o.d"
+  "/root/repo/addons/font/fontbmp.c" "addons/font/CMakeFiles/allegro_font.dir/fontbmp.c.o" "gcc" "addons/font/CMakeFiles/allegro_font.dir/fontbmp.c.o.d"
+  "/root/repo/addons/font/stdfont.c" "addons/font/CMakeFiles/allegro_font.dir/stdfont.c.o" "gcc" "addons/font/CMakeFiles/allegro_font.dir/stdfont.c.o.d"
+  "/root/repo/addons/font/text.c" "addons/font/CMakeFiles/allegro_font.dir/text.c.o" "gcc" "addons/font/CMakeFiles/allegro_font.dir/text.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_xiph_build/lib/liballegro_font.so" "/root/repo/_xiph_build/lib/liballegro_font.so.5.1.13"
+  "/root/repo/_xiph_build/lib/liballegro_font.so.5.1" "/root/repo/_xiph_build/lib/liballegro_font.so.5.1.13"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_xiph_build/CMakeFiles/allegro.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
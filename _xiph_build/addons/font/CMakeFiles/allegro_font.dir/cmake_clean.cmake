@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "../../lib/liballegro_font.pdb"
+  "../../lib/liballegro_font.so"
+  "../../lib/liballegro_font.so.5.1"
+  "../../lib/liballegro_font.so.5.1.13"
+  "CMakeFiles/allegro_font.dir/font.c.o"
+  "CMakeFiles/allegro_font.dir/font.c.o.d"
+  "CMakeFiles/allegro_font.dir/fontbmp.c.o"
+  "CMakeFiles/allegro_font.dir/fontbmp.c.o.d"
+  "CMakeFiles/allegro_font.dir/stdfont.c.o"
+  "CMakeFiles/allegro_font.dir/stdfont.c.o.d"
+  "CMakeFiles/allegro_font.dir/text.c.o"
+  "CMakeFiles/allegro_font.dir/text.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/allegro_font.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
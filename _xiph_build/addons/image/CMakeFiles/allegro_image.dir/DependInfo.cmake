@@ -0,0 +1,34 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/addons/image/bmp.c" "addons/image/CMakeFiles/allegro_image.dir/bmp.c.o" "gcc" "addons/image/CMakeFiles/allegro_image.dir/bmp.c.o.d"
+  "/root/repo/addons/image/dds.c" "addons/image/CMakeFiles/allegro_image.dir/dds.c.o" "gcc" "addons/image/CMakeFiles/allegro_image.dir/dds.c.o.d"
+  "/root/repo/addons/image/identify.c" "addons/image/CMakeFiles/allegro_image.dir/identify.c.o" "gcc" "addons/image/CMakeFiles/allegro_image.dir/identify.c.o.d"
+  "/root/repo/addons/image/iio.c" "addons/image/CMakeFiles/allegro_image.dir/iio.c.o" "gcc" "addons/image/CMakeFiles/allegro_image.dir/iio.c.o.d"
+  "/root/repo/addons/image/jpg.c" "addons/image/CMakeFiles/allegro_image.dir/jpg.c.o" "gcc" "addons/image/CMakeFiles/allegro_image.dir/jpg.c.o.d"
+  "/root/repo/addons/image/pcx.c" "addons/image/CMakeFiles/allegro_image.dir/pcx.c.o" "gcc" "addons/image/CMakeFiles/allegro_image.dir/pcx.c.o.d"
+  "/root/repo/addons/image/png.c" "addons/image/CMakeFiles/allegro_image.dir/png.c.o" "gcc" "addons/image/CMakeFiles/allegro_image.dir/png.c.o.d"
+  "/root/repo/addons/image/tga.c" "addons/image/CMakeFiles/allegro_image.dir/tga.c.o" "gcc" "addons/image/CMakeFiles/allegro_image.dir/tga.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_xiph_build/lib/liballegro_image.so" "/root/repo/_xiph_build/lib/liballegro_image.so.5.1.13"
+  "/root/repo/_xiph_build/lib/liballegro_image.so.5.1" "/root/repo/_xiph_build/lib/liballegro_image.so.5.1.13"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_xiph_build/CMakeFiles/allegro.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,27 @@
+file(REMOVE_RECURSE
+  "../../lib/liballegro_image.pdb"
+  "../../lib/liballegro_image.so"
+  "../../lib/liballegro_image.so.5.1"
+  "../../lib/liballegro_image.so.5.1.13"
+  "CMakeFiles/allegro_image.dir/bmp.c.o"
+  "CMakeFiles/allegro_image.dir/bmp.c.o.d"
+  "CMakeFiles/allegro_image.dir/dds.c.o"
+  "CMakeFiles/allegro_image.dir/dds.c.o.d"
+  "CMakeFiles/allegro_image.dir/identify.c.o"
+  "CMakeFiles/allegro_image.dir/identify.c.o.d"
+  "CMakeFiles/allegro_image.dir/iio.c.o"
+  "CMakeFiles/allegro_image.dir/iio.c.o.d"
+  "CMakeFiles/allegro_image.dir/jpg.c.o"
+  "CMakeFiles/allegro_image.dir/jpg.c.o.d"
+  "CMakeFiles/allegro_image.dir/pcx.c.o"
+  "CMakeFiles/allegro_image.dir/pcx.c.o.d"
+  "CMakeFiles/allegro_image.dir/png.c.o"
+  "CMakeFiles/allegro_image.dir/png.c.o.d"
+  "CMakeFiles/allegro_image.dir/tga.c.o"
+  "CMakeFiles/allegro_image.dir/tga.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/allegro_image.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../lib/liballegro_main.pdb"
+  "../../lib/liballegro_main.so"
+  "../../lib/liballegro_main.so.5.1"
+  "../../lib/liballegro_main.so.5.1.13"
+  "CMakeFiles/allegro_main.dir/generic_main.c.o"
+  "CMakeFiles/allegro_main.dir/generic_main.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/allegro_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../lib/liballegro_memfile.pdb"
+  "../../lib/liballegro_memfile.so"
+  "../../lib/liballegro_memfile.so.5.1"
+  "../../lib/liballegro_memfile.so.5.1.13"
+  "CMakeFiles/allegro_memfile.dir/memfile.c.o"
+  "CMakeFiles/allegro_memfile.dir/memfile.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/allegro_memfile.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,37 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/addons/primitives/high_primitives.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/high_primitives.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/high_primitives.c.o.d"
+  "/root/repo/addons/primitives/line_soft.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/line_soft.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/line_soft.c.o.d"
+  "/root/repo/addons/primitives/point_soft.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/point_soft.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/point_soft.c.o.d"
+  "/root/repo/addons/primitives/polygon.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/polygon.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/polygon.c.o.d"
+  "/root/repo/addons/primitives/polyline.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/polyline.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/polyline.c.o.d"
+  "/root/repo/addons/primitives/prim_opengl.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/prim_opengl.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/prim_opengl.c.o.d"
+  "/root/repo/addons/primitives/prim_soft.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/prim_soft.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/prim_soft.c.o.d"
+  "/root/repo/addons/primitives/prim_util.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/prim_util.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/prim_util.c.o.d"
+  "/root/repo/addons/primitives/primitives.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/primitives.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/primitives.c.o.d"
+  "/root/repo/addons/primitives/triangulator.c" "addons/primitives/CMakeFiles/allegro_primitives.dir/triangulator.c.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/triangulator.c.o.d"
+  "/root/repo/addons/primitives/prim_directx.cpp" "addons/primitives/CMakeFiles/allegro_primitives.dir/prim_directx.cpp.o" "gcc" "addons/primitives/CMakeFiles/allegro_primitives.dir/prim_directx.cpp.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_xiph_build/lib/liballegro_primitives.so" "/root/repo/_xiph_build/lib/liballegro_primitives.so.5.1.13"
+  "/root/repo/_xiph_build/lib/liballegro_primitives.so.5.1" "/root/repo/_xiph_build/lib/liballegro_primitives.so.5.1.13"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_xiph_build/CMakeFiles/allegro.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
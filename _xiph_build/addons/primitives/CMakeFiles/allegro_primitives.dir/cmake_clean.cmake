@@ -0,0 +1,33 @@
+file(REMOVE_RECURSE
+  "../../lib/liballegro_primitives.pdb"
+  "../../lib/liballegro_primitives.so"
+  "../../lib/liballegro_primitives.so.5.1"
+  "../../lib/liballegro_primitives.so.5.1.13"
+  "CMakeFiles/allegro_primitives.dir/high_primitives.c.o"
+  "CMakeFiles/allegro_primitives.dir/high_primitives.c.o.d"
+  "CMakeFiles/allegro_primitives.dir/line_soft.c.o"
+  "CMakeFiles/allegro_primitives.dir/line_soft.c.o.d"
+  "CMakeFiles/allegro_primitives.dir/point_soft.c.o"
+  "CMakeFiles/allegro_primitives.dir/point_soft.c.o.d"
+  "CMakeFiles/allegro_primitives.dir/polygon.c.o"
+  "CMakeFiles/allegro_primitives.dir/polygon.c.o.d"
+  "CMakeFiles/allegro_primitives.dir/polyline.c.o"
+  "CMakeFiles/allegro_primitives.dir/polyline.c.o.d"
+  "CMakeFiles/allegro_primitives.dir/prim_directx.cpp.o"
+  "CMakeFiles/allegro_primitives.dir/prim_directx.cpp.o.d"
+  "CMakeFiles/allegro_primitives.dir/prim_opengl.c.o"
+  "CMakeFiles/allegro_primitives.dir/prim_opengl.c.o.d"
+  "CMakeFiles/allegro_primitives.dir/prim_soft.c.o"
+  "CMakeFiles/allegro_primitives.dir/prim_soft.c.o.d"
+  "CMakeFiles/allegro_primitives.dir/prim_util.c.o"
+  "CMakeFiles/allegro_primitives.dir/prim_util.c.o.d"
+  "CMakeFiles/allegro_primitives.dir/primitives.c.o"
+  "CMakeFiles/allegro_primitives.dir/primitives.c.o.d"
+  "CMakeFiles/allegro_primitives.dir/triangulator.c.o"
+  "CMakeFiles/allegro_primitives.dir/triangulator.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C CXX)
+  include(CMakeFiles/allegro_primitives.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
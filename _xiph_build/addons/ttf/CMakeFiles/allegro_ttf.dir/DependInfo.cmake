@@ -0,0 +1,28 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/addons/ttf/ttf.c" "addons/ttf/CMakeFiles/allegro_ttf.dir/ttf.c.o" "gcc" "addons/ttf/CMakeFiles/allegro_ttf.dir/ttf.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_xiph_build/lib/liballegro_ttf.so" "/root/repo/_xiph_build/lib/liballegro_ttf.so.5.1.13"
+  "/root/repo/_xiph_build/lib/liballegro_ttf.so.5.1" "/root/repo/_xiph_build/lib/liballegro_ttf.so.5.1.13"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_xiph_build/addons/font/CMakeFiles/allegro_font.dir/DependInfo.cmake"
+  "/root/repo/_xiph_build/CMakeFiles/allegro.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
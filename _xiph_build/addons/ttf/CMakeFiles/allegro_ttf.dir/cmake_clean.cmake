@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../lib/liballegro_ttf.pdb"
+  "../../lib/liballegro_ttf.so"
+  "../../lib/liballegro_ttf.so.5.1"
+  "../../lib/liballegro_ttf.so.5.1.13"
+  "CMakeFiles/allegro_ttf.dir/ttf.c.o"
+  "CMakeFiles/allegro_ttf.dir/ttf.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/allegro_ttf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
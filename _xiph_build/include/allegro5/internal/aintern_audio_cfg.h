@@ -0,0 +1,7 @@
+/* #undef ALLEGRO_CFG_KCM_ALSA */
+/* #undef ALLEGRO_CFG_KCM_OPENAL */
+/* #undef ALLEGRO_CFG_KCM_OPENSL */
+/* #undef ALLEGRO_CFG_KCM_DSOUND */
+#define ALLEGRO_CFG_KCM_OSS
+/* #undef ALLEGRO_CFG_KCM_PULSEAUDIO */
+/* #undef ALLEGRO_CFG_KCM_AQUEUE */
@@ -0,0 +1,12 @@
+#define ALLEGRO_CFG_WANT_NATIVE_IMAGE_LOADER
+
+/* which libraries are present and needed? */
+/* #undef ALLEGRO_CFG_IIO_HAVE_GDIPLUS */
+/* #undef ALLEGRO_CFG_IIO_HAVE_GDIPLUS_LOWERCASE_H */
+/* #undef ALLEGRO_CFG_IIO_HAVE_ANDROID */
+#define ALLEGRO_CFG_IIO_HAVE_PNG
+#define ALLEGRO_CFG_IIO_HAVE_JPG
+
+/* which formats are supported and wanted? */
+#define ALLEGRO_CFG_IIO_SUPPORT_PNG
+#define ALLEGRO_CFG_IIO_SUPPORT_JPG
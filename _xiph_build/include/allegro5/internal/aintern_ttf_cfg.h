@@ -0,0 +1 @@
+/* #undef ALLEGRO_CFG_TTF_FREETYPE */
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/run_tests_d3d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/run_tests_d3d.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
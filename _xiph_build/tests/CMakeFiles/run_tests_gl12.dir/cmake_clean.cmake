@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/run_tests_gl12"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/run_tests_gl12.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,26 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/test_driver.c" "tests/CMakeFiles/test_driver.dir/test_driver.c.o" "gcc" "tests/CMakeFiles/test_driver.dir/test_driver.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_xiph_build/addons/main/CMakeFiles/allegro_main.dir/DependInfo.cmake"
+  "/root/repo/_xiph_build/addons/image/CMakeFiles/allegro_image.dir/DependInfo.cmake"
+  "/root/repo/_xiph_build/addons/color/CMakeFiles/allegro_color.dir/DependInfo.cmake"
+  "/root/repo/_xiph_build/addons/ttf/CMakeFiles/allegro_ttf.dir/DependInfo.cmake"
+  "/root/repo/_xiph_build/addons/primitives/CMakeFiles/allegro_primitives.dir/DependInfo.cmake"
+  "/root/repo/_xiph_build/addons/font/CMakeFiles/allegro_font.dir/DependInfo.cmake"
+  "/root/repo/_xiph_build/CMakeFiles/allegro.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -31,6 +31,7 @@ bool al_init_acodec_addon(void)
    ret &= al_register_sample_loader_f(".voc", _al_load_voc_f);
 
 #ifdef ALLEGRO_CFG_ACODEC_FLAC
+   _al_init_flac();
    ret &= al_register_sample_loader(".flac", _al_load_flac);
    ret &= al_register_audio_stream_loader(".flac", _al_load_flac_audio_stream);
    ret &= al_register_sample_loader_f(".flac", _al_load_flac_f);
@@ -49,6 +50,7 @@ bool al_init_acodec_addon(void)
 #endif
 
 #ifdef ALLEGRO_CFG_ACODEC_VORBIS
+   _al_init_ogg_vorbis();
    ret &= al_register_sample_loader(".ogg", _al_load_ogg_vorbis);
    ret &= al_register_audio_stream_loader(".ogg", _al_load_ogg_vorbis_audio_stream);
    ret &= al_register_sample_loader_f(".ogg", _al_load_ogg_vorbis_f);
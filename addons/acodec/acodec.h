@@ -22,6 +22,7 @@ ALLEGRO_SAMPLE *_al_load_voc_f(ALLEGRO_FILE *fp);
 
 
 #ifdef ALLEGRO_CFG_ACODEC_FLAC
+void _al_init_flac(void);
 ALLEGRO_SAMPLE *_al_load_flac(const char *filename);
 ALLEGRO_SAMPLE *_al_load_flac_f(ALLEGRO_FILE *f);
 ALLEGRO_AUDIO_STREAM *_al_load_flac_audio_stream(const char *filename,
@@ -50,6 +51,7 @@ ALLEGRO_AUDIO_STREAM *_al_load_s3m_audio_stream_f(ALLEGRO_FILE *f,
 #endif
 
 #ifdef ALLEGRO_CFG_ACODEC_VORBIS
+void _al_init_ogg_vorbis(void);
 ALLEGRO_SAMPLE *_al_load_ogg_vorbis(const char *filename);
 ALLEGRO_SAMPLE *_al_load_ogg_vorbis_f(ALLEGRO_FILE *file);
 ALLEGRO_AUDIO_STREAM *_al_load_ogg_vorbis_audio_stream(const char *filename,
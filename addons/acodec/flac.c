@@ -44,6 +44,16 @@ typedef struct FLACFILE {
    /* Sample position one past last streamed sample. */
    uint64_t streamed_samples;
 
+   /* Samples per frame, except maybe the last, in fixed-blocksize streams. */
+   unsigned min_blocksize;
+
+   /* Size of the smallest frame in bytes, or 0 if unknown. */
+   unsigned min_framesize;
+
+   /* Where the frames are, and where the first one starts, for streams. */
+   ACODEC_SEEK_INDEX index;
+   FLAC__uint64 frames_start;
+
    ALLEGRO_FILE *fh;
    uint64_t loop_start, loop_end; /* in samples */
 } FLACFILE;
@@ -54,6 +64,7 @@ typedef struct FLACFILE {
 static void *flac_dll = NULL;
 static bool flac_virgin = true;
 #endif
+static bool lib_initialised = false;
 
 static struct
 {
@@ -76,6 +87,7 @@ static struct
    FLAC__bool (*FLAC__stream_decoder_seek_absolute)(FLAC__StreamDecoder *decoder, FLAC__uint64 sample);
    FLAC__bool (*FLAC__stream_decoder_flush)(FLAC__StreamDecoder *decoder);
    FLAC__bool (*FLAC__stream_decoder_finish)(FLAC__StreamDecoder *decoder);
+   FLAC__bool (*FLAC__stream_decoder_get_decode_position)(const FLAC__StreamDecoder *decoder, FLAC__uint64 *position);
 } lib;
 
 
@@ -86,18 +98,23 @@ static void shutdown_dynlib(void)
       _al_close_library(flac_dll);
       flac_dll = NULL;
       flac_virgin = true;
+      lib_initialised = false;
    }
 }
 #endif
 
 
+/* Called by al_init_acodec_addon, before any loader can run, so the
+ * loaders only ever read the function table afterwards, even when
+ * several run at once (see al_load_samples_async).
+ */
 static bool init_dynlib(void)
 {
-#ifdef ALLEGRO_CFG_ACODEC_FLAC_DLL
-   if (flac_dll) {
+   if (lib_initialised) {
       return true;
    }
 
+#ifdef ALLEGRO_CFG_ACODEC_FLAC_DLL
    if (!flac_virgin) {
       return false;
    }
@@ -136,13 +153,21 @@ static bool init_dynlib(void)
    INITSYM(FLAC__stream_decoder_seek_absolute);
    INITSYM(FLAC__stream_decoder_flush);
    INITSYM(FLAC__stream_decoder_finish);
+   INITSYM(FLAC__stream_decoder_get_decode_position);
 
+   lib_initialised = true;
    return true;
 
 #undef INITSYM
 }
 
 
+void _al_init_flac(void)
+{
+   init_dynlib();
+}
+
+
 static FLAC__StreamDecoderReadStatus read_callback(const FLAC__StreamDecoder *decoder,
    FLAC__byte buffer[], size_t *bytes, void *dptr)
 {
@@ -236,6 +261,8 @@ static void metadata_callback(const FLAC__StreamDecoder *decoder,
       out->sample_rate = metadata->data.stream_info.sample_rate;
       out->channels = metadata->data.stream_info.channels;
       out->sample_size = metadata->data.stream_info.bits_per_sample / 8;
+      out->min_blocksize = metadata->data.stream_info.min_blocksize;
+      out->min_framesize = metadata->data.stream_info.min_framesize;
    }
 }
 
@@ -348,6 +375,7 @@ static void flac_close(FLACFILE *ff)
 {
    lib.FLAC__stream_decoder_finish(ff->decoder);
    lib.FLAC__stream_decoder_delete(ff->decoder);
+   _al_acodec_free_seek_index(&ff->index);
    /* Don't close ff->fh here. */
    al_free(ff);
 }
@@ -426,28 +454,262 @@ static void flac_stream_close(ALLEGRO_AUDIO_STREAM *stream)
    flac_close(ff);
 }
 
+/* Largest frame header: sync and codes, a 7 byte sample number, block size,
+ * sample rate and CRC-8.
+ */
+#define FRAME_HEADER_MAX      16
+
+/* How far ahead to look for the next frame sync code at once. */
+#define FRAME_SYNC_WINDOW     4096
+
+
+static unsigned char crc8_table[256];
+
+
+static void init_crc8_table(void)
+{
+   unsigned crc;
+   int i, j;
+
+   if (crc8_table[1])
+      return;
+
+   for (i = 0; i < 256; i++) {
+      crc = i;
+      for (j = 0; j < 8; j++)
+         crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) & 0xFF : (crc << 1) & 0xFF;
+      crc8_table[i] = crc;
+   }
+}
+
+
+static unsigned crc8(const unsigned char *p, size_t n)
+{
+   unsigned crc = 0;
+
+   while (n-- > 0)
+      crc = crc8_table[crc ^ *p++];
+
+   return crc;
+}
+
+
+/* parse_frame_header:
+ *  Checks that there is a header at `p' of the frame starting at sample
+ *  `expected', and finds the number of samples in it.  Audio data can look
+ *  like a sync code, so the reserved values and the CRC are checked too,
+ *  the CRC last as it is the dearest.
+ */
+static bool parse_frame_header(const unsigned char *p, size_t avail,
+   unsigned min_blocksize, uint64_t expected, unsigned *blocksize)
+{
+   const unsigned bs_code = p[2] >> 4;
+   const unsigned rate_code = p[2] & 0x0F;
+   uint64_t num;
+   int follow;
+   size_t n;
+
+   if (avail < 6 || p[0] != 0xFF || (p[1] & 0xFE) != 0xF8)
+      return false;
+   if (bs_code == 0 || rate_code == 15)
+      return false;
+   if ((p[3] >> 4) > 10 || ((p[3] >> 1) & 7) == 3 || (p[3] & 1))
+      return false;
+
+   /* The frame or sample number, coded like UTF-8. */
+   if (!(p[4] & 0x80)) { num = p[4]; follow = 0; }
+   else if ((p[4] & 0xE0) == 0xC0) { num = p[4] & 0x1F; follow = 1; }
+   else if ((p[4] & 0xF0) == 0xE0) { num = p[4] & 0x0F; follow = 2; }
+   else if ((p[4] & 0xF8) == 0xF0) { num = p[4] & 0x07; follow = 3; }
+   else if ((p[4] & 0xFC) == 0xF8) { num = p[4] & 0x03; follow = 4; }
+   else if ((p[4] & 0xFE) == 0xFC) { num = p[4] & 0x01; follow = 5; }
+   else if (p[4] == 0xFE) { num = 0; follow = 6; }
+   else return false;
+
+   for (n = 5; follow > 0; follow--, n++) {
+      if (n >= avail || (p[n] & 0xC0) != 0x80)
+         return false;
+      num = (num << 6) | (p[n] & 0x3F);
+   }
+
+   if (bs_code == 1)
+      *blocksize = 192;
+   else if (bs_code <= 5)
+      *blocksize = 576 << (bs_code - 2);
+   else if (bs_code == 6) {
+      if (n + 1 > avail)
+         return false;
+      *blocksize = p[n] + 1;
+      n += 1;
+   }
+   else if (bs_code == 7) {
+      if (n + 2 > avail)
+         return false;
+      *blocksize = ((p[n] << 8) | p[n + 1]) + 1;
+      n += 2;
+   }
+   else
+      *blocksize = 256 << (bs_code - 8);
+
+   if (rate_code == 12)
+      n += 1;
+   else if (rate_code == 13 || rate_code == 14)
+      n += 2;
+
+   /* Fixed-blocksize streams count frames rather than samples. */
+   if (!(p[1] & 1))
+      num *= min_blocksize;
+   if (num != expected)
+      return false;
+
+   return n < avail && crc8(p, n) == p[n];
+}
+
+
+/* build_seek_index:
+ *  Finds the frames of the file, from the end of the metadata.  Frames
+ *  which do not follow on from the previous one are false syncs; the index
+ *  stops short if the real next frame is damaged.
+ */
+static void build_seek_index(FLACFILE *ff)
+{
+   ACODEC_SCAN_BUFFER sb;
+   int64_t saved = al_ftell(ff->fh);
+   FLAC__uint64 pos = ff->frames_start;
+   uint64_t expected = 0;
+
+   if (saved < 0 || pos == 0 || ff->total_samples == 0 ||
+         al_fsize(ff->fh) <= 0)
+      return;
+   if (!_al_acodec_init_scan_buffer(&sb, ff->fh))
+      return;
+   init_crc8_table();
+
+   while (expected < ff->total_samples) {
+      const unsigned char *p;
+      const unsigned char *sync;
+      size_t avail;
+      unsigned blocksize;
+
+      p = _al_acodec_scan_peek(&sb, pos, FRAME_SYNC_WINDOW, &avail);
+      if (avail < 2)
+         break;
+      sync = memchr(p, 0xFF, avail);
+      if (!sync) {
+         pos += avail;
+         continue;
+      }
+      pos += sync - p;
+
+      p = _al_acodec_scan_peek(&sb, pos, FRAME_HEADER_MAX, &avail);
+      if (avail >= 2 && parse_frame_header(p, avail, ff->min_blocksize,
+            expected, &blocksize)) {
+         _al_acodec_add_seek_point(&ff->index, expected, pos);
+         expected += blocksize;
+         /* The next frame cannot start inside this one. */
+         pos += _ALLEGRO_MAX(ff->min_framesize, 1);
+      }
+      else {
+         pos++;
+      }
+   }
+
+   _al_acodec_free_scan_buffer(&sb);
+   al_fseek(ff->fh, saved, ALLEGRO_SEEK_SET);
+
+   ff->index.end = expected;
+   ALLEGRO_DEBUG("Indexed %d seek points covering %lu samples\n",
+      (int)_al_vector_size(&ff->index.points), (unsigned long)expected);
+}
+
+
+/* skip_samples:
+ *  Decodes and throws away samples up to `sample'.
+ */
+static bool skip_samples(FLACFILE *ff, uint64_t sample)
+{
+   const int bytes_per_sample = ff->sample_size * ff->channels;
+
+   while (ff->streamed_samples < sample) {
+      uint64_t n = ff->decoded_samples - ff->streamed_samples;
+      size_t bytes;
+
+      if (!n) {
+         if (!lib.FLAC__stream_decoder_process_single(ff->decoder))
+            return false;
+         n = ff->decoded_samples - ff->streamed_samples;
+         if (!n)
+            return false;
+      }
+
+      if (n > sample - ff->streamed_samples)
+         n = sample - ff->streamed_samples;
+      bytes = n * bytes_per_sample;
+      memmove(ff->buffer, ff->buffer + bytes, ff->buffer_pos - bytes);
+      ff->buffer_pos -= bytes;
+      ff->streamed_samples += n;
+   }
+
+   return true;
+}
+
+
+/* index_seek:
+ *  Starts decoding at the indexed frame before `sample', and decodes up to
+ *  it.
+ */
+static bool index_seek(FLACFILE *ff, uint64_t sample)
+{
+   const int i = _al_acodec_find_seek_point(&ff->index, sample);
+   const ACODEC_SEEK_POINT *point;
+
+   if (i < 0)
+      return false;
+   point = _al_acodec_get_seek_point(&ff->index, i);
+
+   /* The decoder finds the frame sync right where the file now is. */
+   lib.FLAC__stream_decoder_flush(ff->decoder);
+   if (!al_fseek(ff->fh, point->offset, ALLEGRO_SEEK_SET))
+      return false;
+
+   ff->buffer_pos = 0;
+   ff->streamed_samples = point->sample;
+   ff->decoded_samples = point->sample;
+   return skip_samples(ff, sample);
+}
+
+
 static bool real_seek(ALLEGRO_AUDIO_STREAM *stream, uint64_t sample)
 {
    FLACFILE *ff = stream->extra;
 
+   /* Rewinding to the start is quick enough without an index. */
+   if (sample > 0 && _al_acodec_want_seek_index(&ff->index, stream))
+      build_seek_index(ff);
+   if (index_seek(ff, sample))
+      return true;
+
    /* We use ff->streamed_samples as the exact sample position for looping and
     * returning the position. Therefore we also use it as reference position
     * when seeking - that is, we call flush below to make the FLAC decoder
     * discard any additional samples it may have buffered already.
+    * The seek passes the rest of the target frame to the write callback, so
+    * the counters are reset first.
     * */
    lib.FLAC__stream_decoder_flush(ff->decoder);
-   lib.FLAC__stream_decoder_seek_absolute(ff->decoder, sample);
-
    ff->buffer_pos = 0;
    ff->streamed_samples = sample;
    ff->decoded_samples = sample;
-   return true;
+   return lib.FLAC__stream_decoder_seek_absolute(ff->decoder, sample);
 }
 
 static bool flac_stream_seek(ALLEGRO_AUDIO_STREAM *stream, double time)
 {
    FLACFILE *ff = stream->extra;
-   uint64_t sample = time * ff->sample_rate;
+   /* Round, so that seeking to a position read back from the stream lands on
+    * the same sample.
+    */
+   uint64_t sample = time * ff->sample_rate + 0.5;
    return real_seek(stream, sample);
 }
 
@@ -467,8 +729,8 @@ static bool flac_stream_set_loop(ALLEGRO_AUDIO_STREAM *stream, double start,
    double end)
 {
    FLACFILE *ff = stream->extra;
-   ff->loop_start = start * ff->sample_rate;
-   ff->loop_end = end * ff->sample_rate;
+   ff->loop_start = start * ff->sample_rate + 0.5;
+   ff->loop_end = end * ff->sample_rate + 0.5;
    return true;
 }
 
@@ -482,6 +744,7 @@ static FLACFILE *flac_open(ALLEGRO_FILE* f)
    }
 
    ff = al_calloc(1, sizeof *ff);
+   _al_acodec_init_seek_index(&ff->index);
 
    ff->decoder = lib.FLAC__stream_decoder_new();
    if (!ff->decoder) {
@@ -612,6 +875,11 @@ ALLEGRO_AUDIO_STREAM *_al_load_flac_audio_stream_f(ALLEGRO_FILE* f,
       _al_count_to_channel_conf(ff->channels));
 
    if (stream) {
+      if (!lib.FLAC__stream_decoder_get_decode_position(ff->decoder,
+            &ff->frames_start)) {
+         ff->frames_start = 0;
+      }
+
       stream->extra = ff;
       ff->loop_start = 0;
       ff->loop_end = ff->total_samples;
@@ -622,7 +890,6 @@ ALLEGRO_AUDIO_STREAM *_al_load_flac_audio_stream_f(ALLEGRO_FILE* f,
       stream->get_feeder_position = flac_stream_get_position;
       stream->get_feeder_length = flac_stream_get_length;
       stream->set_feeder_loop = flac_stream_set_loop;
-      _al_acodec_start_feed_thread(stream);
    }
    else {
       al_fclose(ff->fh);
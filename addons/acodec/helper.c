@@ -5,32 +5,164 @@
 #include "allegro5/internal/aintern_system.h"
 #include "helper.h"
 
-void _al_acodec_start_feed_thread(ALLEGRO_AUDIO_STREAM *stream)
+void _al_acodec_stop_feed_thread(ALLEGRO_AUDIO_STREAM *stream)
 {
-   stream->feed_thread = al_create_thread(_al_kcm_feed_stream, stream);
-   stream->feed_thread_started_cond = al_create_cond();
-   stream->feed_thread_started_mutex = al_create_mutex();
-   al_start_thread(stream->feed_thread);
+   _al_kcm_stop_stream_feeder(stream);
 }
 
-void _al_acodec_stop_feed_thread(ALLEGRO_AUDIO_STREAM *stream)
+
+/* Seek points closer together than this many samples are not kept; at most
+ * this many samples are decoded and thrown away by a seek.
+ */
+#define SEEK_POINT_SPACING    4096
+
+#define SCAN_CHUNK_SIZE       (64 * 1024)
+
+
+/* Returns true the first time a stream which should be indexed asks.
+ * Streams of compressed samples are never indexed, their data is already
+ * in memory and quick to search.
+ */
+bool _al_acodec_want_seek_index(ACODEC_SEEK_INDEX *index,
+   ALLEGRO_AUDIO_STREAM *stream)
+{
+   const char *p;
+
+   if (index->scanned)
+      return false;
+   index->scanned = true;
+
+   if (stream->data_in_memory)
+      return false;
+
+   p = al_get_config_value(al_get_system_config(), "audio",
+      "stream_seek_index");
+   return !p || atoi(p) != 0;
+}
+
+
+void _al_acodec_init_seek_index(ACODEC_SEEK_INDEX *index)
 {
-   ALLEGRO_EVENT quit_event;
+   _al_vector_init(&index->points, sizeof(ACODEC_SEEK_POINT));
+   index->end = 0;
+   index->scanned = false;
+}
+
+
+void _al_acodec_add_seek_point(ACODEC_SEEK_INDEX *index, uint64_t sample,
+   int64_t offset)
+{
+   ACODEC_SEEK_POINT *point;
 
-   /* Need to wait for the thread to start, otherwise the quit event may be
-    * sent before the event source is registered with the queue. */
-   al_lock_mutex(stream->feed_thread_started_mutex);
-   while (!stream->feed_thread_started) {
-      al_wait_cond(stream->feed_thread_started_cond, stream->feed_thread_started_mutex);
+   if (_al_vector_is_nonempty(&index->points)) {
+      point = _al_vector_ref_back(&index->points);
+      /* Of points at the same sample, the later one skips more data. */
+      if (sample == point->sample) {
+         point->offset = offset;
+         return;
+      }
+      if (sample < point->sample + SEEK_POINT_SPACING)
+         return;
    }
-   al_unlock_mutex(stream->feed_thread_started_mutex);
 
-   quit_event.type = _KCM_STREAM_FEEDER_QUIT_EVENT_TYPE;
-   al_emit_user_event(al_get_audio_stream_event_source(stream), &quit_event, NULL);
-   al_join_thread(stream->feed_thread, NULL);
-   al_destroy_thread(stream->feed_thread);
-   al_destroy_cond(stream->feed_thread_started_cond);
-   al_destroy_mutex(stream->feed_thread_started_mutex);
+   point = _al_vector_alloc_back(&index->points);
+   if (point) {
+      point->sample = sample;
+      point->offset = offset;
+   }
+}
+
+
+/* Returns the index of the last seek point at or before `sample', or -1 if
+ * the sample is not covered by the index.
+ */
+int _al_acodec_find_seek_point(const ACODEC_SEEK_INDEX *index,
+   uint64_t sample)
+{
+   int lo = 0;
+   int hi = (int)_al_vector_size(&index->points) - 1;
+   int found = -1;
+
+   if (sample >= index->end)
+      return -1;
+
+   while (lo <= hi) {
+      const int mid = (lo + hi) / 2;
+      const ACODEC_SEEK_POINT *point = _al_vector_ref(&index->points, mid);
+
+      if (point->sample <= sample) {
+         found = mid;
+         lo = mid + 1;
+      }
+      else {
+         hi = mid - 1;
+      }
+   }
 
-   stream->feed_thread = NULL;
+   return found;
 }
+
+
+const ACODEC_SEEK_POINT *_al_acodec_get_seek_point(
+   const ACODEC_SEEK_INDEX *index, int i)
+{
+   return _al_vector_ref(&index->points, i);
+}
+
+
+void _al_acodec_free_seek_index(ACODEC_SEEK_INDEX *index)
+{
+   _al_vector_free(&index->points);
+   index->end = 0;
+}
+
+
+bool _al_acodec_init_scan_buffer(ACODEC_SCAN_BUFFER *sb, ALLEGRO_FILE *file)
+{
+   sb->file = file;
+   sb->start = 0;
+   sb->len = 0;
+   sb->data = al_malloc(SCAN_CHUNK_SIZE);
+   return sb->data != NULL;
+}
+
+
+/* Returns the `n' bytes at `pos' in the file, refilling the buffer from there
+ * if they are not all in it.  Fewer bytes are available at the end of the
+ * file.  The file is only read forward unless `pos' is behind the buffer.
+ */
+const unsigned char *_al_acodec_scan_peek(ACODEC_SCAN_BUFFER *sb,
+   int64_t pos, size_t n, size_t *avail)
+{
+   ASSERT(n <= SCAN_CHUNK_SIZE);
+
+   if (pos < sb->start || pos + (int64_t)n > sb->start + (int64_t)sb->len) {
+      size_t keep = 0;
+
+      if (sb->len > 0 && pos >= sb->start &&
+            pos <= sb->start + (int64_t)sb->len) {
+         /* Keep the tail and carry on reading where the last chunk ended. */
+         keep = sb->start + sb->len - pos;
+         memmove(sb->data, sb->data + (pos - sb->start), keep);
+      }
+      else if (!al_fseek(sb->file, pos, ALLEGRO_SEEK_SET)) {
+         *avail = 0;
+         return NULL;
+      }
+      sb->start = pos;
+      sb->len = keep + al_fread(sb->file, sb->data + keep,
+         SCAN_CHUNK_SIZE - keep);
+   }
+
+   *avail = _ALLEGRO_MIN(n, (size_t)(sb->start + sb->len - pos));
+   return sb->data + (pos - sb->start);
+}
+
+
+void _al_acodec_free_scan_buffer(ACODEC_SCAN_BUFFER *sb)
+{
+   al_free(sb->data);
+   sb->data = NULL;
+}
+
+/* vim: set sts=3 sw=3 et: */
@@ -1,7 +1,48 @@
 #ifndef __al_included_acodec_helper_h
 #define __al_included_acodec_helper_h
 
-void _al_acodec_start_feed_thread(ALLEGRO_AUDIO_STREAM *stream);
+#include "allegro5/internal/aintern_vector.h"
+
 void _al_acodec_stop_feed_thread(ALLEGRO_AUDIO_STREAM *stream);
 
+/* A place in a stream where decoding can start. */
+typedef struct ACODEC_SEEK_POINT {
+   uint64_t sample;     /* The first sample decoded from there. */
+   int64_t offset;      /* Byte offset in the file. */
+} ACODEC_SEEK_POINT;
+
+/* Seek points in increasing order, built the first time a stream seeks
+ * away from its start so that later seeks cost one read rather than a
+ * search of the file.
+ */
+typedef struct ACODEC_SEEK_INDEX {
+   _AL_VECTOR points;
+   uint64_t end;        /* Samples covered by the points. */
+   bool scanned;        /* Whether building it was attempted. */
+} ACODEC_SEEK_INDEX;
+
+bool _al_acodec_want_seek_index(ACODEC_SEEK_INDEX *index,
+   ALLEGRO_AUDIO_STREAM *stream);
+void _al_acodec_init_seek_index(ACODEC_SEEK_INDEX *index);
+void _al_acodec_add_seek_point(ACODEC_SEEK_INDEX *index, uint64_t sample,
+   int64_t offset);
+int _al_acodec_find_seek_point(const ACODEC_SEEK_INDEX *index,
+   uint64_t sample);
+const ACODEC_SEEK_POINT *_al_acodec_get_seek_point(
+   const ACODEC_SEEK_INDEX *index, int i);
+void _al_acodec_free_seek_index(ACODEC_SEEK_INDEX *index);
+
+/* Reads a file forward in large chunks while building a seek index. */
+typedef struct ACODEC_SCAN_BUFFER {
+   ALLEGRO_FILE *file;
+   int64_t start;
+   size_t len;
+   unsigned char *data;
+} ACODEC_SCAN_BUFFER;
+
+bool _al_acodec_init_scan_buffer(ACODEC_SCAN_BUFFER *sb, ALLEGRO_FILE *file);
+const unsigned char *_al_acodec_scan_peek(ACODEC_SCAN_BUFFER *sb,
+   int64_t pos, size_t n, size_t *avail);
+void _al_acodec_free_scan_buffer(ACODEC_SCAN_BUFFER *sb);
+
 #endif
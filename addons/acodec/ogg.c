@@ -34,6 +34,9 @@ struct AL_OV_DATA {
    vorbis_info *vi;
    ALLEGRO_FILE *file;
    int bitstream;
+   bool float_decode;
+   ACODEC_SEEK_INDEX index;   /* Granule positions of the pages. */
+   int64_t start;             /* Where the file starts, or -1. */
    double loop_start;
    double loop_end;
 };
@@ -44,6 +47,7 @@ struct AL_OV_DATA {
 static void *ov_dll = NULL;
 static bool ov_virgin = true;
 #endif
+static bool lib_initialised = false;
 
 static struct
 {
@@ -53,9 +57,12 @@ static struct
 #ifndef TREMOR
    int (*ov_open_callbacks)(void *, OggVorbis_File *, const char *, long, ov_callbacks);
    double (*ov_time_total)(OggVorbis_File *, int);
-   int (*ov_time_seek_lap)(OggVorbis_File *, double);
+   int (*ov_pcm_seek_lap)(OggVorbis_File *, ogg_int64_t);
    double (*ov_time_tell)(OggVorbis_File *);
+   int (*ov_raw_seek_lap)(OggVorbis_File *, ogg_int64_t);
+   ogg_int64_t (*ov_pcm_tell)(OggVorbis_File *);
    long (*ov_read)(OggVorbis_File *, char *, int, int, int, int, int *);
+   long (*ov_read_float)(OggVorbis_File *, float ***, int, int *);
 #else
    int (*ov_open_callbacks)(void *, OggVorbis_File *, const char *, long, ov_callbacks);
    ogg_int64_t (*ov_time_total)(OggVorbis_File *, int);
@@ -73,18 +80,23 @@ static void shutdown_dynlib(void)
       _al_close_library(ov_dll);
       ov_dll = NULL;
       ov_virgin = true;
+      lib_initialised = false;
    }
 }
 #endif
 
 
+/* Called by al_init_acodec_addon, before any loader can run, so the
+ * loaders only ever read the function table afterwards, even when
+ * several run at once (see al_load_samples_async).
+ */
 static bool init_dynlib(void)
 {
-#ifdef ALLEGRO_CFG_ACODEC_VORBISFILE_DLL
-   if (ov_dll) {
+   if (lib_initialised) {
       return true;
    }
 
+#ifdef ALLEGRO_CFG_ACODEC_VORBISFILE_DLL
    if (!ov_virgin) {
       return false;
    }
@@ -120,9 +132,12 @@ static bool init_dynlib(void)
    INITSYM(ov_info);
 #ifndef TREMOR
    INITSYM(ov_time_total);
-   INITSYM(ov_time_seek_lap);
+   INITSYM(ov_pcm_seek_lap);
    INITSYM(ov_time_tell);
+   INITSYM(ov_raw_seek_lap);
+   INITSYM(ov_pcm_tell);
    INITSYM(ov_read);
+   INITSYM(ov_read_float);
 #else
    INITSYM(ov_time_total);
    INITSYM(ov_time_seek);
@@ -130,12 +145,19 @@ static bool init_dynlib(void)
    INITSYM(ov_read);
 #endif
 
+   lib_initialised = true;
    return true;
 
 #undef INITSYM
 }
 
 
+void _al_init_ogg_vorbis(void)
+{
+   init_dynlib();
+}
+
+
 static size_t read_callback(void *ptr, size_t size, size_t nmemb, void *dptr)
 {
    AL_OV_DATA *ov = (AL_OV_DATA *)dptr;
@@ -194,6 +216,68 @@ static ov_callbacks callbacks = {
 };
 
 
+/* Whether to decode to float, which the float mixer uses as is, rather than
+ * 16-bit integers.  Tremor only decodes to integers.
+ */
+static bool want_float_decode(void)
+{
+#ifndef TREMOR
+   const char *p;
+
+   p = al_get_config_value(al_get_system_config(), "audio", "ogg_float");
+   return p && atoi(p) != 0;
+#else
+   return false;
+#endif
+}
+
+
+#ifndef TREMOR
+/* ov_read scales the decoded values by 32768 and clips them to 16 bits, and
+ * the mixers divide 16-bit values by 32767.5.  Decoded floats are scaled and
+ * clipped to match, so that a file plays the same either way but for the
+ * rounding to 16 bits.
+ */
+#define FLOAT_SCALE     (32768.0f / 32767.5f)
+#define FLOAT_MIN       (-32768.0f / 32767.5f)
+#define FLOAT_MAX       (32767.0f / 32767.5f)
+
+
+/* read_float_frames:
+ *  Decodes up to `frames' frames into `out' as interleaved floats.  Returns
+ *  the number of frames written, 0 at the end of the stream or on error.
+ */
+static long read_float_frames(OggVorbis_File *vf, float *out, int channels,
+   long frames, int *bitstream)
+{
+   float **pcm;
+   long read;
+   long i;
+   int c;
+
+   do {
+      read = lib.ov_read_float(vf, &pcm, frames, bitstream);
+   } while (read == OV_HOLE);
+
+   if (read < 0)
+      return 0;
+
+   for (i = 0; i < read; i++) {
+      for (c = 0; c < channels; c++) {
+         float v = pcm[c][i] * FLOAT_SCALE;
+         if (v < FLOAT_MIN)
+            v = FLOAT_MIN;
+         else if (v > FLOAT_MAX)
+            v = FLOAT_MAX;
+         *out++ = v;
+      }
+   }
+
+   return read;
+}
+#endif
+
+
 ALLEGRO_SAMPLE *_al_load_ogg_vorbis(const char *filename)
 {
    ALLEGRO_FILE *f;
@@ -217,8 +301,8 @@ ALLEGRO_SAMPLE *_al_load_ogg_vorbis(const char *filename)
 
 ALLEGRO_SAMPLE *_al_load_ogg_vorbis_f(ALLEGRO_FILE *file)
 {
-   /* Note: decoding library returns floats.  I always return 16-bit (most
-    * commonly supported).
+   /* Note: decoding library returns floats.  We return 16-bit (most
+    * commonly supported) unless asked for floats.
     */
 #ifdef ALLEGRO_LITTLE_ENDIAN
    const int endian = 0; /* 0 for Little-Endian, 1 for Big-Endian */
@@ -240,11 +324,15 @@ ALLEGRO_SAMPLE *_al_load_ogg_vorbis_f(ALLEGRO_FILE *file)
    long total_size;
    AL_OV_DATA ov;
    long read;
+   bool float_decode = want_float_decode();
 
    if (!init_dynlib()) {
       return NULL;
    }
 
+   if (float_decode)
+      word_size = 4;
+
    ov.file = file;
    if (lib.ov_open_callbacks(&ov, &vf, NULL, 0, callbacks) < 0) {
       ALLEGRO_WARN("Audio file does not appear to be an Ogg bitstream.\n");
@@ -270,6 +358,32 @@ ALLEGRO_SAMPLE *_al_load_ogg_vorbis_f(ALLEGRO_FILE *file)
       return NULL;
    }
 
+#ifndef TREMOR
+   if (float_decode) {
+      pos = 0;
+      while (pos < total_samples) {
+         read = read_float_frames(&vf, (float *)buffer + pos * channels,
+            channels, _ALLEGRO_MIN(packet_size, total_samples - pos),
+            &bitstream);
+         pos += read;
+         if (read == 0)
+            break;
+      }
+
+      lib.ov_clear(&vf);
+
+      /* A damaged file may decode short; leave out the unwritten rest. */
+      sample = al_create_sample(buffer, pos, rate,
+         ALLEGRO_AUDIO_DEPTH_FLOAT32, _al_count_to_channel_conf(channels),
+         true);
+      if (!sample) {
+         al_free(buffer);
+      }
+
+      return sample;
+   }
+#endif
+
    pos = 0;
    while (pos < total_size) {
       const int read_size = _ALLEGRO_MIN(packet_size, total_size - pos);
@@ -284,14 +398,16 @@ ALLEGRO_SAMPLE *_al_load_ogg_vorbis_f(ALLEGRO_FILE *file)
       (void)signedness;
       read = lib.ov_read(&vf, buffer + pos, read_size, &bitstream);
 #endif
-      pos += read;
-      if (read == 0)
+      if (read == OV_HOLE)
+         continue;
+      if (read <= 0)
          break;
+      pos += read;
    }
 
    lib.ov_clear(&vf);
 
-   sample = al_create_sample(buffer, total_samples, rate,
+   sample = al_create_sample(buffer, pos / (channels * word_size), rate,
       _al_word_size_to_depth_conf(word_size),
       _al_count_to_channel_conf(channels), true);
 
@@ -303,13 +419,160 @@ ALLEGRO_SAMPLE *_al_load_ogg_vorbis_f(ALLEGRO_FILE *file)
 }
 
 
+#ifndef TREMOR
+/* Ogg page header fields. */
+#define OGG_PAGE_HEADER_SIZE     27
+#define OGG_PAGE_CONTINUED       0x01
+
+
+static int64_t read_le(const unsigned char *p, int bytes)
+{
+   uint64_t x = 0;
+
+   while (bytes-- > 0)
+      x = (x << 8) | p[bytes];
+
+   return (int64_t)x;
+}
+
+
+/* build_seek_index:
+ *  Walks the pages of the file from `start', remembering where the pages
+ *  which begin with a new packet are and the granule position (sample) they
+ *  follow.  Chained files, which libvorbisfile seeks through link by link,
+ *  get no index.
+ */
+static void build_seek_index(AL_OV_DATA *extra, int64_t start)
+{
+   ACODEC_SCAN_BUFFER sb;
+   int64_t saved = al_ftell(extra->file);
+   int64_t pos = start;
+   int64_t granule = -1;
+   int64_t serial = -1;
+   bool ok = false;
+
+   if (saved < 0 || al_fsize(extra->file) <= 0)
+      return;
+   if (!_al_acodec_init_scan_buffer(&sb, extra->file))
+      return;
+
+   for (;;) {
+      const unsigned char *p;
+      size_t avail;
+      int64_t page_granule;
+      int nsegs;
+      int body;
+      int i;
+
+      p = _al_acodec_scan_peek(&sb, pos, OGG_PAGE_HEADER_SIZE, &avail);
+      if (avail == 0) {
+         ok = true;
+         break;
+      }
+      if (avail < OGG_PAGE_HEADER_SIZE || memcmp(p, "OggS", 4) != 0 ||
+            p[4] != 0) {
+         ALLEGRO_WARN("Lost Ogg page sync at %ld\n", (long)pos);
+         break;
+      }
+      if (serial != -1 && serial != read_le(p + 14, 4)) {
+         ALLEGRO_DEBUG("Chained Ogg file, not indexing it\n");
+         break;
+      }
+      serial = read_le(p + 14, 4);
+      page_granule = read_le(p + 6, 8);
+
+      if (granule >= 0 && !(p[5] & OGG_PAGE_CONTINUED))
+         _al_acodec_add_seek_point(&extra->index, granule, pos);
+      if (page_granule != -1)
+         granule = page_granule;
+
+      nsegs = p[26];
+      p = _al_acodec_scan_peek(&sb, pos + OGG_PAGE_HEADER_SIZE, nsegs,
+         &avail);
+      if ((int)avail < nsegs)
+         break;
+      for (body = 0, i = 0; i < nsegs; i++)
+         body += p[i];
+
+      pos += OGG_PAGE_HEADER_SIZE + nsegs + body;
+   }
+
+   _al_acodec_free_scan_buffer(&sb);
+   al_fseek(extra->file, saved, ALLEGRO_SEEK_SET);
+
+   if (ok && granule > 0) {
+      extra->index.end = granule;
+      ALLEGRO_DEBUG("Indexed %d seek points\n",
+         (int)_al_vector_size(&extra->index.points));
+   }
+   else {
+      _al_acodec_free_seek_index(&extra->index);
+   }
+}
+
+
+/* index_seek:
+ *  Seeks to the indexed page before `sample' and decodes up to it.  The
+ *  first packet after a page boundary only primes the decoder, so decoding
+ *  may start a little late; then the previous seek point is used.
+ */
+static bool index_seek(AL_OV_DATA *extra, ogg_int64_t sample)
+{
+   int i = _al_acodec_find_seek_point(&extra->index, sample);
+   int tries;
+
+   for (tries = 0; tries < 2 && i >= 0; tries++, i--) {
+      const ACODEC_SEEK_POINT *point =
+         _al_acodec_get_seek_point(&extra->index, i);
+      ogg_int64_t pos;
+
+      if (lib.ov_raw_seek_lap(extra->vf, point->offset) != 0)
+         return false;
+      pos = lib.ov_pcm_tell(extra->vf);
+      if (pos < 0)
+         return false;
+      if (pos > sample)
+         continue;
+
+      while (pos < sample) {
+         float **pcm;
+         long read = lib.ov_read_float(extra->vf, &pcm,
+            _ALLEGRO_MIN(sample - pos, 4096), &extra->bitstream);
+         if (read == OV_HOLE)
+            continue;
+         if (read <= 0)
+            return false;
+         pos += read;
+      }
+      return true;
+   }
+
+   return false;
+}
+#endif
+
+
 static bool ogg_stream_seek(ALLEGRO_AUDIO_STREAM *stream, double time)
 {
    AL_OV_DATA *extra = (AL_OV_DATA *) stream->extra;
    if (time >= extra->loop_end)
       return false;
 #ifndef TREMOR
-   return (lib.ov_time_seek_lap(extra->vf, time) != -1);
+   {
+      /* Round, so that seeking to a position read back from the stream lands
+       * on the same sample.
+       */
+      const ogg_int64_t sample = (ogg_int64_t)(time * extra->vi->rate + 0.5);
+
+      /* Rewinding to the start is quick enough without an index. */
+      if (sample > 0 && extra->start >= 0 &&
+            _al_acodec_want_seek_index(&extra->index, stream)) {
+         build_seek_index(extra, extra->start);
+      }
+      if (index_seek(extra, sample))
+         return true;
+      return lib.ov_pcm_seek_lap(extra->vf, sample) == 0;
+   }
 #else
    return lib.ov_time_seek(extra->vf, time*1000) != -1;
 #endif
@@ -368,6 +631,7 @@ static void ogg_stream_close(ALLEGRO_AUDIO_STREAM *stream)
 
    lib.ov_clear(extra->vf);
    al_free(extra->vf);
+   _al_acodec_free_seek_index(&extra->index);
    al_free(extra);
    stream->extra = NULL;
 }
@@ -383,7 +647,7 @@ static size_t ogg_stream_update(ALLEGRO_AUDIO_STREAM *stream, void *data,
 #else
    const int endian = 1;      /* 0 for Little-Endian, 1 for Big-Endian */
 #endif
-   const int word_size = 2;   /* 1 = 8bit, 2 = 16-bit. nothing else */
+   const int word_size = extra->float_decode ? 4 : 2;
    const int signedness = 1;  /* 0 for unsigned, 1 for signed */
 
    unsigned long pos = 0;
@@ -395,7 +659,7 @@ static size_t ogg_stream_update(ALLEGRO_AUDIO_STREAM *stream, void *data,
 #endif
    double rate = extra->vi->rate;
    double btime = ((double)buf_size / ((double)word_size * (double)extra->vi->channels)) / rate;
-   unsigned long read;
+   long read;
    
    if (stream->spl.loop == _ALLEGRO_PLAYMODE_STREAM_ONEDIR) {
       if (ctime + btime > extra->loop_end) {
@@ -405,6 +669,26 @@ static size_t ogg_stream_update(ALLEGRO_AUDIO_STREAM *stream, void *data,
          read_length += read_length % word_size;
       }
    }
+
+#ifndef TREMOR
+   if (extra->float_decode) {
+      const int frame_size = word_size * extra->vi->channels;
+      const long frames = read_length / frame_size;
+      long done = 0;
+
+      while (done < frames) {
+         read = read_float_frames(extra->vf, (float *)data + done *
+            extra->vi->channels, extra->vi->channels, frames - done,
+            &extra->bitstream);
+         done += read;
+         if (read == 0)
+            break;
+      }
+
+      return done * frame_size;
+   }
+#endif
+
    while (pos < (unsigned long)read_length) {
 #ifndef TREMOR
       read = lib.ov_read(extra->vf, (char *)data + pos,
@@ -415,12 +699,13 @@ static size_t ogg_stream_update(ALLEGRO_AUDIO_STREAM *stream, void *data,
       read = lib.ov_read(extra->vf, (char *)data + pos,
          read_length - pos, &extra->bitstream);
 #endif
-      pos += read;
-	   
-      if (read == 0) {
+      if (read == OV_HOLE)
+         continue;
+      if (read <= 0) {
          /* Return the number of useful bytes written. */
          return pos;
       }
+      pos += read;
    }
 
    return pos;
@@ -453,7 +738,9 @@ ALLEGRO_AUDIO_STREAM *_al_load_ogg_vorbis_audio_stream(const char *filename,
 ALLEGRO_AUDIO_STREAM *_al_load_ogg_vorbis_audio_stream_f(ALLEGRO_FILE *file,
    size_t buffer_count, unsigned int samples)
 {
-   const int word_size = 2; /* 1 = 8bit, 2 = 16-bit. nothing else */
+   const bool float_decode = want_float_decode();
+   const int word_size = float_decode ? 4 : 2;
+   const int64_t start = al_ftell(file);
    OggVorbis_File* vf;
    vorbis_info* vi;
    int channels;
@@ -474,6 +761,8 @@ ALLEGRO_AUDIO_STREAM *_al_load_ogg_vorbis_audio_stream_f(ALLEGRO_FILE *file,
    }
 
    extra->file = file;
+   extra->start = start;
+   _al_acodec_init_seek_index(&extra->index);
    
    vf = al_malloc(sizeof(OggVorbis_File));
    if (lib.ov_open_callbacks(extra, vf, NULL, 0, callbacks) < 0) {
@@ -492,6 +781,7 @@ ALLEGRO_AUDIO_STREAM *_al_load_ogg_vorbis_audio_stream_f(ALLEGRO_FILE *file,
    extra->vi = vi;
 
    extra->bitstream = -1;
+   extra->float_decode = float_decode;
 
    ALLEGRO_DEBUG("channels %d\n", channels);
    ALLEGRO_DEBUG("word_size %d\n", word_size);
@@ -500,11 +790,13 @@ ALLEGRO_AUDIO_STREAM *_al_load_ogg_vorbis_audio_stream_f(ALLEGRO_FILE *file,
    ALLEGRO_DEBUG("total_size %ld\n", total_size);
 	
    stream = al_create_audio_stream(buffer_count, samples, rate,
-            _al_word_size_to_depth_conf(word_size),
+            float_decode ? ALLEGRO_AUDIO_DEPTH_FLOAT32 :
+               _al_word_size_to_depth_conf(word_size),
             _al_count_to_channel_conf(channels));
    if (!stream) {
       lib.ov_clear(vf);
       al_free(vf);
+      _al_acodec_free_seek_index(&extra->index);
       return NULL;
    }
 
@@ -520,8 +812,7 @@ ALLEGRO_AUDIO_STREAM *_al_load_ogg_vorbis_audio_stream_f(ALLEGRO_FILE *file,
    stream->get_feeder_length = ogg_stream_get_length;
    stream->set_feeder_loop = ogg_stream_set_loop;
    stream->unload_feeder = ogg_stream_close;
-   _al_acodec_start_feed_thread(stream);
-	
+
    return stream;
 }
 
@@ -10,8 +10,23 @@
 #include "acodec.h"
 #include "helper.h"
 
+/* The data of PCM WAV files can be played straight from a mapping of the
+ * file, as long as it does not need byte swapping.
+ */
+#if defined(ALLEGRO_HAVE_MMAP) && defined(ALLEGRO_UNIX) && \
+      !defined(ALLEGRO_BIG_ENDIAN)
+   #define WAV_MMAP
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+   #include "allegro5/internal/aintern_file.h"
+#endif
+
 ALLEGRO_DEBUG_CHANNEL("wav")
 
+#define WAV_FORMAT_PCM  1
+
 
 typedef struct WAVFILE
 {
@@ -24,9 +39,84 @@ typedef struct WAVFILE
    int samples;     /* # of samples. size = samples * sample_size */
    double loop_start;
    double loop_end;
+   short format;    /* WAV_FORMAT_PCM, or one of the _AL_ADPCM_FORMATs */
+   int block_align; /* ADPCM: bytes in each block */
+   int samples_per_block;
+   int num_coefs;
+   int16_t *coefs;  /* MS ADPCM: the predictor coefficient pairs */
+   int data_size;   /* ADPCM: bytes in the data chunk */
+   int fact_samples; /* ADPCM: # of samples given by the fact chunk, or -1 */
 } WAVFILE;
 
 
+/* Returns the number of frames an ADPCM block of `bytes' bytes holds. */
+static int adpcm_block_frames(const WAVFILE *wavfile, int bytes)
+{
+   const int channels = wavfile->channels;
+   int frames;
+
+   if (wavfile->format == _AL_ADPCM_IMA) {
+      if (bytes < 4 * channels)
+         return 0;
+      frames = 1 + (bytes - 4 * channels) / (4 * channels) * 8;
+   }
+   else {
+      if (bytes < 7 * channels)
+         return 0;
+      frames = 2 + (bytes - 7 * channels) * 2 / channels;
+   }
+
+   return frames;
+}
+
+
+/* read_adpcm_format:
+ *  Reads the part of an ADPCM fmt chunk following the PCM fields.
+ *  `length' is the number of bytes left in the chunk, and is updated.
+ */
+static bool read_adpcm_format(ALLEGRO_FILE *f, WAVFILE *wavfile, int *length)
+{
+   const int header = (wavfile->format == _AL_ADPCM_IMA ? 4 : 7) *
+      wavfile->channels;
+   int frames;
+   int i;
+
+   if (wavfile->bits != 4 || *length < 4 || wavfile->block_align <= header)
+      return false;
+   if (wavfile->format == _AL_ADPCM_IMA &&
+         (wavfile->block_align - header) % header != 0)
+      return false;
+
+   al_fread16le(f);     /* size of the extra fields */
+   wavfile->samples_per_block = (uint16_t)al_fread16le(f);
+   *length -= 4;
+
+   /* Never trust it to be more than a block can hold. */
+   frames = adpcm_block_frames(wavfile, wavfile->block_align);
+   if (wavfile->samples_per_block <= 0 || wavfile->samples_per_block > frames)
+      wavfile->samples_per_block = frames;
+
+   if (wavfile->format == _AL_ADPCM_MS) {
+      if (*length < 2)
+         return false;
+      wavfile->num_coefs = (uint16_t)al_fread16le(f);
+      *length -= 2;
+      if (wavfile->num_coefs < 1 || wavfile->num_coefs * 4 > *length)
+         return false;
+
+      al_free(wavfile->coefs);
+      wavfile->coefs = al_malloc(wavfile->num_coefs * 2 * sizeof(int16_t));
+      if (!wavfile->coefs)
+         return false;
+      for (i = 0; i < wavfile->num_coefs * 2; i++)
+         wavfile->coefs[i] = al_fread16le(f);
+      *length -= wavfile->num_coefs * 4;
+   }
+
+   return true;
+}
+
+
 /* wav_open:
  *  Opens f and prepares a WAVFILE struct with the WAV format info.
  *  On a successful return, the ALLEGRO_FILE is at the beginning of the sample data.
@@ -49,6 +139,10 @@ static WAVFILE *wav_open(ALLEGRO_FILE *f)
    wavfile->freq = 22050;
    wavfile->bits = 8;
    wavfile->channels = 1;
+   wavfile->format = WAV_FORMAT_PCM;
+   wavfile->coefs = NULL;
+   wavfile->num_coefs = 0;
+   wavfile->fact_samples = -1;
 
    /* check the header */
    if (al_fread(f, buffer, 12) != 12)
@@ -62,7 +156,6 @@ static WAVFILE *wav_open(ALLEGRO_FILE *f)
     */
    while (true) {
       int length = 0;
-      short pcm = 0;
 
       if (al_fread(f, buffer, 4) != 4)
          goto wav_open_error;
@@ -74,9 +167,11 @@ static WAVFILE *wav_open(ALLEGRO_FILE *f)
          if (length < 16)
             goto wav_open_error;
 
-         /* should be 1 for PCM data */
-         pcm = al_fread16le(f);
-         if (pcm != 1)
+         /* 1 for PCM data, or one of the ADPCM formats */
+         wavfile->format = al_fread16le(f);
+         if (wavfile->format != WAV_FORMAT_PCM &&
+               wavfile->format != _AL_ADPCM_IMA &&
+               wavfile->format != _AL_ADPCM_MS)
             goto wav_open_error;
 
          /* mono or stereo data */
@@ -88,22 +183,37 @@ static WAVFILE *wav_open(ALLEGRO_FILE *f)
          /* sample frequency */
          wavfile->freq = al_fread32le(f);
        
-         /* skip six bytes */
-         al_fseek(f, 6, ALLEGRO_SEEK_CUR);   
+         /* skip the byte rate */
+         al_fseek(f, 4, ALLEGRO_SEEK_CUR);
+         wavfile->block_align = al_fread16le(f);
 
          /* 8 or 16 bit data? */
          wavfile->bits = al_fread16le(f);
-         if ((wavfile->bits != 8) && (wavfile->bits != 16))
+         length -= 16;
+         if (wavfile->format != WAV_FORMAT_PCM) {
+            if (!read_adpcm_format(f, wavfile, &length))
+               goto wav_open_error;
+         }
+         else if ((wavfile->bits != 8) && (wavfile->bits != 16))
             goto wav_open_error;
 
          /* Skip remainder of chunk */
-         length -= 16;
          if (length > 0)
             al_fseek(f, length, ALLEGRO_SEEK_CUR);
       }
       else {
          if (!memcmp(buffer, "data", 4))
             break;
+         if (!memcmp(buffer, "fact", 4)) {
+            /* The number of samples in a compressed file. */
+            length = al_fread32le(f);
+            if (length >= 4) {
+               wavfile->fact_samples = al_fread32le(f);
+               length -= 4;
+            }
+            al_fseek(f, length, ALLEGRO_SEEK_CUR);
+            continue;
+         }
          ALLEGRO_INFO("Ignoring chunk: %c%c%c%c\n", buffer[0], buffer[1],
             buffer[2], buffer[3]);
          length = al_fread32le(f);
@@ -111,6 +221,26 @@ static WAVFILE *wav_open(ALLEGRO_FILE *f)
       }
    }
 
+   if (wavfile->format != WAV_FORMAT_PCM) {
+      int blocks, rest, frames;
+
+      wavfile->data_size = al_fread32le(f);
+      if (wavfile->data_size < 0)
+         goto wav_open_error;
+      blocks = wavfile->data_size / wavfile->block_align;
+      rest = wavfile->data_size % wavfile->block_align;
+      frames = adpcm_block_frames(wavfile, rest);
+      if (frames > wavfile->samples_per_block)
+         frames = wavfile->samples_per_block;
+      wavfile->samples = blocks * wavfile->samples_per_block + frames;
+      if (wavfile->fact_samples >= 0 &&
+            wavfile->fact_samples < wavfile->samples)
+         wavfile->samples = wavfile->fact_samples;
+      wavfile->sample_size = 0;
+      wavfile->dpos = al_ftell(f);
+      return wavfile;
+   }
+
    /* find out how many samples exist */
    wavfile->samples = al_fread32le(f);
 
@@ -130,8 +260,10 @@ static WAVFILE *wav_open(ALLEGRO_FILE *f)
 
 wav_open_error:
 
-   if (wavfile)
+   if (wavfile) {
+      al_free(wavfile->coefs);
       al_free(wavfile);
+   }
 
    return NULL;
 }
@@ -183,6 +315,7 @@ static void wav_close(WAVFILE *wavfile)
 {
    ASSERT(wavfile);
 
+   al_free(wavfile->coefs);
    al_free(wavfile);
 }
 
@@ -251,7 +384,8 @@ static size_t wav_stream_update(ALLEGRO_AUDIO_STREAM *stream, void *data,
    btime = ((double)buf_size / (double)bytes_per_sample) / (double)(wavfile->freq);
    
    if (stream->spl.loop == _ALLEGRO_PLAYMODE_STREAM_ONEDIR && ctime + btime > wavfile->loop_end) {
-      samples = ((wavfile->loop_end - ctime) * (double)(wavfile->freq));
+      /* Round, or the last frame before the loop point is lost. */
+      samples = ((wavfile->loop_end - ctime) * (double)(wavfile->freq) + 0.5);
    }
    else {
       samples = buf_size / bytes_per_sample;
@@ -281,6 +415,121 @@ static void wav_stream_close(ALLEGRO_AUDIO_STREAM *stream)
 }
 
 
+#ifdef WAV_MMAP
+
+typedef struct WAV_MAPPING
+{
+   void *base;
+   size_t size;
+} WAV_MAPPING;
+
+
+static void wav_unmap(ALLEGRO_SAMPLE *spl)
+{
+   WAV_MAPPING *mapping = spl->release_data;
+
+   munmap(mapping->base, mapping->size);
+   al_free(mapping);
+}
+
+
+/* wav_load_mapped:
+ *  Maps the WAV file into memory and creates a sample directly over its
+ *  data chunk, which the OS pages in as it is played.  Returns NULL if the
+ *  file cannot be used that way, in which case it should be loaded
+ *  normally.
+ */
+static ALLEGRO_SAMPLE *wav_load_mapped(const char *filename)
+{
+   ALLEGRO_FILE *f;
+   WAVFILE *wavfile;
+   WAV_MAPPING *mapping;
+   ALLEGRO_SAMPLE *spl;
+   struct stat st;
+   size_t dpos, n;
+   int fd;
+
+   f = al_fopen(filename, "rb");
+   if (!f)
+      return NULL;
+   wavfile = wav_open(f);
+   al_fclose(f);
+   if (!wavfile)
+      return NULL;
+   if (wavfile->format != WAV_FORMAT_PCM) {
+      wav_close(wavfile);
+      return NULL;
+   }
+
+   /* The sample values must be aligned in memory. */
+   dpos = wavfile->dpos;
+   n = (wavfile->bits / 8) * wavfile->channels * wavfile->samples;
+   if (dpos % (wavfile->bits / 8) != 0 || n == 0) {
+      wav_close(wavfile);
+      return NULL;
+   }
+
+   fd = open(filename, O_RDONLY);
+   if (fd < 0) {
+      wav_close(wavfile);
+      return NULL;
+   }
+
+   /* A truncated file is padded with silence by the normal loader. */
+   if (fstat(fd, &st) != 0 || (size_t)st.st_size < dpos + n) {
+      close(fd);
+      wav_close(wavfile);
+      return NULL;
+   }
+
+   mapping = al_malloc(sizeof(WAV_MAPPING));
+   if (!mapping) {
+      close(fd);
+      wav_close(wavfile);
+      return NULL;
+   }
+   mapping->size = dpos + n;
+   mapping->base = mmap(NULL, mapping->size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if (mapping->base == MAP_FAILED) {
+      ALLEGRO_WARN("Unable to map %s\n", filename);
+      al_free(mapping);
+      wav_close(wavfile);
+      return NULL;
+   }
+
+   spl = al_create_sample((char *)mapping->base + dpos, wavfile->samples,
+      wavfile->freq, _al_word_size_to_depth_conf(wavfile->bits / 8),
+      _al_count_to_channel_conf(wavfile->channels), false);
+   wav_close(wavfile);
+   if (!spl) {
+      munmap(mapping->base, mapping->size);
+      al_free(mapping);
+      return NULL;
+   }
+
+   spl->release_buf = wav_unmap;
+   spl->release_data = mapping;
+
+   return spl;
+}
+
+
+/* Only files opened through the standard file interface can be mapped. */
+static bool wav_want_mapped(void)
+{
+   const char *p;
+
+   if (al_get_new_file_interface() != &_al_file_interface_stdio)
+      return false;
+
+   p = al_get_config_value(al_get_system_config(), "audio", "mmap_wav");
+   return p && atoi(p) != 0;
+}
+
+#endif /* WAV_MMAP */
+
+
 /* _al_load_wav:
  *  Reads a RIFF WAV format sample ALLEGRO_FILE, returning an ALLEGRO_SAMPLE
  *  structure, or NULL on error.
@@ -291,6 +540,14 @@ ALLEGRO_SAMPLE *_al_load_wav(const char *filename)
    ALLEGRO_SAMPLE *spl;
    ASSERT(filename);
 
+#ifdef WAV_MMAP
+   if (wav_want_mapped()) {
+      spl = wav_load_mapped(filename);
+      if (spl)
+         return spl;
+   }
+#endif
+
    f = al_fopen(filename, "rb");
    if (!f)
       return NULL;
@@ -302,12 +559,47 @@ ALLEGRO_SAMPLE *_al_load_wav(const char *filename)
    return spl;
 }
 
+/* wav_load_adpcm:
+ *  Creates a sample from the blocks of an ADPCM WAV file, which the mixer
+ *  decodes as it plays them.
+ */
+static ALLEGRO_SAMPLE *wav_load_adpcm(WAVFILE *wavfile)
+{
+   ADPCM_DATA *adpcm = al_calloc(1, sizeof(*adpcm));
+
+   if (!adpcm)
+      return NULL;
+
+   adpcm->format = wavfile->format;
+   adpcm->channels = wavfile->channels;
+   adpcm->block_align = wavfile->block_align;
+   adpcm->samples_per_block = wavfile->samples_per_block;
+   adpcm->num_coefs = wavfile->num_coefs;
+   adpcm->coefs = wavfile->coefs;
+   wavfile->coefs = NULL;
+
+   adpcm->data = al_malloc(wavfile->data_size + 1);
+   if (!adpcm->data) {
+      _al_kcm_destroy_adpcm_data(adpcm);
+      return NULL;
+   }
+   /* A truncated file decodes to silence at the end. */
+   adpcm->size = al_fread(wavfile->f, adpcm->data, wavfile->data_size);
+
+   return _al_kcm_create_adpcm_sample(adpcm, wavfile->samples, wavfile->freq);
+}
+
+
 ALLEGRO_SAMPLE *_al_load_wav_f(ALLEGRO_FILE *fp)
 {
    WAVFILE *wavfile = wav_open(fp);
    ALLEGRO_SAMPLE *spl = NULL;
 
-   if (wavfile) {
+   if (wavfile && wavfile->format != WAV_FORMAT_PCM) {
+      spl = wav_load_adpcm(wavfile);
+      wav_close(wavfile);
+   }
+   else if (wavfile) {
       size_t n = (wavfile->bits / 8) * wavfile->channels * wavfile->samples;
       char *data = al_malloc(n);
 
@@ -365,6 +657,12 @@ ALLEGRO_AUDIO_STREAM *_al_load_wav_audio_stream_f(ALLEGRO_FILE* f,
    if (wavfile == NULL)
       return NULL;
 
+   if (wavfile->format != WAV_FORMAT_PCM) {
+      ALLEGRO_ERROR("ADPCM WAV files can only be loaded as samples\n");
+      wav_close(wavfile);
+      return NULL;
+   }
+
    stream = al_create_audio_stream(buffer_count, samples, wavfile->freq,
       _al_word_size_to_depth_conf(wavfile->bits / 8),
       _al_count_to_channel_conf(wavfile->channels));
@@ -380,7 +678,6 @@ ALLEGRO_AUDIO_STREAM *_al_load_wav_audio_stream_f(ALLEGRO_FILE* f,
       stream->get_feeder_position = wav_stream_get_position;
       stream->get_feeder_length = wav_stream_get_length;
       stream->set_feeder_loop = wav_stream_set_loop;
-      _al_acodec_start_feed_thread(stream);
    }
    else {
       wav_close(wavfile);
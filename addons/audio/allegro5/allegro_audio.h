@@ -52,6 +52,7 @@ extern "C" {
 #define ALLEGRO_EVENT_AUDIO_STREAM_FINISHED  (514)
 
 #define ALLEGRO_EVENT_AUDIO_RECORDER_FRAGMENT       (515)
+#define ALLEGRO_EVENT_AUDIO_SAMPLE_LOADED           (516)
 
 /* Type: ALLEGRO_AUDIO_RECORDER_EVENT
  */
@@ -130,7 +131,8 @@ enum ALLEGRO_MIXER_QUALITY
 {
    ALLEGRO_MIXER_QUALITY_POINT   = 0x110,
    ALLEGRO_MIXER_QUALITY_LINEAR  = 0x111,
-   ALLEGRO_MIXER_QUALITY_CUBIC   = 0x112
+   ALLEGRO_MIXER_QUALITY_CUBIC   = 0x112,
+   ALLEGRO_MIXER_QUALITY_SINC    = 0x113
 };
 
 
@@ -147,6 +149,11 @@ typedef struct ALLEGRO_SAMPLE ALLEGRO_SAMPLE;
  */
 typedef struct ALLEGRO_SAMPLE_ID ALLEGRO_SAMPLE_ID;
 
+
+/* Type: ALLEGRO_SAMPLE_BATCH
+ */
+typedef struct ALLEGRO_SAMPLE_BATCH ALLEGRO_SAMPLE_BATCH;
+
 struct ALLEGRO_SAMPLE_ID {
    int _index;
    int _id;
@@ -178,6 +185,26 @@ typedef struct ALLEGRO_VOICE ALLEGRO_VOICE;
 typedef struct ALLEGRO_AUDIO_RECORDER ALLEGRO_AUDIO_RECORDER;
 
 
+#define ALLEGRO_AUDIO_STATS_BUCKETS 20
+
+/* Type: ALLEGRO_AUDIO_STATS
+ */
+typedef struct ALLEGRO_AUDIO_STATS ALLEGRO_AUDIO_STATS;
+
+struct ALLEGRO_AUDIO_STATS {
+   unsigned int passes;
+   double mix_time;
+   double audio_time;
+   double worst_mix_time;
+   unsigned int histogram[ALLEGRO_AUDIO_STATS_BUCKETS];
+   double worst_callback_time;
+   unsigned int underruns;
+   unsigned int overruns;
+   unsigned int queued_fragments;
+   unsigned int fragments;
+};
+
+
 #ifndef __cplusplus
 typedef enum ALLEGRO_AUDIO_DEPTH ALLEGRO_AUDIO_DEPTH;
 typedef enum ALLEGRO_CHANNEL_CONF ALLEGRO_CHANNEL_CONF;
@@ -192,6 +219,9 @@ ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_SAMPLE *, al_create_sample, (void *buf,
       unsigned int samples, unsigned int freq, ALLEGRO_AUDIO_DEPTH depth,
       ALLEGRO_CHANNEL_CONF chan_conf, bool free_buf));
 ALLEGRO_KCM_AUDIO_FUNC(void, al_destroy_sample, (ALLEGRO_SAMPLE *spl));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_sample_cache_size, (size_t bytes));
+ALLEGRO_KCM_AUDIO_FUNC(void, al_get_sample_cache_stats, (unsigned int *hits,
+      unsigned int *misses, size_t *bytes));
 
 
 /* Sample instance functions */
@@ -205,6 +235,7 @@ ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_sample_length, (const ALLEGRO_SAMPLE
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_AUDIO_DEPTH, al_get_sample_depth, (const ALLEGRO_SAMPLE *spl));
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_CHANNEL_CONF, al_get_sample_channels, (const ALLEGRO_SAMPLE *spl));
 ALLEGRO_KCM_AUDIO_FUNC(void *, al_get_sample_data, (const ALLEGRO_SAMPLE *spl));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_is_sample_compressed, (const ALLEGRO_SAMPLE *spl));
 
 ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_sample_instance_frequency, (const ALLEGRO_SAMPLE_INSTANCE *spl));
 ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_sample_instance_length, (const ALLEGRO_SAMPLE_INSTANCE *spl));
@@ -248,6 +279,12 @@ ALLEGRO_KCM_AUDIO_FUNC(void, al_destroy_audio_stream, (ALLEGRO_AUDIO_STREAM *str
 ALLEGRO_KCM_AUDIO_FUNC(void, al_drain_audio_stream, (ALLEGRO_AUDIO_STREAM *stream));
 
 ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_audio_stream_frequency, (const ALLEGRO_AUDIO_STREAM *stream));
+ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_audio_stream_underruns, (const ALLEGRO_AUDIO_STREAM *stream));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_audio_stream_fill_callback, (
+      ALLEGRO_AUDIO_STREAM *stream,
+      unsigned int (*cb)(ALLEGRO_AUDIO_STREAM *stream, void *buf,
+         unsigned int samples, void *data),
+      void *data));
 ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_audio_stream_length, (const ALLEGRO_AUDIO_STREAM *stream));
 ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_audio_stream_fragments, (const ALLEGRO_AUDIO_STREAM *stream));
 ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_available_audio_stream_fragments, (const ALLEGRO_AUDIO_STREAM *stream));
@@ -283,6 +320,8 @@ ALLEGRO_KCM_AUDIO_FUNC(double, al_get_audio_stream_length_secs, (ALLEGRO_AUDIO_S
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_audio_stream_loop_secs, (ALLEGRO_AUDIO_STREAM *stream, double start, double end));
 
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_EVENT_SOURCE *, al_get_audio_stream_event_source, (ALLEGRO_AUDIO_STREAM *stream));
+ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_AUDIO_STREAM *, al_create_audio_stream_from_sample, (
+      ALLEGRO_SAMPLE *spl, size_t buffer_count, unsigned int samples));
 
 /* Mixer functions */
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_MIXER*, al_create_mixer, (unsigned int freq,
@@ -306,11 +345,23 @@ ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_MIXER_QUALITY, al_get_mixer_quality, (const ALLEG
 ALLEGRO_KCM_AUDIO_FUNC(float, al_get_mixer_gain, (const ALLEGRO_MIXER *mixer));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_get_mixer_playing, (const ALLEGRO_MIXER *mixer));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_get_mixer_attached, (const ALLEGRO_MIXER *mixer));
+ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_mixer_real_voices, (const ALLEGRO_MIXER *mixer));
+ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_mixer_virtual_voices, (const ALLEGRO_MIXER *mixer));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_get_mixer_preconvert_samples, (const ALLEGRO_MIXER *mixer));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_get_mixer_planar, (const ALLEGRO_MIXER *mixer));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_mixer_frequency, (ALLEGRO_MIXER *mixer, unsigned int val));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_mixer_quality, (ALLEGRO_MIXER *mixer, ALLEGRO_MIXER_QUALITY val));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_mixer_gain, (ALLEGRO_MIXER *mixer, float gain));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_mixer_playing, (ALLEGRO_MIXER *mixer, bool val));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_mixer_preconvert_samples, (ALLEGRO_MIXER *mixer, bool val));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_mixer_planar, (ALLEGRO_MIXER *mixer, bool val));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_mixer_planar_postprocess_callback, (
+      ALLEGRO_MIXER *mixer,
+      void (*cb)(void **planes, unsigned int samples, void *data),
+      void *data));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_detach_mixer, (ALLEGRO_MIXER *mixer));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_render_mixer, (ALLEGRO_MIXER *mixer,
+      void *buf, unsigned int samples, ALLEGRO_AUDIO_DEPTH depth));
 
 /* Voice functions */
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_VOICE*, al_create_voice, (unsigned int freq,
@@ -352,6 +403,10 @@ ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_default_mixer, (ALLEGRO_MIXER *mixer));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_restore_default_mixer, (void));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_play_sample, (ALLEGRO_SAMPLE *data,
       float gain, float pan, float speed, ALLEGRO_PLAYMODE loop, ALLEGRO_SAMPLE_ID *ret_id));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_play_sample_with_priority, (ALLEGRO_SAMPLE *data,
+      float gain, float pan, float speed, ALLEGRO_PLAYMODE loop, int priority,
+      ALLEGRO_SAMPLE_ID *ret_id));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_get_sample_id_stolen, (const ALLEGRO_SAMPLE_ID *spl_id));
 ALLEGRO_KCM_AUDIO_FUNC(void, al_stop_sample, (ALLEGRO_SAMPLE_ID *spl_id));
 ALLEGRO_KCM_AUDIO_FUNC(void, al_stop_samples, (void));
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_VOICE *, al_get_default_voice, (void));
@@ -375,17 +430,40 @@ ALLEGRO_KCM_AUDIO_FUNC(bool, al_register_audio_stream_loader_f, (const char *ext
 	    size_t buffer_count, unsigned int samples)));
 
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_SAMPLE *, al_load_sample, (const char *filename));
+ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_SAMPLE_BATCH *, al_load_samples_async, (
+      const char * const *filenames, int count, int threads));
+ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_EVENT_SOURCE *, al_get_sample_batch_event_source, (
+      ALLEGRO_SAMPLE_BATCH *batch));
+ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_SAMPLE *, al_get_sample_batch_sample, (
+      ALLEGRO_SAMPLE_BATCH *batch, int index));
+ALLEGRO_KCM_AUDIO_FUNC(void, al_cancel_sample_batch, (ALLEGRO_SAMPLE_BATCH *batch));
+ALLEGRO_KCM_AUDIO_FUNC(void, al_wait_for_sample_batch, (ALLEGRO_SAMPLE_BATCH *batch));
+ALLEGRO_KCM_AUDIO_FUNC(void, al_destroy_sample_batch, (ALLEGRO_SAMPLE_BATCH *batch));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_save_sample, (const char *filename,
 	ALLEGRO_SAMPLE *spl));
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_AUDIO_STREAM *, al_load_audio_stream, (const char *filename,
 	size_t buffer_count, unsigned int samples));
    
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_SAMPLE *, al_load_sample_f, (ALLEGRO_FILE* fp, const char *ident));
+ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_SAMPLE *, al_load_sample_compressed, (const char *filename));
+ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_SAMPLE *, al_load_sample_compressed_f, (ALLEGRO_FILE* fp,
+	const char *ident));
 ALLEGRO_KCM_AUDIO_FUNC(bool, al_save_sample_f, (ALLEGRO_FILE* fp, const char *ident,
 	ALLEGRO_SAMPLE *spl));
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_AUDIO_STREAM *, al_load_audio_stream_f, (ALLEGRO_FILE* fp, const char *ident,
 	size_t buffer_count, unsigned int samples));
 
+/* Statistics functions */
+ALLEGRO_KCM_AUDIO_FUNC(void, al_get_voice_stats, (ALLEGRO_VOICE *voice,
+   ALLEGRO_AUDIO_STATS *stats));
+ALLEGRO_KCM_AUDIO_FUNC(void, al_reset_voice_stats, (ALLEGRO_VOICE *voice));
+ALLEGRO_KCM_AUDIO_FUNC(void, al_get_mixer_stats, (ALLEGRO_MIXER *mixer,
+   ALLEGRO_AUDIO_STATS *stats));
+ALLEGRO_KCM_AUDIO_FUNC(void, al_reset_mixer_stats, (ALLEGRO_MIXER *mixer));
+ALLEGRO_KCM_AUDIO_FUNC(void, al_get_audio_stream_stats, (ALLEGRO_AUDIO_STREAM *stream,
+   ALLEGRO_AUDIO_STATS *stats));
+ALLEGRO_KCM_AUDIO_FUNC(void, al_reset_audio_stream_stats, (ALLEGRO_AUDIO_STREAM *stream));
+
 /* Recording functions */
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_AUDIO_RECORDER *, al_create_audio_recorder, (size_t fragment_count,
    unsigned int samples, unsigned int freq, ALLEGRO_AUDIO_DEPTH depth, ALLEGRO_CHANNEL_CONF chan_conf));
@@ -396,6 +474,15 @@ ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_EVENT_SOURCE *, al_get_audio_recorder_event_sourc
    (ALLEGRO_AUDIO_RECORDER *r));
 ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_AUDIO_RECORDER_EVENT *, al_get_audio_recorder_event, (ALLEGRO_EVENT *event));
 ALLEGRO_KCM_AUDIO_FUNC(void, al_destroy_audio_recorder, (ALLEGRO_AUDIO_RECORDER *r));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_audio_recorder_callback, (ALLEGRO_AUDIO_RECORDER *r,
+   void (*callback)(void *buf, unsigned int samples, void *data), void *data));
+ALLEGRO_KCM_AUDIO_FUNC(bool, al_set_audio_recorder_ring_size, (ALLEGRO_AUDIO_RECORDER *r,
+   unsigned int samples));
+ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_audio_recorder_ring_size, (ALLEGRO_AUDIO_RECORDER *r));
+ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_read_audio_recorder, (ALLEGRO_AUDIO_RECORDER *r,
+   void *buf, unsigned int samples));
+ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_available_audio_recorder_samples, (ALLEGRO_AUDIO_RECORDER *r));
+ALLEGRO_KCM_AUDIO_FUNC(unsigned int, al_get_dropped_audio_recorder_samples, (ALLEGRO_AUDIO_RECORDER *r));
    
 #ifdef __cplusplus
 } /* End extern "C" */
@@ -6,6 +6,7 @@
 #define AINTERN_AUDIO_H
 
 #include "allegro5/allegro.h"
+#include "allegro5/internal/aintern_atomicops.h"
 #include "allegro5/internal/aintern_vector.h"
 #include "../allegro_audio.h"
 
@@ -20,7 +21,8 @@ typedef enum ALLEGRO_AUDIO_DRIVER_ENUM
    ALLEGRO_AUDIO_DRIVER_AQUEUE     = 0x20005,
    ALLEGRO_AUDIO_DRIVER_PULSEAUDIO = 0x20006,
    ALLEGRO_AUDIO_DRIVER_OPENSL     = 0x20007,
-   ALLEGRO_AUDIO_DRIVER_SDL        = 0x20008
+   ALLEGRO_AUDIO_DRIVER_SDL        = 0x20008,
+   ALLEGRO_AUDIO_DRIVER_NULL       = 0x20009
 } ALLEGRO_AUDIO_DRIVER_ENUM;
 
 typedef struct ALLEGRO_AUDIO_DRIVER ALLEGRO_AUDIO_DRIVER;
@@ -87,6 +89,11 @@ struct ALLEGRO_VOICE {
 
    void                 *extra;
                         /* Extra data for use by the driver. */
+
+   ALLEGRO_AUDIO_STATS  stats;
+                        /* Timing of _al_voice_update, protected by the
+                         * voice mutex.
+                         */
 };
 
 
@@ -101,6 +108,32 @@ typedef union {
    void     *ptr;
 } any_buffer_t;
 
+typedef struct SAMPLE_CACHE_ENTRY SAMPLE_CACHE_ENTRY;
+typedef struct COMPRESSED_SAMPLE_DATA COMPRESSED_SAMPLE_DATA;
+
+/* The ADPCM formats found in WAV files, by their format tag. */
+typedef enum _AL_ADPCM_FORMAT {
+   _AL_ADPCM_MS  = 0x0002,
+   _AL_ADPCM_IMA = 0x0011
+} _AL_ADPCM_FORMAT;
+
+/* Sample data kept ADPCM compressed, decoded a block at a time by the mixers
+ * playing it (see kcm_adpcm.c).
+ */
+typedef struct ADPCM_DATA {
+   _AL_ADPCM_FORMAT     format;
+   int                  channels;
+   int                  block_align;
+                        /* The size of each block in bytes. */
+   int                  samples_per_block;
+                        /* The number of frames in each whole block. */
+   int                  num_coefs;
+   int16_t              *coefs;
+                        /* The MS ADPCM predictor coefficient pairs. */
+   unsigned char        *data;
+   size_t               size;
+} ADPCM_DATA;
+
 struct ALLEGRO_SAMPLE {
    ALLEGRO_AUDIO_DEPTH  depth;
    ALLEGRO_CHANNEL_CONF chan_conf;
@@ -111,8 +144,40 @@ struct ALLEGRO_SAMPLE {
                         /* Whether `buffer' needs to be freed when the sample
                          * is destroyed, or when `buffer' changes.
                          */
+   SAMPLE_CACHE_ENTRY   *cache_entry;
+                        /* The sample cache entry owning `buffer', if the
+                         * sample was loaded through the cache.
+                         */
+   void                 (*release_buf)(ALLEGRO_SAMPLE *spl);
+   void                 *release_data;
+                        /* Called when the sample is destroyed to release a
+                         * `buffer' that was not allocated with al_malloc,
+                         * e.g. a mapped file.  Only used if `free_buf' is
+                         * false.
+                         */
+   COMPRESSED_SAMPLE_DATA *compressed;
+                        /* The encoded file of a sample loaded by
+                         * al_load_sample_compressed, in which case `buffer'
+                         * is NULL and each instance playing the sample
+                         * decodes it through a stream of its own.
+                         */
+   ADPCM_DATA           *adpcm;
+                        /* The blocks of a sample kept ADPCM compressed, in
+                         * which case `buffer' is NULL and the mixer decodes
+                         * them as it plays.
+                         */
 };
 
+ALLEGRO_SAMPLE *_al_kcm_load_cached_sample(const char *filename,
+   ALLEGRO_SAMPLE *(*loader)(const char *filename));
+void _al_kcm_release_cached_sample(SAMPLE_CACHE_ENTRY *entry);
+void _al_kcm_shutdown_sample_cache(void);
+void _al_kcm_stop_sample_instances(void *buffer);
+const ALLEGRO_SAMPLE *_al_kcm_get_converted_sample(const ALLEGRO_SAMPLE *src,
+   ALLEGRO_AUDIO_DEPTH depth);
+void _al_kcm_forget_converted_samples(const void *buffer);
+void _al_kcm_shutdown_converted_samples(void);
+
 /* Read some samples into a mixer buffer.
  *
  * source:
@@ -144,6 +209,21 @@ typedef struct {
    bool                 is_voice;
 } sample_parent_t;
 
+/* Length of the filter used by ALLEGRO_MIXER_QUALITY_SINC.  Audio streams
+ * keep this many sample values, less one, from the previous fragment.
+ */
+#define _AL_KCM_SINC_TAPS     16
+
+/* The two blocks of ADPCM sample data an instance decoded last.  Reading
+ * across a block boundary or a loop point needs both.
+ */
+typedef struct ADPCM_CACHE {
+   int                  block[2];
+   int                  last;
+   int                  channels;
+   int16_t              *pcm[2];
+} ADPCM_CACHE;
+
 /* The sample struct also serves the base of ALLEGRO_AUDIO_STREAM, ALLEGRO_MIXER. */
 struct ALLEGRO_SAMPLE_INSTANCE {
    /* ALLEGRO_SAMPLE_INSTANCE does not generate any events yet but ALLEGRO_AUDIO_STREAM
@@ -152,6 +232,25 @@ struct ALLEGRO_SAMPLE_INSTANCE {
 
    ALLEGRO_SAMPLE       spl_data;
 
+   const ALLEGRO_SAMPLE *converted;
+                        /* A copy of spl_data converted to the depth of the
+                         * mixer it is attached to, which the mixer reads
+                         * instead, or NULL.
+                         * See al_set_mixer_preconvert_samples.
+                         */
+
+   ADPCM_CACHE          *adpcm_cache;
+                        /* The blocks decoded last, if spl_data is ADPCM
+                         * compressed.
+                         */
+
+   ALLEGRO_AUDIO_STREAM *decoder;
+                        /* The stream decoding spl_data, if it was loaded by
+                         * al_load_sample_compressed.  It is attached to the
+                         * same mixer and plays in place of the instance,
+                         * which only forwards to it.
+                         */
+
    volatile bool        is_playing;
                         /* Is this sample is playing? */
 
@@ -178,7 +277,27 @@ struct ALLEGRO_SAMPLE_INSTANCE {
    float                *matrix;
                         /* Used to convert from this format to the attached
                          * mixers, if any.  Otherwise is NULL.
-                         * The gain is premultiplied in.
+                         * The gain is premultiplied in.  The allocation holds
+                         * a second matrix after the first, which is the one
+                         * being ramped away from when parameter ramps are on.
+                         */
+
+   bool                 is_inaudible;
+   bool                 is_virtual;
+                        /* Whether no coefficient of the matrix is above the
+                         * mixer's virtual voice threshold, and whether the
+                         * last read only advanced the position because of it.
+                         */
+
+   volatile _AL_ATOMIC  param_serial;
+   _AL_ATOMIC           applied_serial;
+   float                applied_speed;
+                        /* The gain, pan and speed setters store the new value
+                         * and increment param_serial without taking the mutex.
+                         * The mixer compares it with applied_serial at the
+                         * start of each read and picks up the new values.
+                         * The step is only recomputed when the speed differs
+                         * from the one it was last computed from.
                          */
 
    bool                 is_mixer;
@@ -196,6 +315,17 @@ struct ALLEGRO_SAMPLE_INSTANCE {
    sample_parent_t      parent;
                         /* The object that this sample is attached to, if any.
                          */
+
+   void                 (*stop_callback)(ALLEGRO_SAMPLE_INSTANCE *spl,
+                           void *data);
+   void                 *stop_callback_data;
+                        /* Called with the mutex held when the instance stops:
+                         * by the mixer when a ALLEGRO_PLAYMODE_ONCE instance
+                         * plays to the end or a draining stream runs out,
+                         * and by al_set_sample_instance_playing when one
+                         * attached to a mixer is stopped.  Used to recycle
+                         * the instances of al_play_sample.
+                         */
 };
 
 void _al_kcm_destroy_sample(ALLEGRO_SAMPLE_INSTANCE *sample, bool unregister);
@@ -204,6 +334,8 @@ void _al_kcm_detach_from_parent(ALLEGRO_SAMPLE_INSTANCE *spl);
 
 
 typedef size_t (*stream_callback_t)(ALLEGRO_AUDIO_STREAM *, void *, size_t);
+typedef unsigned int (*fill_callback_t)(ALLEGRO_AUDIO_STREAM *stream,
+   void *buf, unsigned int samples, void *userdata);
 typedef void (*unload_feeder_t)(ALLEGRO_AUDIO_STREAM *);
 typedef bool (*rewind_feeder_t)(ALLEGRO_AUDIO_STREAM *);
 typedef bool (*seek_feeder_t)(ALLEGRO_AUDIO_STREAM *, double);
@@ -272,15 +404,46 @@ struct ALLEGRO_AUDIO_STREAM {
                           * streams don't need to be fed by the user.
                           */
 
+   bool                  data_in_memory;
+                         /* Set for the streams of compressed samples, which
+                          * the addons then do not index for seeking.
+                          */
+
+   bool                  fed_by_pool;
+   bool                  feed_requested;
+   bool                  feeding;
+                         /* Whether the stream is fed by the shared feeder
+                          * pool rather than its own thread, whether the
+                          * mixer has asked for a refill, and whether a
+                          * worker is filling it.  The last two are
+                          * protected by the pool mutex.
+                          */
+
+   fill_callback_t       fill_callback;
+   void                  *fill_callback_userdata;
+                         /* Set by al_set_audio_stream_fill_callback.  Called
+                          * by _al_kcm_refill_stream, from the audio thread,
+                          * when the stream has no more fragments pending.
+                          */
+
+   ALLEGRO_AUDIO_STATS   stats;
+                         /* Timing of the mixer reading the stream and of
+                          * the fill callback, protected by the stream mutex.
+                          * The fragment counts are filled in when read.
+                          */
+
    void                  *extra;
                          /* Extra data for use by the flac/vorbis addons. */
 };
 
 bool _al_kcm_refill_stream(ALLEGRO_AUDIO_STREAM *stream);
+void _al_kcm_shutdown_stream_feeders(void);
 
 
 typedef void (*postprocess_callback_t)(void *buf, unsigned int samples,
    void *userdata);
+typedef void (*planar_postprocess_callback_t)(void **planes,
+   unsigned int samples, void *userdata);
 
 /* ALLEGRO_MIXER is derived from ALLEGRO_SAMPLE_INSTANCE. Certain internal functions and
  * pointers may take either object type, and such things are explicitly noted.
@@ -301,12 +464,76 @@ struct ALLEGRO_MIXER {
                            /* Vector of ALLEGRO_SAMPLE_INSTANCE*.  Holds the list of
                             * streams being mixed together.
                             */
+
+   bool                    ramp_params;
+                           /* Whether gain and pan changes of the attached
+                            * instances are ramped over the next read.
+                            */
+
+   bool                    dither;
+   uint32_t                dither_seed;
+                           /* Whether to add TPDF dither when converting to an
+                            * integer voice depth, and the noise generator state.
+                            */
+
+   bool                    preconvert;
+                           /* Whether sample instances attached to the mixer
+                            * read a copy of their data converted to its depth.
+                            */
+
+   bool                    planar;
+   void                    *interleave_buf;
+                           /* Whether the mixer buffer holds one plane of
+                            * sample values per channel rather than frames.
+                            * A planar mixer interleaves into interleave_buf,
+                            * and swaps it with the mixer buffer, when it
+                            * hands its output to a voice.
+                            */
+
+   planar_postprocess_callback_t planar_postprocess_callback;
+   void                    *planar_pp_callback_userdata;
+                           /* Called in place of postprocess_callback by a
+                            * planar mixer.  Only one of the two can be set,
+                            * the one matching the layout of the buffer.
+                            */
+
+   float                   virtual_threshold;
+                           /* Attached instances whose matrix coefficients are
+                            * all at most this loud are not mixed, only moved
+                            * along.  Negative to mix everything.
+                            */
+
+   unsigned int            real_voices;
+   unsigned int            virtual_voices;
+                           /* How many of the attached instances were mixed,
+                            * and how many were skipped, by the last read.
+                            */
+
+   ALLEGRO_AUDIO_STATS     stats;
+                           /* Timing of _al_kcm_mixer_read and of the
+                            * post-processing callback, protected by the
+                            * mixer mutex.
+                            */
+
+   ALLEGRO_MUTEX           *render_mutex;
+   ALLEGRO_COND            *render_cond;
+                           /* Created by al_render_mixer() and used in place of
+                            * a voice mutex while the mixer is not attached.
+                            * Feeders signal the condition when they hand back
+                            * a fragment.
+                            */
 };
 
 extern void _al_kcm_mixer_rejig_sample_matrix(ALLEGRO_MIXER *mixer,
    ALLEGRO_SAMPLE_INSTANCE *spl);
+extern void _al_kcm_mixer_set_step(ALLEGRO_MIXER *mixer,
+   ALLEGRO_SAMPLE_INSTANCE *spl);
+extern void _al_kcm_wake_renderer(ALLEGRO_SAMPLE_INSTANCE *spl);
 extern void _al_kcm_mixer_read(void *source, void **buf, unsigned int *samples,
    ALLEGRO_AUDIO_DEPTH buffer_depth, size_t dest_maxc);
+extern const ALLEGRO_SAMPLE *_al_kcm_mixer_convert_sample(
+   ALLEGRO_MIXER *mixer, ALLEGRO_SAMPLE_INSTANCE *spl);
+extern void _al_kcm_shutdown_mixer_pool(void);
 
 
 typedef enum {
@@ -320,10 +547,15 @@ extern void _al_set_error(int error, char* string);
 
 /* Supposedly internal */
 ALLEGRO_KCM_AUDIO_FUNC(void*, _al_kcm_feed_stream, (ALLEGRO_THREAD *self, void *vstream));
+ALLEGRO_KCM_AUDIO_FUNC(void, _al_kcm_start_stream_feeder, (ALLEGRO_AUDIO_STREAM *stream));
+ALLEGRO_KCM_AUDIO_FUNC(void, _al_kcm_stop_stream_feeder, (ALLEGRO_AUDIO_STREAM *stream));
 
 /* Helper to emit an event that the stream has got a buffer ready to be refilled. */
 void _al_kcm_emit_stream_events(ALLEGRO_AUDIO_STREAM *stream);
 
+ALLEGRO_AUDIO_STREAM *_al_kcm_open_audio_stream_f(ALLEGRO_FILE *fp,
+   const char *ident, size_t buffer_count, unsigned int samples);
+
 void _al_kcm_init_destructors(void);
 void _al_kcm_shutdown_destructors(void);
 void _al_kcm_register_destructor(void *object, void (*func)(void*));
@@ -339,6 +571,31 @@ ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_AUDIO_DEPTH, _al_word_size_to_depth_conf, (int wo
 
 ALLEGRO_KCM_AUDIO_FUNC(void, _al_emit_audio_event, (int event_type));
 
+ALLEGRO_KCM_AUDIO_FUNC(ALLEGRO_SAMPLE *, _al_kcm_create_adpcm_sample,
+   (ADPCM_DATA *adpcm, unsigned int samples, unsigned int freq));
+ALLEGRO_KCM_AUDIO_FUNC(void, _al_kcm_destroy_adpcm_data, (ADPCM_DATA *adpcm));
+int _al_kcm_decode_adpcm_block(const ADPCM_DATA *adpcm, int block,
+   int16_t *out);
+const int16_t *_al_kcm_decode_adpcm_frame(ALLEGRO_SAMPLE_INSTANCE *spl,
+   int pos);
+bool _al_kcm_prepare_adpcm_cache(ALLEGRO_SAMPLE_INSTANCE *spl,
+   const ALLEGRO_SAMPLE *data);
+
+bool _al_kcm_set_sample_decoder(ALLEGRO_SAMPLE_INSTANCE *spl,
+   const ALLEGRO_SAMPLE *data);
+bool _al_kcm_set_decoder_playing(ALLEGRO_SAMPLE_INSTANCE *spl, bool val);
+bool _al_kcm_set_decoder_playmode(ALLEGRO_SAMPLE_INSTANCE *spl,
+   ALLEGRO_PLAYMODE val);
+unsigned int _al_kcm_get_decoder_position(
+   const ALLEGRO_SAMPLE_INSTANCE *spl);
+bool _al_kcm_set_decoder_position(ALLEGRO_SAMPLE_INSTANCE *spl,
+   unsigned int val);
+
+
+void _al_kcm_add_mix_time(ALLEGRO_AUDIO_STATS *stats, double start,
+   double end, double audio_time);
+void _al_kcm_add_callback_time(ALLEGRO_AUDIO_STATS *stats, double time);
+
 
 /*
  * Recording
@@ -378,8 +635,29 @@ struct ALLEGRO_AUDIO_RECORDER {
                               
   void                     *extra;
                            /* custom data for the driver to use as needed */
+
+  void (*callback)(void *buf, unsigned int samples, void *data);
+  void                     *callback_data;
+                           /* if set, fragments are passed to the callback
+                              instead of being sent as events */
+
+  char                     *ring;
+  unsigned int             ring_size;
+                           /* ring of ring_size samples (a power of two),
+                              or NULL */
+
+  volatile _AL_ATOMIC      ring_write;
+  volatile _AL_ATOMIC      ring_read;
+  volatile _AL_ATOMIC      ring_dropped;
+                           /* samples written to and read from the ring,
+                              and samples dropped because it was full;
+                              only the driver thread writes ring_write and
+                              ring_dropped, only the reader ring_read */
 };
 
+void _al_kcm_emit_recorder_fragment(ALLEGRO_AUDIO_RECORDER *r,
+   void *buffer, unsigned int samples);
+
 
 #endif
 
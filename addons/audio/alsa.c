@@ -708,7 +708,6 @@ static void *alsa_update_recorder(ALLEGRO_THREAD *t, void *thread_data)
 {
    ALLEGRO_AUDIO_RECORDER *r = thread_data;
    ALSA_RECORDER_DATA *alsa = r->extra;
-   ALLEGRO_EVENT user_event;
    uint8_t *null_buffer;
    unsigned int fragment_i = 0;
    
@@ -731,15 +730,12 @@ static void *alsa_update_recorder(ALLEGRO_THREAD *t, void *thread_data)
          snd_pcm_readi(alsa->capture_handle, null_buffer, 1024);
       }
       else {
-         ALLEGRO_AUDIO_RECORDER_EVENT *e;
          snd_pcm_sframes_t count;
          al_unlock_mutex(r->mutex);
          if ((count = snd_pcm_readi(alsa->capture_handle, r->fragments[fragment_i], r->samples)) > 0) {
-            user_event.user.type = ALLEGRO_EVENT_AUDIO_RECORDER_FRAGMENT;
-            e = al_get_audio_recorder_event(&user_event);
-            e->buffer = r->fragments[fragment_i];
-            e->samples = count;
-            al_emit_user_event(&r->source, &user_event, NULL);
+            al_lock_mutex(r->mutex);
+            _al_kcm_emit_recorder_fragment(r, r->fragments[fragment_i], count);
+            al_unlock_mutex(r->mutex);
          
             if (++fragment_i == r->fragment_count) {
                fragment_i = 0;
@@ -261,7 +261,7 @@ ALLEGRO_SAMPLE *al_load_sample(const char *filename)
 
    ent = find_acodec_table_entry(ext);
    if (ent && ent->loader) {
-      return (ent->loader)(filename);
+      return _al_kcm_load_cached_sample(filename, ent->loader);
    }
 
    return NULL;
@@ -286,6 +286,18 @@ ALLEGRO_SAMPLE *al_load_sample_f(ALLEGRO_FILE* fp, const char *ident)
 }
 
 
+/* The acodec loaders give their streams a feeder but leave starting it to
+ * us, so that _al_kcm_open_audio_stream_f can do without.  Streams from
+ * user loaders are fed by the user.
+ */
+static ALLEGRO_AUDIO_STREAM *start_feeding(ALLEGRO_AUDIO_STREAM *stream)
+{
+   if (stream && stream->feeder)
+      _al_kcm_start_stream_feeder(stream);
+   return stream;
+}
+
+
 /* Function: al_load_audio_stream
  */
 ALLEGRO_AUDIO_STREAM *al_load_audio_stream(const char *filename,
@@ -301,7 +313,8 @@ ALLEGRO_AUDIO_STREAM *al_load_audio_stream(const char *filename,
 
    ent = find_acodec_table_entry(ext);
    if (ent && ent->stream_loader) {
-      return (ent->stream_loader)(filename, buffer_count, samples);
+      return start_feeding(
+         (ent->stream_loader)(filename, buffer_count, samples));
    }
 
    ALLEGRO_ERROR("Error creating ALLEGRO_AUDIO_STREAM from '%s'.\n", filename);
@@ -310,10 +323,11 @@ ALLEGRO_AUDIO_STREAM *al_load_audio_stream(const char *filename,
 }
 
 
-/* Function: al_load_audio_stream_f
+/* _al_kcm_open_audio_stream_f:
+ *  Like al_load_audio_stream_f, but without feeding the stream.
  */
-ALLEGRO_AUDIO_STREAM *al_load_audio_stream_f(ALLEGRO_FILE* fp, const char *ident,
-   size_t buffer_count, unsigned int samples)
+ALLEGRO_AUDIO_STREAM *_al_kcm_open_audio_stream_f(ALLEGRO_FILE *fp,
+   const char *ident, size_t buffer_count, unsigned int samples)
 {
    ACODEC_TABLE *ent;
 
@@ -329,6 +343,16 @@ ALLEGRO_AUDIO_STREAM *al_load_audio_stream_f(ALLEGRO_FILE* fp, const char *ident
 }
 
 
+/* Function: al_load_audio_stream_f
+ */
+ALLEGRO_AUDIO_STREAM *al_load_audio_stream_f(ALLEGRO_FILE* fp, const char *ident,
+   size_t buffer_count, unsigned int samples)
+{
+   return start_feeding(
+      _al_kcm_open_audio_stream_f(fp, ident, buffer_count, samples));
+}
+
+
 /* Function: al_save_sample
  */
 bool al_save_sample(const char *filename, ALLEGRO_SAMPLE *spl)
@@ -337,6 +361,11 @@ bool al_save_sample(const char *filename, ALLEGRO_SAMPLE *spl)
    ACODEC_TABLE *ent;
 
    ASSERT(filename);
+
+   if (spl->compressed || spl->adpcm) {
+      _al_set_error(ALLEGRO_INVALID_PARAM, "Cannot save a compressed sample");
+      return false;
+   }
    ext = strrchr(filename, '.');
    if (ext == NULL)
       return false;
@@ -358,6 +387,11 @@ bool al_save_sample_f(ALLEGRO_FILE *fp, const char *ident, ALLEGRO_SAMPLE *spl)
 
    ASSERT(fp);
    ASSERT(ident);
+
+   if (spl->compressed || spl->adpcm) {
+      _al_set_error(ALLEGRO_INVALID_PARAM, "Cannot save a compressed sample");
+      return false;
+   }
    
    ent = find_acodec_table_entry(ident);
    if (ent && ent->fs_saver) {
@@ -0,0 +1,151 @@
+/*
+ * Timing statistics for voices, mixers and audio streams, for sizing
+ * buffers and catching passes that take too long before they are heard.
+ */
+
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_audio.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_audio.h"
+
+
+static void maybe_lock_mutex(ALLEGRO_MUTEX *mutex)
+{
+   if (mutex) {
+      al_lock_mutex(mutex);
+   }
+}
+
+
+static void maybe_unlock_mutex(ALLEGRO_MUTEX *mutex)
+{
+   if (mutex) {
+      al_unlock_mutex(mutex);
+   }
+}
+
+
+/* _al_kcm_add_mix_time:
+ *  Records one pass which ran from `start' to `end' (as returned by
+ *  al_get_time) and produced `audio_time' seconds of audio.  A pass taking
+ *  longer than the audio it produced is counted as an overrun.
+ */
+void _al_kcm_add_mix_time(ALLEGRO_AUDIO_STATS *stats, double start,
+   double end, double audio_time)
+{
+   const double time = end - start;
+   double limit = 1e-6;
+   int bucket = 0;
+
+   /* Bucket 0 holds passes under a microsecond, and each bucket after it
+    * twice as long again, the last holding everything longer.
+    */
+   while (bucket < ALLEGRO_AUDIO_STATS_BUCKETS - 1 && time >= limit) {
+      limit *= 2.0;
+      bucket++;
+   }
+
+   stats->passes++;
+   stats->mix_time += time;
+   stats->audio_time += audio_time;
+   stats->histogram[bucket]++;
+   if (time > stats->worst_mix_time)
+      stats->worst_mix_time = time;
+   if (time > audio_time)
+      stats->overruns++;
+}
+
+
+/* _al_kcm_add_callback_time:
+ *  Records the time a user callback took.
+ */
+void _al_kcm_add_callback_time(ALLEGRO_AUDIO_STATS *stats, double time)
+{
+   if (time > stats->worst_callback_time)
+      stats->worst_callback_time = time;
+}
+
+
+/* Function: al_get_voice_stats
+ */
+void al_get_voice_stats(ALLEGRO_VOICE *voice, ALLEGRO_AUDIO_STATS *stats)
+{
+   ASSERT(voice);
+   ASSERT(stats);
+
+   al_lock_mutex(voice->mutex);
+   *stats = voice->stats;
+   al_unlock_mutex(voice->mutex);
+}
+
+
+/* Function: al_reset_voice_stats
+ */
+void al_reset_voice_stats(ALLEGRO_VOICE *voice)
+{
+   ASSERT(voice);
+
+   al_lock_mutex(voice->mutex);
+   memset(&voice->stats, 0, sizeof(voice->stats));
+   al_unlock_mutex(voice->mutex);
+}
+
+
+/* Function: al_get_mixer_stats
+ */
+void al_get_mixer_stats(ALLEGRO_MIXER *mixer, ALLEGRO_AUDIO_STATS *stats)
+{
+   ASSERT(mixer);
+   ASSERT(stats);
+
+   maybe_lock_mutex(mixer->ss.mutex);
+   *stats = mixer->stats;
+   maybe_unlock_mutex(mixer->ss.mutex);
+}
+
+
+/* Function: al_reset_mixer_stats
+ */
+void al_reset_mixer_stats(ALLEGRO_MIXER *mixer)
+{
+   ASSERT(mixer);
+
+   maybe_lock_mutex(mixer->ss.mutex);
+   memset(&mixer->stats, 0, sizeof(mixer->stats));
+   maybe_unlock_mutex(mixer->ss.mutex);
+}
+
+
+/* Function: al_get_audio_stream_stats
+ */
+void al_get_audio_stream_stats(ALLEGRO_AUDIO_STREAM *stream,
+   ALLEGRO_AUDIO_STATS *stats)
+{
+   unsigned int i;
+
+   ASSERT(stream);
+   ASSERT(stats);
+
+   maybe_lock_mutex(stream->spl.mutex);
+   *stats = stream->stats;
+   for (i = 0; i < stream->buf_count && stream->pending_bufs[i]; i++)
+      ;
+   stats->queued_fragments = i;
+   stats->fragments = stream->buf_count;
+   maybe_unlock_mutex(stream->spl.mutex);
+}
+
+
+/* Function: al_reset_audio_stream_stats
+ */
+void al_reset_audio_stream_stats(ALLEGRO_AUDIO_STREAM *stream)
+{
+   ASSERT(stream);
+
+   maybe_lock_mutex(stream->spl.mutex);
+   memset(&stream->stats, 0, sizeof(stream->stats));
+   maybe_unlock_mutex(stream->spl.mutex);
+}
+
+
+/* vim: set sts=3 sw=3 et: */
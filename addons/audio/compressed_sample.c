@@ -0,0 +1,648 @@
+/*
+ * Samples which keep the encoded file in memory and are decoded as they
+ * play.
+ */
+
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_audio.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_audio.h"
+
+ALLEGRO_DEBUG_CHANNEL("audio")
+
+
+#define MAX_IDENT_LENGTH      (32)
+
+/* Fragments of the stream used to find out the format of the file. */
+#define PROBE_FRAGMENTS       2
+#define PROBE_SAMPLES         1024
+
+/* Fragments of the decoder of each sample instance. */
+#define DECODER_FRAGMENTS     4
+#define DECODER_SAMPLES       1024
+
+/* The encoded file, shared by the sample and every stream decoding it.
+ * Freed when the last of them lets go.
+ */
+struct COMPRESSED_SAMPLE_DATA {
+   char ident[MAX_IDENT_LENGTH];
+   char *data;
+   int64_t size;
+   volatile _AL_ATOMIC refcount;
+};
+
+
+static void maybe_lock_mutex(ALLEGRO_MUTEX *mutex)
+{
+   if (mutex) {
+      al_lock_mutex(mutex);
+   }
+}
+
+
+static void maybe_unlock_mutex(ALLEGRO_MUTEX *mutex)
+{
+   if (mutex) {
+      al_unlock_mutex(mutex);
+   }
+}
+
+
+static void unref_compressed_data(COMPRESSED_SAMPLE_DATA *cdata)
+{
+   if (_al_sub1_and_fetch(&cdata->refcount) == 0) {
+      al_free(cdata->data);
+      al_free(cdata);
+   }
+}
+
+
+/* A read-only file reading from the encoded data, one per stream. */
+typedef struct COMPRESSED_FILE {
+   COMPRESSED_SAMPLE_DATA *cdata;
+   int64_t pos;
+   bool eof;
+} COMPRESSED_FILE;
+
+
+static bool cfile_fclose(ALLEGRO_FILE *fp)
+{
+   COMPRESSED_FILE *cf = al_get_file_userdata(fp);
+
+   unref_compressed_data(cf->cdata);
+   al_free(cf);
+   return true;
+}
+
+
+static size_t cfile_fread(ALLEGRO_FILE *fp, void *ptr, size_t size)
+{
+   COMPRESSED_FILE *cf = al_get_file_userdata(fp);
+   size_t n = size;
+
+   if (cf->cdata->size - cf->pos < (int64_t)size) {
+      n = cf->cdata->size - cf->pos;
+      cf->eof = true;
+   }
+   memcpy(ptr, cf->cdata->data + cf->pos, n);
+   cf->pos += n;
+
+   return n;
+}
+
+
+static size_t cfile_fwrite(ALLEGRO_FILE *fp, const void *ptr, size_t size)
+{
+   (void)fp;
+   (void)ptr;
+   (void)size;
+   al_set_errno(EPERM);
+   return 0;
+}
+
+
+static bool cfile_fflush(ALLEGRO_FILE *fp)
+{
+   (void)fp;
+   return true;
+}
+
+
+static int64_t cfile_ftell(ALLEGRO_FILE *fp)
+{
+   COMPRESSED_FILE *cf = al_get_file_userdata(fp);
+
+   return cf->pos;
+}
+
+
+static bool cfile_fseek(ALLEGRO_FILE *fp, int64_t offset, int whence)
+{
+   COMPRESSED_FILE *cf = al_get_file_userdata(fp);
+   int64_t pos = cf->pos;
+
+   switch (whence) {
+      case ALLEGRO_SEEK_SET:
+         pos = offset;
+         break;
+      case ALLEGRO_SEEK_CUR:
+         pos = cf->pos + offset;
+         break;
+      case ALLEGRO_SEEK_END:
+         pos = cf->cdata->size + offset;
+         break;
+   }
+
+   if (pos >= cf->cdata->size)
+      pos = cf->cdata->size;
+   else if (pos < 0)
+      pos = 0;
+   cf->pos = pos;
+   cf->eof = false;
+
+   return true;
+}
+
+
+static bool cfile_feof(ALLEGRO_FILE *fp)
+{
+   COMPRESSED_FILE *cf = al_get_file_userdata(fp);
+
+   return cf->eof;
+}
+
+
+static int cfile_ferror(ALLEGRO_FILE *fp)
+{
+   (void)fp;
+   return 0;
+}
+
+
+static const char *cfile_ferrmsg(ALLEGRO_FILE *fp)
+{
+   (void)fp;
+   return "";
+}
+
+
+static void cfile_fclearerr(ALLEGRO_FILE *fp)
+{
+   COMPRESSED_FILE *cf = al_get_file_userdata(fp);
+
+   cf->eof = false;
+}
+
+
+static off_t cfile_fsize(ALLEGRO_FILE *fp)
+{
+   COMPRESSED_FILE *cf = al_get_file_userdata(fp);
+
+   return cf->cdata->size;
+}
+
+
+static const ALLEGRO_FILE_INTERFACE cfile_vtable = {
+   NULL,    /* open */
+   cfile_fclose,
+   cfile_fread,
+   cfile_fwrite,
+   cfile_fflush,
+   cfile_ftell,
+   cfile_fseek,
+   cfile_feof,
+   cfile_ferror,
+   cfile_ferrmsg,
+   cfile_fclearerr,
+   NULL,    /* ungetc */
+   cfile_fsize
+};
+
+
+/* Opens a stream on the compressed data.  Nothing feeds it: probes only
+ * look at the format, and decoders are fed by the mixer.
+ */
+static ALLEGRO_AUDIO_STREAM *open_compressed_stream(
+   COMPRESSED_SAMPLE_DATA *cdata, size_t buffer_count, unsigned int samples)
+{
+   COMPRESSED_FILE *cf;
+   ALLEGRO_FILE *fp;
+   ALLEGRO_AUDIO_STREAM *stream;
+
+   cf = al_calloc(1, sizeof(*cf));
+   if (!cf) {
+      _al_set_error(ALLEGRO_GENERIC_ERROR,
+         "Out of memory allocating compressed sample file");
+      return NULL;
+   }
+   cf->cdata = cdata;
+   _al_fetch_and_add1(&cdata->refcount);
+
+   fp = al_create_file_handle(&cfile_vtable, cf);
+   if (!fp) {
+      unref_compressed_data(cdata);
+      al_free(cf);
+      return NULL;
+   }
+
+   /* The stream closes the file when it is destroyed. */
+   stream = _al_kcm_open_audio_stream_f(fp, cdata->ident, buffer_count,
+      samples);
+   if (stream)
+      stream->data_in_memory = true;
+   else
+      al_fclose(fp);
+
+   return stream;
+}
+
+
+static void release_compressed_sample(ALLEGRO_SAMPLE *spl)
+{
+   unref_compressed_data(spl->compressed);
+   spl->compressed = NULL;
+}
+
+
+/* Reads the rest of the file into memory. */
+static bool read_compressed_data(ALLEGRO_FILE *fp,
+   COMPRESSED_SAMPLE_DATA *cdata)
+{
+   int64_t size = al_fsize(fp);
+   int64_t pos = al_ftell(fp);
+   int64_t capacity;
+
+   if (size >= 0 && pos >= 0 && size >= pos)
+      capacity = size - pos + 1;
+   else
+      capacity = 64 * 1024;
+
+   cdata->size = 0;
+   cdata->data = al_malloc(capacity);
+   if (!cdata->data)
+      return false;
+
+   for (;;) {
+      size_t n = al_fread(fp, cdata->data + cdata->size,
+         capacity - cdata->size);
+      cdata->size += n;
+      if (cdata->size < capacity)
+         break;
+
+      /* The size was unknown or wrong. */
+      capacity *= 2;
+      {
+         char *data = al_realloc(cdata->data, capacity);
+         if (!data)
+            return false;
+         cdata->data = data;
+      }
+   }
+
+   return al_ferror(fp) == 0 && cdata->size > 0;
+}
+
+
+/* Function: al_load_sample_compressed_f
+ */
+ALLEGRO_SAMPLE *al_load_sample_compressed_f(ALLEGRO_FILE *fp,
+   const char *ident)
+{
+   COMPRESSED_SAMPLE_DATA *cdata;
+   ALLEGRO_AUDIO_STREAM *probe;
+   ALLEGRO_SAMPLE *spl;
+
+   ASSERT(fp);
+   ASSERT(ident);
+
+   if (strlen(ident) + 1 >= MAX_IDENT_LENGTH) {
+      _al_set_error(ALLEGRO_INVALID_PARAM, "Audio file type too long");
+      return NULL;
+   }
+
+   cdata = al_calloc(1, sizeof(*cdata));
+   if (!cdata) {
+      _al_set_error(ALLEGRO_GENERIC_ERROR,
+         "Out of memory allocating compressed sample");
+      return NULL;
+   }
+   strcpy(cdata->ident, ident);
+   cdata->refcount = 1;
+
+   if (!read_compressed_data(fp, cdata)) {
+      ALLEGRO_ERROR("Unable to read the compressed sample\n");
+      unref_compressed_data(cdata);
+      return NULL;
+   }
+
+   /* Decode the start of the file once to check that it can be streamed,
+    * and to find out its format and length.
+    */
+   probe = open_compressed_stream(cdata, PROBE_FRAGMENTS, PROBE_SAMPLES);
+   if (!probe) {
+      ALLEGRO_ERROR("Unable to stream %s data\n", ident);
+      unref_compressed_data(cdata);
+      return NULL;
+   }
+
+   spl = al_calloc(1, sizeof(*spl));
+   if (!spl) {
+      _al_set_error(ALLEGRO_GENERIC_ERROR,
+         "Out of memory allocating sample data object");
+      al_destroy_audio_stream(probe);
+      unref_compressed_data(cdata);
+      return NULL;
+   }
+
+   spl->depth = al_get_audio_stream_depth(probe);
+   spl->chan_conf = al_get_audio_stream_channels(probe);
+   spl->frequency = al_get_audio_stream_frequency(probe);
+   spl->len = (int)(al_get_audio_stream_length_secs(probe) *
+      spl->frequency + 0.5);
+   spl->compressed = cdata;
+   spl->release_buf = release_compressed_sample;
+   al_destroy_audio_stream(probe);
+
+   ALLEGRO_DEBUG("Compressed %s sample: %d frames in %ld bytes\n", ident,
+      spl->len, (long)cdata->size);
+
+   _al_kcm_register_destructor(spl, (void (*)(void *)) al_destroy_sample);
+
+   return spl;
+}
+
+
+/* Function: al_load_sample_compressed
+ */
+ALLEGRO_SAMPLE *al_load_sample_compressed(const char *filename)
+{
+   ALLEGRO_FILE *fp;
+   ALLEGRO_SAMPLE *spl;
+   const char *ext;
+
+   ASSERT(filename);
+
+   ext = strrchr(filename, '.');
+   if (ext == NULL)
+      return NULL;
+
+   fp = al_fopen(filename, "rb");
+   if (!fp) {
+      ALLEGRO_WARN("Unable to open %s\n", filename);
+      return NULL;
+   }
+
+   spl = al_load_sample_compressed_f(fp, ext);
+   al_fclose(fp);
+
+   return spl;
+}
+
+
+/* Function: al_is_sample_compressed
+ */
+bool al_is_sample_compressed(const ALLEGRO_SAMPLE *spl)
+{
+   ASSERT(spl);
+
+   return spl->compressed != NULL;
+}
+
+
+/* Function: al_create_audio_stream_from_sample
+ */
+ALLEGRO_AUDIO_STREAM *al_create_audio_stream_from_sample(ALLEGRO_SAMPLE *spl,
+   size_t buffer_count, unsigned int samples)
+{
+   ASSERT(spl);
+
+   if (!spl->compressed) {
+      _al_set_error(ALLEGRO_INVALID_PARAM, "Sample is not compressed");
+      return NULL;
+   }
+
+   return open_compressed_stream(spl->compressed, buffer_count, samples);
+}
+
+
+
+/* Sample instances playing a compressed sample.
+ *
+ * Each instance has a stream of its own decoding the sample, attached to the
+ * instance's mixer, and forwards to it.  The decoder is not fed by a thread:
+ * it is refilled by the mixer, through its fill callback, when it runs out.
+ * That way it can be stopped, rewound and started again at any time, and an
+ * instance played again and again (as by al_play_sample) keeps its decoder.
+ * Decoding is quick next to the mixing, the file being in memory.
+ */
+
+
+/* Fill callback of the decoders, called by the mixer with the stream mutex
+ * held.  Loops by rewinding the decoder, and otherwise lets the stream drain
+ * once the sample has been decoded to the end.
+ */
+static unsigned int decode_fragment(ALLEGRO_AUDIO_STREAM *stream, void *buf,
+   unsigned int samples, void *data)
+{
+   const int frame_size =
+      al_get_channel_count(stream->spl.spl_data.chan_conf) *
+      al_get_audio_depth_size(stream->spl.spl_data.depth);
+   const size_t bytes = (size_t)samples * frame_size;
+   size_t written;
+   (void)data;
+
+   written = stream->feeder(stream, buf, bytes);
+
+   while (written < bytes &&
+         stream->spl.loop == _ALLEGRO_PLAYMODE_STREAM_ONEDIR) {
+      size_t n;
+
+      /* Not al_rewind_audio_stream, the mutex is held already. */
+      if (!stream->rewind_feeder(stream))
+         break;
+      n = stream->feeder(stream, (char *)buf + written, bytes - written);
+      if (n == 0)
+         break;
+      written += n;
+   }
+
+   if (written < bytes)
+      stream->is_draining = true;
+
+   return written / frame_size;
+}
+
+
+/* Passes the end of the sample on to the instance's stop callback. */
+static void decoder_finished(ALLEGRO_SAMPLE_INSTANCE *stream_spl, void *data)
+{
+   ALLEGRO_SAMPLE_INSTANCE *spl = data;
+   (void)stream_spl;
+
+   if (spl->stop_callback)
+      spl->stop_callback(spl, spl->stop_callback_data);
+}
+
+
+/* Stops the decoder and takes it back to the start of the sample. */
+static void rewind_decoder(ALLEGRO_AUDIO_STREAM *decoder)
+{
+   al_set_audio_stream_playing(decoder, false);
+   al_rewind_audio_stream(decoder);
+   decoder->is_draining = false;
+}
+
+
+static ALLEGRO_AUDIO_STREAM *open_decoder(ALLEGRO_SAMPLE_INSTANCE *spl,
+   COMPRESSED_SAMPLE_DATA *cdata)
+{
+   ALLEGRO_AUDIO_STREAM *decoder;
+
+   decoder = open_compressed_stream(cdata, DECODER_FRAGMENTS,
+      DECODER_SAMPLES);
+   if (!decoder)
+      return NULL;
+
+   /* The mixer feeds the decoder, through decode_fragment. */
+   decoder->fill_callback = decode_fragment;
+   decoder->fill_callback_userdata = NULL;
+   decoder->spl.stop_callback = decoder_finished;
+   decoder->spl.stop_callback_data = spl;
+   rewind_decoder(decoder);
+
+   if (!al_set_audio_stream_speed(decoder, spl->speed) ||
+         !al_set_audio_stream_gain(decoder, spl->gain) ||
+         !al_set_audio_stream_pan(decoder, spl->pan) ||
+         !al_set_audio_stream_playmode(decoder,
+            spl->loop == ALLEGRO_PLAYMODE_LOOP ? ALLEGRO_PLAYMODE_LOOP
+               : ALLEGRO_PLAYMODE_ONCE)) {
+      al_destroy_audio_stream(decoder);
+      return NULL;
+   }
+
+   return decoder;
+}
+
+
+/* _al_kcm_set_sample_decoder:
+ *  Gives the instance a decoder for the sample data, which is about to be
+ *  set, if it is compressed, and destroys the one it had otherwise.  The
+ *  decoder is kept, and rewound, if the data is that of the sample it is
+ *  decoding already.
+ */
+bool _al_kcm_set_sample_decoder(ALLEGRO_SAMPLE_INSTANCE *spl,
+   const ALLEGRO_SAMPLE *data)
+{
+   COMPRESSED_SAMPLE_DATA *cdata = data ? data->compressed : NULL;
+   ALLEGRO_AUDIO_STREAM *decoder;
+
+   if (spl->decoder && cdata == spl->spl_data.compressed) {
+      rewind_decoder(spl->decoder);
+      return true;
+   }
+
+   if (spl->decoder) {
+      al_destroy_audio_stream(spl->decoder);
+      spl->decoder = NULL;
+   }
+
+   if (!cdata)
+      return true;
+
+   decoder = open_decoder(spl, cdata);
+   if (!decoder) {
+      ALLEGRO_ERROR("Unable to decode the %s sample\n", cdata->ident);
+      return false;
+   }
+
+   if (spl->parent.u.ptr && !spl->parent.is_voice &&
+         !al_attach_audio_stream_to_mixer(decoder, spl->parent.u.mixer)) {
+      al_destroy_audio_stream(decoder);
+      return false;
+   }
+
+   spl->decoder = decoder;
+   return true;
+}
+
+
+/* _al_kcm_set_decoder_playing:
+ *  al_set_sample_instance_playing for instances with a decoder.  An instance
+ *  which has played to the end starts again from the beginning.
+ */
+bool _al_kcm_set_decoder_playing(ALLEGRO_SAMPLE_INSTANCE *spl, bool val)
+{
+   ALLEGRO_AUDIO_STREAM *decoder = spl->decoder;
+
+   if (!val) {
+      rewind_decoder(decoder);
+      return true;
+   }
+
+   if (al_get_audio_stream_playing(decoder))
+      return true;
+
+   if (decoder->is_draining)
+      rewind_decoder(decoder);
+
+   return al_set_audio_stream_playing(decoder, true);
+}
+
+
+/* _al_kcm_set_decoder_playmode:
+ *  al_set_sample_instance_playmode for instances with a decoder.
+ */
+bool _al_kcm_set_decoder_playmode(ALLEGRO_SAMPLE_INSTANCE *spl,
+   ALLEGRO_PLAYMODE val)
+{
+   if (val == ALLEGRO_PLAYMODE_BIDIR) {
+      _al_set_error(ALLEGRO_INVALID_PARAM,
+         "Compressed samples cannot be played backwards");
+      return false;
+   }
+
+   return al_set_audio_stream_playmode(spl->decoder, val);
+}
+
+
+/* _al_kcm_get_decoder_position:
+ *  al_get_sample_instance_position for instances with a decoder.  The
+ *  decoder is ahead of what has been heard by the fragments it has queued.
+ */
+unsigned int _al_kcm_get_decoder_position(const ALLEGRO_SAMPLE_INSTANCE *spl)
+{
+   ALLEGRO_AUDIO_STREAM *decoder = spl->decoder;
+   const ALLEGRO_SAMPLE_INSTANCE *dspl = &decoder->spl;
+   int64_t pos;
+   size_t i;
+
+   maybe_lock_mutex(dspl->mutex);
+
+   if (!dspl->is_playing && decoder->is_draining) {
+      /* Played to the end. */
+      pos = 0;
+   }
+   else {
+      pos = (int64_t)(decoder->get_feeder_position(decoder) *
+         dspl->spl_data.frequency + 0.5);
+      for (i = 0; i < decoder->buf_count && decoder->pending_bufs[i]; i++)
+         pos -= dspl->spl_data.len;
+      if (dspl->spl_data.buffer.ptr)
+         pos += dspl->pos;
+   }
+
+   maybe_unlock_mutex(dspl->mutex);
+
+   /* Queued from before the loop point. */
+   if (pos < 0 && spl->loop == ALLEGRO_PLAYMODE_LOOP)
+      pos += spl->spl_data.len;
+   if (pos < 0)
+      pos = 0;
+
+   return (unsigned int)pos;
+}
+
+
+/* _al_kcm_set_decoder_position:
+ *  al_set_sample_instance_position for instances with a decoder.  What the
+ *  decoder has queued is thrown away, so the new position is heard at once.
+ */
+bool _al_kcm_set_decoder_position(ALLEGRO_SAMPLE_INSTANCE *spl,
+   unsigned int val)
+{
+   ALLEGRO_AUDIO_STREAM *decoder = spl->decoder;
+   const bool playing = al_get_audio_stream_playing(decoder);
+   bool ret;
+
+   al_set_audio_stream_playing(decoder, false);
+   ret = al_seek_audio_stream_secs(decoder,
+      (double)val / spl->spl_data.frequency);
+   decoder->is_draining = false;
+   if (playing)
+      al_set_audio_stream_playing(decoder, true);
+
+   return ret;
+}
+
+
+/* vim: set sts=3 sw=3 et: */
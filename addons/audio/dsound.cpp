@@ -644,8 +644,9 @@ static void *_dsound_update_recorder(ALLEGRO_THREAD *t, void *data)
    ALLEGRO_AUDIO_RECORDER *r = (ALLEGRO_AUDIO_RECORDER *) data;
    DSOUND_RECORD_DATA *extra = (DSOUND_RECORD_DATA *) r->extra;
    DWORD last_read_pos = 0;
-   ALLEGRO_EVENT user_event;
    bool is_dsound_recording = false;
+   /* Poll twice per fragment, so a fragment waits at most half its length. */
+   double poll_interval = 0.5 * r->samples / r->frequency;
 
    size_t fragment_i = 0;
    size_t bytes_written = 0;
@@ -700,18 +701,14 @@ static void *_dsound_update_recorder(ALLEGRO_THREAD *t, void *data)
                buffer_size = 0;
             }
             else {
-               ALLEGRO_AUDIO_RECORDER_EVENT *e;
                size_t bytes_to_write = r->fragment_size - bytes_written;
                memcpy((uint8_t*) r->fragments[fragment_i] + bytes_written, buffer, bytes_to_write);
 
                buffer_size -= bytes_to_write;
                buffer += bytes_to_write;
 
-               user_event.user.type = ALLEGRO_EVENT_AUDIO_RECORDER_FRAGMENT;
-               e = al_get_audio_recorder_event(&user_event);
-               e->buffer = r->fragments[fragment_i];
-               e->samples = r->samples;
-               al_emit_user_event(&r->source, &user_event, NULL);
+               _al_kcm_emit_recorder_fragment(r, r->fragments[fragment_i],
+                  r->samples);
 
                /* advance to the next fragment */
                if (++fragment_i == r->fragment_count) {
@@ -730,7 +727,7 @@ static void *_dsound_update_recorder(ALLEGRO_THREAD *t, void *data)
       }
       
       al_unlock_mutex(r->mutex);
-      al_rest(0.10);
+      al_rest(poll_interval < 0.10 ? poll_interval : 0.10);
    }
 
 stop_recording:
@@ -0,0 +1,373 @@
+/*
+ * Samples kept IMA or MS ADPCM compressed, as loaded from WAV files, which
+ * the mixers decode a block at a time as they play them.
+ */
+
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_audio.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_audio.h"
+
+ALLEGRO_DEBUG_CHANNEL("audio")
+
+
+static const int ima_index_table[16] = {
+   -1, -1, -1, -1, 2, 4, 6, 8,
+   -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int ima_step_table[89] = {
+   7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+   45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209,
+   230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876,
+   963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749,
+   3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+   9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385,
+   24623, 27086, 29794, 32767
+};
+
+static const int ms_adapt_table[16] = {
+   230, 230, 230, 230, 307, 409, 512, 614,
+   768, 614, 512, 409, 307, 230, 230, 230
+};
+
+
+static INLINE int16_t read_s16(const unsigned char *p)
+{
+   return (int16_t)(p[0] | (p[1] << 8));
+}
+
+
+static INLINE int clamp_s16(int x)
+{
+   if (x > 32767)
+      return 32767;
+   if (x < -32768)
+      return -32768;
+   return x;
+}
+
+
+static INLINE int16_t ima_expand(int *pred, int *index, int nibble)
+{
+   const int step = ima_step_table[*index];
+   int diff = step >> 3;
+
+   if (nibble & 1)
+      diff += step >> 2;
+   if (nibble & 2)
+      diff += step >> 1;
+   if (nibble & 4)
+      diff += step;
+   if (nibble & 8)
+      *pred = clamp_s16(*pred - diff);
+   else
+      *pred = clamp_s16(*pred + diff);
+
+   *index += ima_index_table[nibble];
+   if (*index < 0)
+      *index = 0;
+   else if (*index > 88)
+      *index = 88;
+
+   return (int16_t)*pred;
+}
+
+
+/* An IMA block starts with the first frame and the step index of each
+ * channel, followed by groups of 4 bytes per channel, each byte holding two
+ * frames, low nibble first.
+ */
+static int decode_ima_block(const ADPCM_DATA *adpcm, const unsigned char *in,
+   size_t size, int16_t *out)
+{
+   const int channels = adpcm->channels;
+   int pred[ALLEGRO_MAX_CHANNELS];
+   int index[ALLEGRO_MAX_CHANNELS];
+   int frames, groups, g, ch, b;
+
+   if (size < (size_t)(4 * channels))
+      return 0;
+
+   for (ch = 0; ch < channels; ch++) {
+      pred[ch] = read_s16(in);
+      index[ch] = in[2] > 88 ? 88 : in[2];
+      out[ch] = (int16_t)pred[ch];
+      in += 4;
+   }
+
+   groups = (int)((size - 4 * channels) / (4 * channels));
+   frames = 1 + groups * 8;
+   if (frames > adpcm->samples_per_block)
+      frames = adpcm->samples_per_block;
+
+   for (g = 0; g < groups; g++) {
+      for (ch = 0; ch < channels; ch++) {
+         for (b = 0; b < 4; b++) {
+            const int f = 1 + g * 8 + b * 2;
+            const int byte = *in++;
+            if (f < frames)
+               out[f * channels + ch] = ima_expand(&pred[ch], &index[ch],
+                  byte & 0x0F);
+            if (f + 1 < frames)
+               out[(f + 1) * channels + ch] = ima_expand(&pred[ch],
+                  &index[ch], byte >> 4);
+         }
+      }
+   }
+
+   return frames;
+}
+
+
+/* An MS block starts with the predictor, the delta, and the second and
+ * first frames of each channel, followed by one nibble per value, high
+ * nibble first, the channels taking turns.
+ */
+static int decode_ms_block(const ADPCM_DATA *adpcm, const unsigned char *in,
+   size_t size, int16_t *out)
+{
+   const int channels = adpcm->channels;
+   int c1[ALLEGRO_MAX_CHANNELS];
+   int c2[ALLEGRO_MAX_CHANNELS];
+   int delta[ALLEGRO_MAX_CHANNELS];
+   int s1[ALLEGRO_MAX_CHANNELS];
+   int s2[ALLEGRO_MAX_CHANNELS];
+   int frames, n, j, ch;
+
+   if (size < (size_t)(7 * channels))
+      return 0;
+
+   for (ch = 0; ch < channels; ch++) {
+      int pred = in[ch];
+      if (pred >= adpcm->num_coefs)
+         pred = 0;
+      c1[ch] = adpcm->coefs[pred * 2];
+      c2[ch] = adpcm->coefs[pred * 2 + 1];
+      delta[ch] = read_s16(in + channels + 2 * ch);
+      s1[ch] = read_s16(in + 3 * channels + 2 * ch);
+      s2[ch] = read_s16(in + 5 * channels + 2 * ch);
+      out[ch] = (int16_t)s2[ch];
+      out[channels + ch] = (int16_t)s1[ch];
+   }
+   in += 7 * channels;
+
+   frames = 2 + (int)((size - 7 * channels) * 2 / channels);
+   if (frames > adpcm->samples_per_block)
+      frames = adpcm->samples_per_block;
+   n = (frames - 2) * channels;
+
+   for (j = 0; j < n; j++) {
+      const int nibble = (j & 1) ? (in[j >> 1] & 0x0F) : (in[j >> 1] >> 4);
+      int pred;
+      ch = j % channels;
+
+      pred = (s1[ch] * c1[ch] + s2[ch] * c2[ch]) >> 8;
+      pred = clamp_s16(pred + (nibble >= 8 ? nibble - 16 : nibble) * delta[ch]);
+      s2[ch] = s1[ch];
+      s1[ch] = pred;
+
+      delta[ch] = (ms_adapt_table[nibble] * delta[ch]) >> 8;
+      if (delta[ch] < 16)
+         delta[ch] = 16;
+
+      out[2 * channels + j] = (int16_t)pred;
+   }
+
+   return frames;
+}
+
+
+/* _al_kcm_decode_adpcm_block:
+ *  Decodes block number `block' into `out', which must have room for
+ *  samples_per_block frames.  Returns the number of frames decoded, which
+ *  is less for a short last block.
+ */
+int _al_kcm_decode_adpcm_block(const ADPCM_DATA *adpcm, int block,
+   int16_t *out)
+{
+   const size_t start = (size_t)block * adpcm->block_align;
+   size_t size;
+
+   if (start >= adpcm->size)
+      return 0;
+   size = adpcm->size - start;
+   if (size > (size_t)adpcm->block_align)
+      size = adpcm->block_align;
+
+   if (adpcm->format == _AL_ADPCM_IMA)
+      return decode_ima_block(adpcm, adpcm->data + start, size, out);
+   else
+      return decode_ms_block(adpcm, adpcm->data + start, size, out);
+}
+
+
+/* _al_kcm_decode_adpcm_frame:
+ *  Decodes the block holding frame `pos' into whichever of the cached
+ *  blocks was not used last, and returns the frame.  Called by the mixer
+ *  when neither cached block holds it.
+ */
+const int16_t *_al_kcm_decode_adpcm_frame(ALLEGRO_SAMPLE_INSTANCE *spl,
+   int pos)
+{
+   const ADPCM_DATA *adpcm = spl->spl_data.adpcm;
+   ADPCM_CACHE *cache = spl->adpcm_cache;
+   const int block = pos / adpcm->samples_per_block;
+   const int slot = !cache->last;
+   int frames;
+
+   frames = _al_kcm_decode_adpcm_block(adpcm, block, cache->pcm[slot]);
+   if (frames < adpcm->samples_per_block) {
+      /* The last block may be short. */
+      memset(cache->pcm[slot] + frames * adpcm->channels, 0,
+         (adpcm->samples_per_block - frames) * adpcm->channels *
+         sizeof(int16_t));
+   }
+
+   cache->block[slot] = block;
+   cache->last = slot;
+
+   return cache->pcm[slot] +
+      (pos - block * adpcm->samples_per_block) * adpcm->channels;
+}
+
+
+/* _al_kcm_prepare_adpcm_cache:
+ *  Makes room in the instance for the blocks of `data', if it is ADPCM
+ *  compressed, before the instance is set to play it.
+ */
+bool _al_kcm_prepare_adpcm_cache(ALLEGRO_SAMPLE_INSTANCE *spl,
+   const ALLEGRO_SAMPLE *data)
+{
+   ADPCM_CACHE *cache = spl->adpcm_cache;
+   size_t values;
+
+   if (!data || !data->adpcm) {
+      al_free(cache);
+      spl->adpcm_cache = NULL;
+      return true;
+   }
+
+   values = (size_t)data->adpcm->samples_per_block * data->adpcm->channels;
+
+   if (!cache || cache->pcm[1] - cache->pcm[0] != (ptrdiff_t)values) {
+      al_free(cache);
+      cache = al_malloc(sizeof(*cache) + 2 * values * sizeof(int16_t));
+      spl->adpcm_cache = cache;
+      if (!cache) {
+         _al_set_error(ALLEGRO_GENERIC_ERROR,
+            "Out of memory allocating ADPCM decode buffers");
+         return false;
+      }
+      cache->pcm[0] = (int16_t *)(cache + 1);
+      cache->pcm[1] = cache->pcm[0] + values;
+   }
+
+   cache->channels = data->adpcm->channels;
+   cache->block[0] = -1;
+   cache->block[1] = -1;
+   cache->last = 0;
+
+   return true;
+}
+
+
+static void decode_all_blocks(const ADPCM_DATA *adpcm, int16_t *out,
+   unsigned int samples)
+{
+   unsigned int pos = 0;
+   int block;
+
+   for (block = 0; pos < samples; block++) {
+      int frames = _al_kcm_decode_adpcm_block(adpcm, block,
+         out + (size_t)pos * adpcm->channels);
+      if (frames <= 0)
+         break;
+      pos += frames;
+   }
+
+   /* Truncated data reads as silence. */
+   if (pos < samples) {
+      memset(out + (size_t)pos * adpcm->channels, 0,
+         (samples - pos) * adpcm->channels * sizeof(int16_t));
+   }
+}
+
+
+/* _al_kcm_create_adpcm_sample:
+ *  Creates a sample playing the ADPCM blocks, which it takes over.  With
+ *  the [audio] decode_adpcm_samples config option set they are decoded to
+ *  16-bit sample data up front instead.
+ */
+ALLEGRO_SAMPLE *_al_kcm_create_adpcm_sample(ADPCM_DATA *adpcm,
+   unsigned int samples, unsigned int freq)
+{
+   ALLEGRO_CHANNEL_CONF chan_conf = _al_count_to_channel_conf(adpcm->channels);
+   ALLEGRO_SAMPLE *spl;
+   const char *p;
+
+   p = al_get_config_value(al_get_system_config(), "audio",
+      "decode_adpcm_samples");
+   if (p && atoi(p) != 0) {
+      /* One byte over, so that an empty sample still has a buffer. */
+      int16_t *buf = al_malloc((size_t)samples * adpcm->channels *
+         sizeof(int16_t) + 1);
+      if (!buf) {
+         _al_set_error(ALLEGRO_GENERIC_ERROR,
+            "Out of memory decoding ADPCM sample");
+         _al_kcm_destroy_adpcm_data(adpcm);
+         return NULL;
+      }
+      decode_all_blocks(adpcm, buf, samples);
+      _al_kcm_destroy_adpcm_data(adpcm);
+      spl = al_create_sample(buf, samples, freq, ALLEGRO_AUDIO_DEPTH_INT16,
+         chan_conf, true);
+      if (!spl)
+         al_free(buf);
+      return spl;
+   }
+
+   if (!freq) {
+      _al_set_error(ALLEGRO_INVALID_PARAM, "Invalid sample frequency");
+      _al_kcm_destroy_adpcm_data(adpcm);
+      return NULL;
+   }
+
+   spl = al_calloc(1, sizeof(*spl));
+   if (!spl) {
+      _al_set_error(ALLEGRO_GENERIC_ERROR,
+         "Out of memory allocating sample data object");
+      _al_kcm_destroy_adpcm_data(adpcm);
+      return NULL;
+   }
+
+   spl->depth = ALLEGRO_AUDIO_DEPTH_INT16;
+   spl->chan_conf = chan_conf;
+   spl->frequency = freq;
+   spl->len = samples;
+   spl->adpcm = adpcm;
+
+   ALLEGRO_DEBUG("%s ADPCM sample: %u frames in %lu bytes\n",
+      adpcm->format == _AL_ADPCM_IMA ? "IMA" : "MS", samples,
+      (unsigned long)adpcm->size);
+
+   _al_kcm_register_destructor(spl, (void (*)(void *)) al_destroy_sample);
+
+   return spl;
+}
+
+
+/* _al_kcm_destroy_adpcm_data:
+ *  Frees the blocks of an ADPCM sample.
+ */
+void _al_kcm_destroy_adpcm_data(ADPCM_DATA *adpcm)
+{
+   if (adpcm) {
+      al_free(adpcm->coefs);
+      al_free(adpcm->data);
+      al_free(adpcm);
+   }
+}
+
+
+/* vim: set sts=3 sw=3 et: */
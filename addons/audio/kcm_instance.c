@@ -85,16 +85,26 @@ static void stream_free(ALLEGRO_SAMPLE_INSTANCE *spl)
 
          _al_vector_free(&mixer->streams);
 
+         if (mixer->render_mutex) {
+            al_destroy_mutex(mixer->render_mutex);
+            al_destroy_cond(mixer->render_cond);
+            mixer->render_mutex = NULL;
+            mixer->render_cond = NULL;
+         }
+
          if (spl->spl_data.buffer.ptr) {
             ASSERT(spl->spl_data.free_buf);
             al_free(spl->spl_data.buffer.ptr);
             spl->spl_data.buffer.ptr = NULL;
          }
+         al_free(mixer->interleave_buf);
+         mixer->interleave_buf = NULL;
          spl->spl_data.free_buf = false;
       }
 
       ASSERT(! spl->spl_data.free_buf);
 
+      al_free(spl->adpcm_cache);
       al_free(spl);
    }
 }
@@ -112,6 +122,9 @@ void _al_kcm_detach_from_parent(ALLEGRO_SAMPLE_INSTANCE *spl)
    if (!spl || !spl->parent.u.ptr)
       return;
 
+   if (spl->decoder)
+      al_detach_audio_stream(spl->decoder);
+
    if (spl->parent.is_voice) {
       al_detach_voice(spl->parent.u.voice);
       return;
@@ -128,6 +141,7 @@ void _al_kcm_detach_from_parent(ALLEGRO_SAMPLE_INSTANCE *spl)
 
          _al_vector_delete_at(&mixer->streams, i);
          spl->parent.u.mixer = NULL;
+         spl->converted = NULL;
          _al_kcm_stream_set_mutex(spl, NULL);
 
          spl->spl_read = NULL;
@@ -157,6 +171,10 @@ ALLEGRO_SAMPLE_INSTANCE *al_create_sample_instance(ALLEGRO_SAMPLE *sample_data)
    }
 
    if (sample_data) {
+      if (!_al_kcm_prepare_adpcm_cache(spl, sample_data)) {
+         al_free(spl);
+         return NULL;
+      }
       spl->spl_data = *sample_data;
    }
    spl->spl_data.free_buf = false;
@@ -178,6 +196,12 @@ ALLEGRO_SAMPLE_INSTANCE *al_create_sample_instance(ALLEGRO_SAMPLE *sample_data)
    spl->mutex = NULL;
    spl->parent.u.ptr = NULL;
 
+   if (sample_data && !_al_kcm_set_sample_decoder(spl, sample_data)) {
+      al_free(spl->adpcm_cache);
+      al_free(spl);
+      return NULL;
+   }
+
    _al_kcm_register_destructor(spl, (void (*)(void *)) al_destroy_sample_instance);
 
    return spl;
@@ -203,6 +227,7 @@ void _al_kcm_destroy_sample(ALLEGRO_SAMPLE_INSTANCE *spl, bool unregister)
       }
 
       _al_kcm_detach_from_parent(spl);
+      _al_kcm_set_sample_decoder(spl, NULL);
       stream_free(spl);
    }
 }
@@ -254,6 +279,9 @@ unsigned int al_get_sample_instance_position(const ALLEGRO_SAMPLE_INSTANCE *spl)
 {
    ASSERT(spl);
 
+   if (spl->decoder)
+      return _al_kcm_get_decoder_position(spl);
+
    if (spl->parent.u.ptr && spl->parent.is_voice) {
       ALLEGRO_VOICE *voice = spl->parent.u.voice;
       return al_get_voice_position(voice);
@@ -341,6 +369,9 @@ bool al_get_sample_instance_playing(const ALLEGRO_SAMPLE_INSTANCE *spl)
 {
    ASSERT(spl);
 
+   if (spl->decoder)
+      return al_get_audio_stream_playing(spl->decoder);
+
    if (spl->parent.u.ptr && spl->parent.is_voice) {
       ALLEGRO_VOICE *voice = spl->parent.u.voice;
       return al_get_voice_playing(voice);
@@ -367,6 +398,9 @@ bool al_set_sample_instance_position(ALLEGRO_SAMPLE_INSTANCE *spl,
 {
    ASSERT(spl);
 
+   if (spl->decoder)
+      return _al_kcm_set_decoder_position(spl, val);
+
    if (spl->parent.u.ptr && spl->parent.is_voice) {
       ALLEGRO_VOICE *voice = spl->parent.u.voice;
       if (!al_set_voice_position(voice, val))
@@ -395,6 +429,12 @@ bool al_set_sample_instance_length(ALLEGRO_SAMPLE_INSTANCE *spl,
       return false;
    }
 
+   if (spl->decoder) {
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "Attempted to change the length of a compressed sample");
+      return false;
+   }
+
    spl->spl_data.len = val;
    return true;
 }
@@ -418,24 +458,12 @@ bool al_set_sample_instance_speed(ALLEGRO_SAMPLE_INSTANCE *spl, float val)
       return false;
    }
 
-   spl->speed = val;
-   if (spl->parent.u.mixer) {
-      ALLEGRO_MIXER *mixer = spl->parent.u.mixer;
-
-      maybe_lock_mutex(spl->mutex);
-
-      spl->step = (spl->spl_data.frequency) * spl->speed;
-      spl->step_denom = mixer->ss.spl_data.frequency;
-      /* Don't wanna be trapped with a step value of 0 */
-      if (spl->step == 0) {
-         if (spl->speed > 0.0f)
-            spl->step = 1;
-         else
-            spl->step = -1;
-      }
+   if (spl->decoder && !al_set_audio_stream_speed(spl->decoder, val))
+      return false;
 
-      maybe_unlock_mutex(spl->mutex);
-   }
+   /* The mixer picks up the new speed at the start of its next read. */
+   spl->speed = val;
+   _al_fetch_and_add1(&spl->param_serial);
 
    return true;
 }
@@ -453,19 +481,16 @@ bool al_set_sample_instance_gain(ALLEGRO_SAMPLE_INSTANCE *spl, float val)
       return false;
    }
 
+   if (spl->decoder && !al_set_audio_stream_gain(spl->decoder, val))
+      return false;
+
    if (spl->gain != val) {
       spl->gain = val;
 
-      /* If attached to a mixer already, need to recompute the sample
-       * matrix to take into account the gain.
+      /* The mixer recomputes the sample matrix at the start of its next
+       * read, without us having to wait for it.
        */
-      if (spl->parent.u.mixer) {
-         ALLEGRO_MIXER *mixer = spl->parent.u.mixer;
-
-         maybe_lock_mutex(spl->mutex);
-         _al_kcm_mixer_rejig_sample_matrix(mixer, spl);
-         maybe_unlock_mutex(spl->mutex);
-      }
+      _al_fetch_and_add1(&spl->param_serial);
    }
 
    return true;
@@ -488,19 +513,16 @@ bool al_set_sample_instance_pan(ALLEGRO_SAMPLE_INSTANCE *spl, float val)
       return false;
    }
 
+   if (spl->decoder && !al_set_audio_stream_pan(spl->decoder, val))
+      return false;
+
    if (spl->pan != val) {
       spl->pan = val;
 
-      /* If attached to a mixer already, need to recompute the sample
-       * matrix to take into account the panning.
+      /* The mixer recomputes the sample matrix at the start of its next
+       * read, without us having to wait for it.
        */
-      if (spl->parent.u.mixer) {
-         ALLEGRO_MIXER *mixer = spl->parent.u.mixer;
-
-         maybe_lock_mutex(spl->mutex);
-         _al_kcm_mixer_rejig_sample_matrix(mixer, spl);
-         maybe_unlock_mutex(spl->mutex);
-      }
+      _al_fetch_and_add1(&spl->param_serial);
    }
 
    return true;
@@ -520,6 +542,9 @@ bool al_set_sample_instance_playmode(ALLEGRO_SAMPLE_INSTANCE *spl,
       return false;
    }
 
+   if (spl->decoder && !_al_kcm_set_decoder_playmode(spl, val))
+      return false;
+
    maybe_lock_mutex(spl->mutex);
 
    spl->loop = val;
@@ -540,8 +565,22 @@ bool al_set_sample_instance_playmode(ALLEGRO_SAMPLE_INSTANCE *spl,
  */
 bool al_set_sample_instance_playing(ALLEGRO_SAMPLE_INSTANCE *spl, bool val)
 {
+   bool was_playing;
+
    ASSERT(spl);
 
+   if (spl->decoder) {
+      was_playing = al_get_audio_stream_playing(spl->decoder);
+      if (!_al_kcm_set_decoder_playing(spl, val))
+         return false;
+      if (was_playing && !val && spl->stop_callback) {
+         maybe_lock_mutex(spl->mutex);
+         spl->stop_callback(spl, spl->stop_callback_data);
+         maybe_unlock_mutex(spl->mutex);
+      }
+      return true;
+   }
+
    if (!spl->parent.u.ptr || !spl->spl_data.buffer.ptr) {
       spl->is_playing = val;
       return true;
@@ -556,9 +595,13 @@ bool al_set_sample_instance_playing(ALLEGRO_SAMPLE_INSTANCE *spl, bool val)
 
    /* parent is mixer */
    maybe_lock_mutex(spl->mutex);
+   was_playing = spl->is_playing;
    spl->is_playing = val;
-   if (!val)
+   if (!val) {
       spl->pos = 0;
+      if (was_playing && spl->stop_callback)
+         spl->stop_callback(spl, spl->stop_callback_data);
+   }
    maybe_unlock_mutex(spl->mutex);
    return true;
 }
@@ -598,23 +641,45 @@ bool al_set_sample(ALLEGRO_SAMPLE_INSTANCE *spl, ALLEGRO_SAMPLE *data)
       if (spl->parent.u.ptr) {
          _al_kcm_detach_from_parent(spl);
       }
+      _al_kcm_set_sample_decoder(spl, NULL);
       spl->spl_data.buffer.ptr = NULL;
+      spl->spl_data.adpcm = NULL;
+      spl->spl_data.compressed = NULL;
       return true;
    }
 
    /* Have data. */
 
+   if (data->compressed && spl->parent.u.ptr && spl->parent.is_voice) {
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "Compressed samples must be played through a mixer");
+      return false;
+   }
+
    need_reattach = false;
    if (spl->parent.u.ptr != NULL) {
       if (spl->spl_data.frequency != data->frequency ||
             spl->spl_data.depth != data->depth ||
-            spl->spl_data.chan_conf != data->chan_conf) {
+            spl->spl_data.chan_conf != data->chan_conf ||
+            !spl->spl_data.adpcm != !data->adpcm ||
+            !spl->spl_data.compressed != !data->compressed) {
          old_parent = spl->parent;
          need_reattach = true;
          _al_kcm_detach_from_parent(spl);
       }
    }
 
+   if (!_al_kcm_prepare_adpcm_cache(spl, data) ||
+         !_al_kcm_set_sample_decoder(spl, data)) {
+      if (spl->parent.u.ptr)
+         _al_kcm_detach_from_parent(spl);
+      _al_kcm_set_sample_decoder(spl, NULL);
+      spl->spl_data.buffer.ptr = NULL;
+      spl->spl_data.adpcm = NULL;
+      spl->spl_data.compressed = NULL;
+      return false;
+   }
+
    spl->spl_data = *data;
    spl->spl_data.free_buf = false;
    spl->pos = 0;
@@ -622,6 +687,11 @@ bool al_set_sample(ALLEGRO_SAMPLE_INSTANCE *spl, ALLEGRO_SAMPLE *data)
    spl->loop_end = data->len;
    /* Should we reset the loop mode? */
 
+   /* Still attached to the same mixer, which may read a converted copy. */
+   if (spl->parent.u.ptr && !spl->parent.is_voice) {
+      spl->converted = _al_kcm_mixer_convert_sample(spl->parent.u.mixer, spl);
+   }
+
    if (need_reattach) {
       if (old_parent.is_voice) {
          if (!al_attach_sample_instance_to_voice(spl, old_parent.u.voice)) {
@@ -8,8 +8,16 @@
 /* Title: Mixer functions
  */
 
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "allegro5/allegro_audio.h"
 #include "allegro5/internal/aintern.h"
@@ -19,14 +27,6 @@
 ALLEGRO_DEBUG_CHANNEL("audio")
 
 
-typedef union {
-   float f32[ALLEGRO_MAX_CHANNELS]; /* max: 7.1 */
-   int16_t s16[ALLEGRO_MAX_CHANNELS];
-   void *ptr;
-} SAMP_BUF;
-
-
-
 static void maybe_lock_mutex(ALLEGRO_MUTEX *mutex)
 {
    if (mutex) {
@@ -44,23 +44,20 @@ static void maybe_unlock_mutex(ALLEGRO_MUTEX *mutex)
 
 
 /* _al_rechannel_matrix:
- *  This function provides a (temporary!) matrix that can be used to convert
- *  one channel configuration into another.
- *
- *  Returns a pointer to a statically allocated array.
+ *  This function fills in a matrix that can be used to convert one channel
+ *  configuration into another.  It may be called from the mixing threads, so
+ *  it works on the caller's storage.
  */
-static float *_al_rechannel_matrix(ALLEGRO_CHANNEL_CONF orig,
-   ALLEGRO_CHANNEL_CONF target, float gain, float pan)
+static void _al_rechannel_matrix(ALLEGRO_CHANNEL_CONF orig,
+   ALLEGRO_CHANNEL_CONF target, float gain, float pan,
+   float mat[ALLEGRO_MAX_CHANNELS][ALLEGRO_MAX_CHANNELS])
 {
-   /* Max 7.1 (8 channels) for input and output */
-   static float mat[ALLEGRO_MAX_CHANNELS][ALLEGRO_MAX_CHANNELS];
-
    size_t dst_chans = al_get_channel_count(target);
    size_t src_chans = al_get_channel_count(orig);
    size_t i, j;
 
    /* Start with a simple identity matrix */
-   memset(mat, 0, sizeof(mat));
+   memset(mat, 0, sizeof(float) * ALLEGRO_MAX_CHANNELS * ALLEGRO_MAX_CHANNELS);
    for (i = 0; i < src_chans && i < dst_chans; i++) {
       mat[i][i] = 1.0;
    }
@@ -128,8 +125,6 @@ static float *_al_rechannel_matrix(ALLEGRO_CHANNEL_CONF orig,
       }
    }
 #endif
-
-   return &mat[0][0];
 }
 
 
@@ -140,25 +135,93 @@ static float *_al_rechannel_matrix(ALLEGRO_CHANNEL_CONF orig,
 void _al_kcm_mixer_rejig_sample_matrix(ALLEGRO_MIXER *mixer,
    ALLEGRO_SAMPLE_INSTANCE *spl)
 {
-   float *mat;
+   /* Max 7.1 (8 channels) for input and output */
+   float mat[ALLEGRO_MAX_CHANNELS][ALLEGRO_MAX_CHANNELS];
    size_t dst_chans;
    size_t src_chans;
    size_t i, j;
+   float loudest = 0.0f;
 
-   mat = _al_rechannel_matrix(spl->spl_data.chan_conf,
-      mixer->ss.spl_data.chan_conf, spl->gain, spl->pan);
+   _al_rechannel_matrix(spl->spl_data.chan_conf,
+      mixer->ss.spl_data.chan_conf, spl->gain, spl->pan, mat);
 
    dst_chans = al_get_channel_count(mixer->ss.spl_data.chan_conf);
    src_chans = al_get_channel_count(spl->spl_data.chan_conf);
 
+   /* Leave room for the matrix to ramp from. */
    if (!spl->matrix)
-      spl->matrix = al_calloc(1, src_chans * dst_chans * sizeof(float));
+      spl->matrix = al_calloc(2, src_chans * dst_chans * sizeof(float));
 
    for (i = 0; i < dst_chans; i++) {
       for (j = 0; j < src_chans; j++) {
-         spl->matrix[i*src_chans + j] = mat[i*ALLEGRO_MAX_CHANNELS + j];
+         spl->matrix[i*src_chans + j] = mat[i][j];
+         if (fabsf(mat[i][j]) > loudest)
+            loudest = fabsf(mat[i][j]);
       }
    }
+
+   spl->is_inaudible = (loudest <= mixer->virtual_threshold);
+}
+
+
+/* _al_kcm_mixer_set_step:
+ *  Recompute the step of a sample attached to a mixer from its speed,
+ *  going forwards for a positive speed.  The caller must be holding the
+ *  mixer mutex, or be the mixer.
+ */
+void _al_kcm_mixer_set_step(ALLEGRO_MIXER *mixer,
+   ALLEGRO_SAMPLE_INSTANCE *spl)
+{
+   spl->step = (spl->spl_data.frequency) * spl->speed;
+   spl->step_denom = mixer->ss.spl_data.frequency;
+   /* Don't want to be trapped with a step value of 0. */
+   if (spl->step == 0) {
+      if (spl->speed > 0.0f)
+         spl->step = 1;
+      else
+         spl->step = -1;
+   }
+   spl->applied_speed = spl->speed;
+}
+
+
+/* update_instance_params:
+ *  Picks up the gain, pan and speed changes made since the last read of an
+ *  instance.  Returns true if the matrix is to be ramped from the previous
+ *  one, which is kept after it, over this read.
+ */
+static bool update_instance_params(ALLEGRO_SAMPLE_INSTANCE *spl)
+{
+   ALLEGRO_MIXER *mixer = spl->parent.u.mixer;
+   const _AL_ATOMIC serial = _al_atomic_load(&spl->param_serial);
+   size_t size;
+
+   if (serial == spl->applied_serial)
+      return false;
+   spl->applied_serial = serial;
+
+   if (spl->speed != spl->applied_speed) {
+      /* A bidirectional loop may be on its way back; keep it going the
+       * same way.
+       */
+      const bool reversed = (spl->loop == ALLEGRO_PLAYMODE_BIDIR) &&
+         ((spl->step < 0) != (spl->applied_speed < 0.0f));
+
+      _al_kcm_mixer_set_step(mixer, spl);
+      if (reversed)
+         spl->step = -spl->step;
+   }
+
+   if (!mixer->ramp_params) {
+      _al_kcm_mixer_rejig_sample_matrix(mixer, spl);
+      return false;
+   }
+
+   size = al_get_channel_count(spl->spl_data.chan_conf) *
+      al_get_channel_count(mixer->ss.spl_data.chan_conf);
+   memcpy(spl->matrix + size, spl->matrix, size * sizeof(float));
+   _al_kcm_mixer_rejig_sample_matrix(mixer, spl);
+   return true;
 }
 
 
@@ -170,6 +233,7 @@ void _al_kcm_mixer_rejig_sample_matrix(ALLEGRO_MIXER *mixer,
 static bool fix_looped_position(ALLEGRO_SAMPLE_INSTANCE *spl)
 {
    bool is_empty;
+   bool had_buffer;
    ALLEGRO_AUDIO_STREAM *stream;
 
    /* Looping! Should be mostly self-explanatory */
@@ -220,6 +284,8 @@ static bool fix_looped_position(ALLEGRO_SAMPLE_INSTANCE *spl)
          }
          spl->pos = 0;
          spl->is_playing = false;
+         if (spl->stop_callback)
+            spl->stop_callback(spl, spl->stop_callback_data);
          return false;
 
       case _ALLEGRO_PLAYMODE_STREAM_ONCE:
@@ -228,9 +294,24 @@ static bool fix_looped_position(ALLEGRO_SAMPLE_INSTANCE *spl)
             return true;
          }
          stream = (ALLEGRO_AUDIO_STREAM *)spl;
+         had_buffer = (spl->spl_data.buffer.ptr != NULL);
          is_empty = !_al_kcm_refill_stream(stream);
          if (is_empty && stream->is_draining) {
             stream->spl.is_playing = false;
+            if (spl->stop_callback)
+               spl->stop_callback(spl, spl->stop_callback_data);
+            if (stream->fed_by_pool && stream->quit_feed_thread) {
+               /* The feeder pool left the stream to drain. */
+               ALLEGRO_EVENT event;
+               stream->is_draining = false;
+               event.user.type = ALLEGRO_EVENT_AUDIO_STREAM_FINISHED;
+               event.user.timestamp = al_get_time();
+               al_emit_user_event(&stream->spl.es, &event, NULL);
+            }
+         }
+         else if (is_empty && had_buffer) {
+            stream->stats.underruns++;
+            spl->parent.u.mixer->stats.underruns++;
          }
 
          _al_kcm_emit_stream_events(stream);
@@ -243,363 +324,1686 @@ static bool fix_looped_position(ALLEGRO_SAMPLE_INSTANCE *spl)
 }
 
 
-#include "kcm_mixer_helpers.inc"
+/* Windowed-sinc interpolation.
+ *
+ * The filter is tabulated for SINC_PHASES fractional positions between two
+ * sample values.  Tap k of a phase weighs the sample value k - SINC_TAPS/2 + 1
+ * frames away from the current position.
+ *
+ * A sample played back faster than the mixer frequency has to be filtered
+ * below the mixer's Nyquist frequency rather than its own, so there is one
+ * table for each of a few bands of steps, with the cutoff lowered by the
+ * corresponding factor of sinc_band_scale.
+ */
+#define SINC_TAPS       _AL_KCM_SINC_TAPS
+#define SINC_PHASES     256
+#define SINC_BANDS      5
+#define SINC_CUTOFF     0.45  /* of the sample frequency */
+#define SINC_KAISER     7.0   /* beta of the Kaiser window */
+
+static const double sinc_band_scale[SINC_BANDS] = {
+   1.0, 0.75, 0.5, 0.375, 0.25
+};
 
+static float sinc_table[SINC_BANDS][SINC_PHASES][SINC_TAPS];
+static bool sinc_table_ready = false;
 
-static INLINE int32_t clamp(int32_t val, int32_t min, int32_t max)
+
+/* Zeroth order modified Bessel function of the first kind. */
+static double bessel_i0(double x)
 {
-   /* Clamp to min */
-   val -= min;
-   val &= (~val) >> 31;
-   val += min;
+   double sum = 1.0;
+   double term = 1.0;
+   int k;
 
-   /* Clamp to max */
-   val -= max;
-   val &= val >> 31;
-   val += max;
+   for (k = 1; k < 32; k++) {
+      term *= (x / (2.0 * k)) * (x / (2.0 * k));
+      sum += term;
+   }
 
-   return val;
+   return sum;
 }
 
 
-/* Mix as many sample values as possible from the source sample into a mixer
- * buffer.  Implements stream_reader_t.
- *
- * TYPE is the type of the sample values in the mixer buffer, and
- * NEXT_SAMPLE_VALUE must return a buffer of the same type.
- * 
- * Note: Uses Bresenham to keep the precise sample position.
+/* init_sinc_table:
+ *  Fill in the polyphase filter tables.  Each phase is normalised to unity
+ *  gain so that a constant signal passes through unchanged.
  */
-#define BRESENHAM                                                             \
-   do {                                                                       \
-      delta = spl->step > 0 ? spl->step : spl->step - spl->step_denom + 1;    \
-      delta /= spl->step_denom;                                               \
-      delta_error = spl->step - delta * spl->step_denom;                      \
-   } while (0)
+static void init_sinc_table(void)
+{
+   const double half = SINC_TAPS / 2.0;
+   int band, phase, k;
 
-#define MAKE_MIXER(NAME, NEXT_SAMPLE_VALUE, TYPE)                             \
-static void NAME(void *source, void **vbuf, unsigned int *samples,            \
-   ALLEGRO_AUDIO_DEPTH buffer_depth, size_t dest_maxc)                        \
-{                                                                             \
-   ALLEGRO_SAMPLE_INSTANCE *spl = (ALLEGRO_SAMPLE_INSTANCE *)source;          \
-   TYPE *buf = *vbuf;                                                         \
-   size_t maxc = al_get_channel_count(spl->spl_data.chan_conf);               \
-   size_t samples_l = *samples;                                               \
-   size_t c;                                                                  \
-   int delta, delta_error;                                                    \
-   SAMP_BUF samp_buf;                                                         \
-                                                                              \
-   BRESENHAM;                                                                 \
-                                                                              \
-   if (!spl->is_playing)                                                      \
-      return;                                                                 \
-                                                                              \
-   while (samples_l > 0) {                                                    \
-      const TYPE *s;                                                          \
-      int old_step = spl->step;                                               \
-                                                                              \
-      if (!fix_looped_position(spl))                                          \
-         return;                                                              \
-      if (old_step != spl->step) {                                            \
-         BRESENHAM;                                                           \
-      }                                                                       \
-                                                                              \
-      /* It might be worth preparing multiple sample values at once. */       \
-      s = (TYPE *) NEXT_SAMPLE_VALUE(&samp_buf, spl, maxc);                   \
-                                                                              \
-      for (c = 0; c < dest_maxc; c++) {                                       \
-         ALLEGRO_STATIC_ASSERT(kcm_mixer, ALLEGRO_MAX_CHANNELS == 8);         \
-         switch (maxc) {                                                      \
-            /* Each case falls through. */                                    \
-            case 8: *buf += s[7] * spl->matrix[c*maxc + 7];                   \
-            case 7: *buf += s[6] * spl->matrix[c*maxc + 6];                   \
-            case 6: *buf += s[5] * spl->matrix[c*maxc + 5];                   \
-            case 5: *buf += s[4] * spl->matrix[c*maxc + 4];                   \
-            case 4: *buf += s[3] * spl->matrix[c*maxc + 3];                   \
-            case 3: *buf += s[2] * spl->matrix[c*maxc + 2];                   \
-            case 2: *buf += s[1] * spl->matrix[c*maxc + 1];                   \
-            case 1: *buf += s[0] * spl->matrix[c*maxc + 0];                   \
-            default: break;                                                   \
-         }                                                                    \
-         buf++;                                                               \
-      }                                                                       \
-                                                                              \
-      spl->pos += delta;                                                      \
-      spl->pos_bresenham_error += delta_error;                                \
-      if (spl->pos_bresenham_error >= spl->step_denom) {                      \
-         spl->pos++;                                                          \
-         spl->pos_bresenham_error -= spl->step_denom;                         \
-      }                                                                       \
-      samples_l--;                                                            \
-   }                                                                          \
-   fix_looped_position(spl);                                                  \
-   (void)buffer_depth;                                                        \
+   if (sinc_table_ready)
+      return;
+
+   for (band = 0; band < SINC_BANDS; band++) {
+      const double cutoff = SINC_CUTOFF * sinc_band_scale[band];
+
+      for (phase = 0; phase < SINC_PHASES; phase++) {
+         double frac = (double)phase / SINC_PHASES;
+         double sum = 0.0;
+         double h[SINC_TAPS];
+
+         for (k = 0; k < SINC_TAPS; k++) {
+            double x = (k - (SINC_TAPS/2 - 1)) - frac;
+            double w = x / half;
+            double y = 2.0 * cutoff * x;
+            double s = (y == 0.0) ? 1.0 : sin(ALLEGRO_PI * y) / (ALLEGRO_PI * y);
+
+            w = (w * w < 1.0) ? bessel_i0(SINC_KAISER * sqrt(1.0 - w * w)) : 0.0;
+            h[k] = s * w / bessel_i0(SINC_KAISER);
+            sum += h[k];
+         }
+
+         for (k = 0; k < SINC_TAPS; k++) {
+            sinc_table[band][phase][k] = h[k] / sum;
+         }
+      }
+   }
+
+   sinc_table_ready = true;
 }
 
-MAKE_MIXER(read_to_mixer_point_float_32, point_spl32, float)
-MAKE_MIXER(read_to_mixer_linear_float_32, linear_spl32, float)
-MAKE_MIXER(read_to_mixer_cubic_float_32, cubic_spl32, float)
-MAKE_MIXER(read_to_mixer_point_int16_t_16, point_spl16, int16_t)
-MAKE_MIXER(read_to_mixer_linear_int16_t_16, linear_spl16, int16_t)
 
-#undef MAKE_MIXER
+/* sinc_band:
+ *  Return the table to filter the sample instance with: the one with the
+ *  highest cutoff that still lies below the mixer's Nyquist frequency, or
+ *  the lowest one for steps above 1 / sinc_band_scale[SINC_BANDS - 1].
+ */
+static int sinc_band(const ALLEGRO_SAMPLE_INSTANCE *spl)
+{
+   const double step = fabs((double)spl->step / spl->step_denom);
+   int band = 0;
 
+   while (band < SINC_BANDS - 1 && step * sinc_band_scale[band] > 1.0)
+      band++;
 
-/* _al_kcm_mixer_read:
- *  Mixes the streams attached to the mixer and writes additively to the
- *  specified buffer (or if *buf is NULL, indicating a voice, convert it and
- *  set it to the buffer pointer).
+   return band;
+}
+
+
+/* sinc_tap_position:
+ *  Map a tap position which lies outside the playable range back into it.
+ *  Returns -1 if the tap should read silence.
  */
-void _al_kcm_mixer_read(void *source, void **buf, unsigned int *samples,
-   ALLEGRO_AUDIO_DEPTH buffer_depth, size_t dest_maxc)
+static int sinc_tap_position(const ALLEGRO_SAMPLE_INSTANCE *spl, int q)
 {
-   const ALLEGRO_MIXER *mixer;
-   ALLEGRO_MIXER *m = (ALLEGRO_MIXER *)source;
-   int maxc = al_get_channel_count(m->ss.spl_data.chan_conf);
-   int samples_l = *samples;
-   int i;
+   int span;
 
-   if (!m->ss.is_playing)
-      return;
+   switch (spl->loop) {
+      case ALLEGRO_PLAYMODE_ONCE:
+         return (q >= 0 && q < spl->spl_data.len) ? q : -1;
 
-   /* Make sure the mixer buffer is big enough. */
-   if (m->ss.spl_data.len*maxc < samples_l*maxc) {
-      al_free(m->ss.spl_data.buffer.ptr);
-      m->ss.spl_data.buffer.ptr = al_malloc(samples_l*maxc*al_get_audio_depth_size(m->ss.spl_data.depth));
-      if (!m->ss.spl_data.buffer.ptr) {
-         _al_set_error(ALLEGRO_GENERIC_ERROR,
-            "Out of memory allocating mixer buffer");
-         m->ss.spl_data.len = 0;
-         return;
-      }
-      m->ss.spl_data.len = samples_l;
+      case ALLEGRO_PLAYMODE_LOOP:
+      case ALLEGRO_PLAYMODE_BIDIR:
+         /* Bidirectional loops should really bounce, but the difference
+          * is confined to the filter tails.
+          */
+         span = spl->loop_end - spl->loop_start;
+         if (span <= 0)
+            return -1;
+         if (q < spl->loop_start)
+            q += ((spl->loop_start - q + span - 1) / span) * span;
+         else if (q >= spl->loop_end)
+            q -= ((q - spl->loop_end) / span + 1) * span;
+         return q;
+
+      case _ALLEGRO_PLAYMODE_STREAM_ONCE:
+      case _ALLEGRO_PLAYMODE_STREAM_ONEDIR:
+         return q;
    }
 
-   mixer = m;
+   ASSERT(false);
+   return -1;
+}
 
-   /* Clear the buffer to silence. */
-   memset(mixer->ss.spl_data.buffer.ptr, 0, samples_l * maxc * al_get_audio_depth_size(mixer->ss.spl_data.depth));
 
-   /* Mix the streams into the mixer buffer. */
-   for (i = _al_vector_size(&mixer->streams) - 1; i >= 0; i--) {
-      ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&mixer->streams, i);
-      ALLEGRO_SAMPLE_INSTANCE *spl = *slot;
-      ASSERT(spl->spl_read);
-      spl->spl_read(spl, (void **) &mixer->ss.spl_data.buffer.ptr, samples,
-         m->ss.spl_data.depth, maxc);
-   }
+static INLINE float sinc_dot(const float *x, const float *h)
+{
+#ifdef __SSE__
+   __m128 acc = _mm_mul_ps(_mm_loadu_ps(x), _mm_loadu_ps(h));
+   float r[4];
+   int k;
 
-   /* Call the post-processing callback. */
-   if (mixer->postprocess_callback) {
-      mixer->postprocess_callback(mixer->ss.spl_data.buffer.ptr,
-         *samples, mixer->pp_callback_userdata);
+   for (k = 4; k < SINC_TAPS; k += 4) {
+      acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(x + k), _mm_loadu_ps(h + k)));
+   }
+   _mm_storeu_ps(r, acc);
+   return (r[0] + r[1]) + (r[2] + r[3]);
+#else
+   float s = 0.0f;
+   int k;
+
+   for (k = 0; k < SINC_TAPS; k++) {
+      s += x[k] * h[k];
    }
+   return s;
+#endif
+}
 
-   samples_l *= maxc;
 
-   /* Apply the gain if necessary. */
-   if (mixer->ss.gain != 1.0f) {
-      float mixer_gain = mixer->ss.gain;
-      unsigned long i = samples_l;
+static INLINE int16_t sinc_to_s16(float s)
+{
+   /* The filter can overshoot full scale slightly. */
+   if (s > 32767.0f)
+      return 32767;
+   if (s < -32768.0f)
+      return -32768;
+   return (int16_t)s;
+}
 
-      switch (m->ss.spl_data.depth) {
-         case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
-            float *p = mixer->ss.spl_data.buffer.f32;
-            while (i-- > 0) {
-               *p++ *= mixer_gain;
-            }
-            break;
-         }
 
-         case ALLEGRO_AUDIO_DEPTH_INT16: {
-            int16_t *p = mixer->ss.spl_data.buffer.s16;
-            while (i-- > 0) {
-               *p++ *= mixer_gain;
-            }
-            break;
-         }
+#include "kcm_mixer_helpers.inc"
 
-         case ALLEGRO_AUDIO_DEPTH_INT8:
-         case ALLEGRO_AUDIO_DEPTH_INT24:
-         case ALLEGRO_AUDIO_DEPTH_UINT8:
-         case ALLEGRO_AUDIO_DEPTH_UINT16:
-         case ALLEGRO_AUDIO_DEPTH_UINT24:
-            /* Unsupported mixer depths. */
-            ASSERT(false);
-            break;
+
+/* Readers for ADPCM compressed samples (see kcm_adpcm.c), matching the ones
+ * above for 16-bit sample data.  The frames come from the two blocks the
+ * instance decoded last; between them they hold both frames interpolated
+ * across a block boundary or a loop point, so each block is decoded once
+ * per pass.
+ */
+static INLINE const int16_t *adpcm_frame(ALLEGRO_SAMPLE_INSTANCE *spl,
+   int pos)
+{
+   ADPCM_CACHE *cache = spl->adpcm_cache;
+   const int spb = spl->spl_data.adpcm->samples_per_block;
+   const int block = pos / spb;
+   const int offset = (pos - block * spb) * cache->channels;
+
+   if (block == cache->block[cache->last])
+      return cache->pcm[cache->last] + offset;
+   if (block == cache->block[!cache->last]) {
+      cache->last = !cache->last;
+      return cache->pcm[cache->last] + offset;
+   }
+   return _al_kcm_decode_adpcm_frame(spl, pos);
+}
+
+
+static void adpcm_loop_points(const ALLEGRO_SAMPLE_INSTANCE *spl,
+   int *hi, int *hi_to)
+{
+   switch (spl->loop) {
+      case ALLEGRO_PLAYMODE_LOOP:
+         *hi = spl->loop_end;
+         *hi_to = spl->loop_start;
+         break;
+      case ALLEGRO_PLAYMODE_BIDIR:
+         *hi = spl->loop_end;
+         *hi_to = spl->loop_end - 1;
+         if (*hi_to < spl->loop_start)
+            *hi_to = spl->loop_start;
+         break;
+      default:
+         *hi = spl->spl_data.len;
+         *hi_to = spl->spl_data.len - 1;
+         break;
+   }
+}
+
+
+static void adpcm_point_spl32(float *dst, ALLEGRO_SAMPLE_INSTANCE *spl,
+   unsigned int maxc, unsigned int n, int delta, int delta_error)
+{
+   const int step_denom = spl->step_denom;
+   int pos = spl->pos;
+   int err = spl->pos_bresenham_error;
+   unsigned int f, i;
+
+   for (f = 0; f < n; f++) {
+      const int16_t *x = adpcm_frame(spl, pos);
+      for (i = 0; i < maxc; i++) {
+         dst[i] = (float) x[i] / ((float)0x7FFF + 0.5f);
+      }
+      dst += maxc;
+      pos += delta;
+      err += delta_error;
+      if (err >= step_denom) {
+         pos++;
+         err -= step_denom;
       }
    }
 
-   /* Feeding to a non-voice.
-    * Currently we only support mixers of the same audio depth doing this.
-    */
-   if (*buf) {
-      switch (m->ss.spl_data.depth) {
-         case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
-            /* We don't need to clamp in the mixer yet. */
-            float *lbuf = *buf;
-            float *src = mixer->ss.spl_data.buffer.f32;
-            while (samples_l-- > 0) {
-               *lbuf += *src;
-               lbuf++;
-               src++;
-            }
-            break;
+   spl->pos = pos;
+   spl->pos_bresenham_error = err;
+}
 
-         case ALLEGRO_AUDIO_DEPTH_INT16: {
-            int16_t *lbuf = *buf;
-            int16_t *src = mixer->ss.spl_data.buffer.s16;
-            while (samples_l-- > 0) {
-               int32_t x = *lbuf + *src;
-               if (x < -32768)
-                  x = -32768;
-               else if (x > 32767)
-                  x = 32767;
-               *lbuf = (int16_t)x;
-               lbuf++;
-               src++;
-            }
-            break;
-         }
 
-         case ALLEGRO_AUDIO_DEPTH_INT8:
-         case ALLEGRO_AUDIO_DEPTH_INT24:
-         case ALLEGRO_AUDIO_DEPTH_UINT8:
-         case ALLEGRO_AUDIO_DEPTH_UINT16:
-         case ALLEGRO_AUDIO_DEPTH_UINT24:
-            /* Unsupported mixer depths. */
-            ASSERT(false);
-            break;
-         }
+static void adpcm_linear_spl32(float *dst, ALLEGRO_SAMPLE_INSTANCE *spl,
+   unsigned int maxc, unsigned int n, int delta, int delta_error)
+{
+   const int step_denom = spl->step_denom;
+   int pos = spl->pos;
+   int err = spl->pos_bresenham_error;
+   int hi, hi_to;
+   unsigned int f, i;
+
+   adpcm_loop_points(spl, &hi, &hi_to);
+
+   for (f = 0; f < n; f++) {
+      const float t = (float)err / step_denom;
+      const int p1 = pos + 1 < hi ? pos + 1 : hi_to;
+      const int16_t *x0 = adpcm_frame(spl, pos);
+      const int16_t *x1 = adpcm_frame(spl, p1);
+      for (i = 0; i < maxc; i++) {
+         const float a = (float) x0[i] / ((float)0x7FFF + 0.5f);
+         const float b = (float) x1[i] / ((float)0x7FFF + 0.5f);
+         dst[i] = (a * (1.0f - t)) + (b * t);
+      }
+      dst += maxc;
+      pos += delta;
+      err += delta_error;
+      if (err >= step_denom) {
+         pos++;
+         err -= step_denom;
       }
-      return;
    }
 
-   /* We're feeding to a voice.
-    * Clamp and convert the mixed data for the voice.
-    */
-   *buf = mixer->ss.spl_data.buffer.ptr;
-   switch (buffer_depth & ~ALLEGRO_AUDIO_DEPTH_UNSIGNED) {
+   spl->pos = pos;
+   spl->pos_bresenham_error = err;
+}
 
-      case ALLEGRO_AUDIO_DEPTH_FLOAT32:
-         /* Do we need to clamp? */
-         break;
 
-      case ALLEGRO_AUDIO_DEPTH_INT24:
-         switch (mixer->ss.spl_data.depth) {
-            case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
-               int32_t off = ((buffer_depth & ALLEGRO_AUDIO_DEPTH_UNSIGNED)
-                              ? 0x800000 : 0);
-               int32_t *lbuf = mixer->ss.spl_data.buffer.s24;
-               float *src = mixer->ss.spl_data.buffer.f32;
-
-               while (samples_l > 0) {
-                  *lbuf = clamp(*(src++) * ((float)0x7FFFFF + 0.5f),
-                     ~0x7FFFFF, 0x7FFFFF);
-                  *lbuf += off;
-                  lbuf++;
-                  samples_l--;
-               }
-               break;
-            }
+static void adpcm_point_spl16(int16_t *dst, ALLEGRO_SAMPLE_INSTANCE *spl,
+   unsigned int maxc, unsigned int n, int delta, int delta_error)
+{
+   const int step_denom = spl->step_denom;
+   int pos = spl->pos;
+   int err = spl->pos_bresenham_error;
+   unsigned int f, i;
+
+   for (f = 0; f < n; f++) {
+      const int16_t *x = adpcm_frame(spl, pos);
+      for (i = 0; i < maxc; i++) {
+         dst[i] = x[i];
+      }
+      dst += maxc;
+      pos += delta;
+      err += delta_error;
+      if (err >= step_denom) {
+         pos++;
+         err -= step_denom;
+      }
+   }
 
-            case ALLEGRO_AUDIO_DEPTH_INT16:
-               /* XXX not yet implemented */
-               ASSERT(false);
-               break;
+   spl->pos = pos;
+   spl->pos_bresenham_error = err;
+}
 
-            case ALLEGRO_AUDIO_DEPTH_INT8:
-            case ALLEGRO_AUDIO_DEPTH_INT24:
-            case ALLEGRO_AUDIO_DEPTH_UINT8:
-            case ALLEGRO_AUDIO_DEPTH_UINT16:
-            case ALLEGRO_AUDIO_DEPTH_UINT24:
-               /* Unsupported mixer depths. */
-               ASSERT(false);
-               break;
-         }
-         break;
 
-      case ALLEGRO_AUDIO_DEPTH_INT16:
-         switch (mixer->ss.spl_data.depth) {
-            case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
-               int16_t off = ((buffer_depth & ALLEGRO_AUDIO_DEPTH_UNSIGNED)
-                              ? 0x8000 : 0);
-               int16_t *lbuf = mixer->ss.spl_data.buffer.s16;
-               float *src = mixer->ss.spl_data.buffer.f32;
-
-               while (samples_l > 0) {
-                  *lbuf = clamp(*(src++) * ((float)0x7FFF + 0.5f), ~0x7FFF, 0x7FFF);
-                  *lbuf += off;
-                  lbuf++;
-                  samples_l--;
-               }
-               break;
-            }
+static void adpcm_linear_spl16(int16_t *dst, ALLEGRO_SAMPLE_INSTANCE *spl,
+   unsigned int maxc, unsigned int n, int delta, int delta_error)
+{
+   const int step_denom = spl->step_denom;
+   int pos = spl->pos;
+   int err = spl->pos_bresenham_error;
+   int hi, hi_to;
+   unsigned int f, i;
+
+   adpcm_loop_points(spl, &hi, &hi_to);
+
+   for (f = 0; f < n; f++) {
+      const int32_t t = 256 * err / step_denom;
+      const int p1 = pos + 1 < hi ? pos + 1 : hi_to;
+      const int16_t *x0 = adpcm_frame(spl, pos);
+      const int16_t *x1 = adpcm_frame(spl, p1);
+      for (i = 0; i < maxc; i++) {
+         const int32_t a = x0[i];
+         const int32_t b = x1[i];
+         dst[i] = (int16_t)(((a * (256 - t))>>8) + ((b * t)>>8));
+      }
+      dst += maxc;
+      pos += delta;
+      err += delta_error;
+      if (err >= step_denom) {
+         pos++;
+         err -= step_denom;
+      }
+   }
+
+   spl->pos = pos;
+   spl->pos_bresenham_error = err;
+}
+
+
+/* frames_before_boundary:
+ *  Returns how many frames, up to `max', can be read starting from the
+ *  current position before fix_looped_position needs to be consulted again.
+ *  Each frame advances the position by `delta' or `delta + 1', so the count
+ *  is conservative.  Returns 1 for the cases where we would rather check
+ *  every frame.
+ */
+static size_t frames_before_boundary(const ALLEGRO_SAMPLE_INSTANCE *spl,
+   int delta, size_t max)
+{
+   bool looping = (spl->loop == ALLEGRO_PLAYMODE_LOOP ||
+      spl->loop == ALLEGRO_PLAYMODE_BIDIR);
+   size_t n;
+
+   if (looping && spl->loop_end - spl->loop_start == 0)
+      return 1;
+
+   if (spl->step > 0) {
+      int end = looping ? spl->loop_end : spl->spl_data.len;
+      if (spl->pos >= end)
+         return 1;
+      n = (end - spl->pos - 1) / (delta + 1) + 1;
+   }
+   else {
+      int start = looping ? spl->loop_start : 0;
+      if (spl->pos < start || (looping && spl->pos >= spl->loop_end))
+         return 1;
+      n = (spl->pos - start) / -delta + 1;
+   }
+
+   return n < max ? n : max;
+}
+
+
+/* skip_frames:
+ *  Advances the position of a virtual voice by `n' frames, exactly as
+ *  reading them would have.
+ */
+static void skip_frames(ALLEGRO_SAMPLE_INSTANCE *spl, size_t n,
+   int delta, int delta_error)
+{
+   int64_t err = spl->pos_bresenham_error + (int64_t)n * delta_error;
+
+   spl->pos += (int)n * delta + (int)(err / spl->step_denom);
+   spl->pos_bresenham_error = (int)(err % spl->step_denom);
+}
+
+
+/* Number of frames gathered from the source before they are mixed in. */
+#define MIXER_BLOCK_FRAMES    64
+
+
+/* mix_block_float:
+ *  Applies the rechannel matrix to a block of `n' interleaved frames and adds
+ *  the result to the mixer buffer.  The common mono/stereo cases get their
+ *  own loops with the matrix held in registers; the others go through the
+ *  generic per-channel switch.
+ *
+ *  The terms are added in the same order as the generic case so that every
+ *  path produces identical output.
+ */
+static void mix_block_float(float *buf, const float *s, size_t n,
+   size_t maxc, size_t dest_maxc, const float *matrix)
+{
+   size_t i = 0;
+   size_t c;
+
+   if (maxc == 1 && dest_maxc == 2) {
+      const float m0 = matrix[0];
+      const float m1 = matrix[1];
+#ifdef __SSE__
+      const __m128 mm = _mm_setr_ps(m0, m1, m0, m1);
+      for (; i + 4 <= n; i += 4) {
+         const __m128 x = _mm_loadu_ps(s + i);
+         const __m128 lo = _mm_unpacklo_ps(x, x);
+         const __m128 hi = _mm_unpackhi_ps(x, x);
+         _mm_storeu_ps(buf, _mm_add_ps(_mm_loadu_ps(buf), _mm_mul_ps(lo, mm)));
+         _mm_storeu_ps(buf + 4,
+            _mm_add_ps(_mm_loadu_ps(buf + 4), _mm_mul_ps(hi, mm)));
+         buf += 8;
+      }
+#endif
+      for (; i < n; i++) {
+         buf[0] += s[i] * m0;
+         buf[1] += s[i] * m1;
+         buf += 2;
+      }
+      return;
+   }
+
+   if (maxc == 2 && dest_maxc == 2) {
+      const float m00 = matrix[0], m01 = matrix[1];
+      const float m10 = matrix[2], m11 = matrix[3];
+#ifdef __SSE__
+      const __m128 ml = _mm_setr_ps(m00, m10, m00, m10);
+      const __m128 mr = _mm_setr_ps(m01, m11, m01, m11);
+      for (; i + 2 <= n; i += 2) {
+         const __m128 x = _mm_loadu_ps(s + i*2);
+         const __m128 l = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0));
+         const __m128 r = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1));
+         __m128 acc = _mm_loadu_ps(buf);
+         acc = _mm_add_ps(acc, _mm_mul_ps(r, mr));
+         acc = _mm_add_ps(acc, _mm_mul_ps(l, ml));
+         _mm_storeu_ps(buf, acc);
+         buf += 4;
+      }
+#endif
+      for (; i < n; i++) {
+         const float l = s[i*2 + 0];
+         const float r = s[i*2 + 1];
+         buf[0] += r * m01;
+         buf[0] += l * m00;
+         buf[1] += r * m11;
+         buf[1] += l * m10;
+         buf += 2;
+      }
+      return;
+   }
+
+   if (maxc == 1 && dest_maxc == 1) {
+      const float m0 = matrix[0];
+      for (; i < n; i++) {
+         buf[i] += s[i] * m0;
+      }
+      return;
+   }
+
+   for (; i < n; i++, s += maxc) {
+      for (c = 0; c < dest_maxc; c++) {
+         ALLEGRO_STATIC_ASSERT(kcm_mixer, ALLEGRO_MAX_CHANNELS == 8);
+         switch (maxc) {
+            case 8: *buf += s[7] * matrix[c*maxc + 7]; /* fall through */
+            case 7: *buf += s[6] * matrix[c*maxc + 6]; /* fall through */
+            case 6: *buf += s[5] * matrix[c*maxc + 5]; /* fall through */
+            case 5: *buf += s[4] * matrix[c*maxc + 4]; /* fall through */
+            case 4: *buf += s[3] * matrix[c*maxc + 3]; /* fall through */
+            case 3: *buf += s[2] * matrix[c*maxc + 2]; /* fall through */
+            case 2: *buf += s[1] * matrix[c*maxc + 1]; /* fall through */
+            case 1: *buf += s[0] * matrix[c*maxc + 0];
+            default: break;
+         }
+         buf++;
+      }
+   }
+}
+
+
+/* Adds a weighted sample value to an int16 mixer buffer value, saturating
+ * instead of wrapping around when the mixer overloads.
+ */
+static INLINE int16_t add_sat16(int16_t a, float x)
+{
+   const float v = a + x;
+
+   if (v >= 32767.0f)
+      return 32767;
+   if (v <= -32768.0f)
+      return -32768;
+   return (int16_t)v;
+}
+
+
+/* mix_block_int16_t:
+ *  Like mix_block_float for 16-bit mixers.  Each product is converted back
+ *  to int16_t as it is accumulated, exactly like the generic case.
+ */
+static void mix_block_int16_t(int16_t *buf, const int16_t *s, size_t n,
+   size_t maxc, size_t dest_maxc, const float *matrix)
+{
+   size_t i;
+   size_t c;
+
+   if (maxc == 1 && dest_maxc == 2) {
+      const float m0 = matrix[0];
+      const float m1 = matrix[1];
+      for (i = 0; i < n; i++) {
+         buf[0] = add_sat16(buf[0], s[i] * m0);
+         buf[1] = add_sat16(buf[1], s[i] * m1);
+         buf += 2;
+      }
+      return;
+   }
+
+   if (maxc == 2 && dest_maxc == 2) {
+      const float m00 = matrix[0], m01 = matrix[1];
+      const float m10 = matrix[2], m11 = matrix[3];
+      for (i = 0; i < n; i++) {
+         const int16_t l = s[i*2 + 0];
+         const int16_t r = s[i*2 + 1];
+         buf[0] = add_sat16(buf[0], r * m01);
+         buf[0] = add_sat16(buf[0], l * m00);
+         buf[1] = add_sat16(buf[1], r * m11);
+         buf[1] = add_sat16(buf[1], l * m10);
+         buf += 2;
+      }
+      return;
+   }
+
+   for (i = 0; i < n; i++, s += maxc) {
+      for (c = 0; c < dest_maxc; c++) {
+         switch (maxc) {
+            case 8: *buf = add_sat16(*buf, s[7] * matrix[c*maxc + 7]); /* fall through */
+            case 7: *buf = add_sat16(*buf, s[6] * matrix[c*maxc + 6]); /* fall through */
+            case 6: *buf = add_sat16(*buf, s[5] * matrix[c*maxc + 5]); /* fall through */
+            case 5: *buf = add_sat16(*buf, s[4] * matrix[c*maxc + 4]); /* fall through */
+            case 4: *buf = add_sat16(*buf, s[3] * matrix[c*maxc + 3]); /* fall through */
+            case 3: *buf = add_sat16(*buf, s[2] * matrix[c*maxc + 2]); /* fall through */
+            case 2: *buf = add_sat16(*buf, s[1] * matrix[c*maxc + 1]); /* fall through */
+            case 1: *buf = add_sat16(*buf, s[0] * matrix[c*maxc + 0]);
+            default: break;
+         }
+         buf++;
+      }
+   }
+}
+
+
+/* Like mix_block_TYPE, but moves the matrix linearly from the previous one
+ * to the current one over 'total' frames, of which 'done' have been mixed
+ * already.  Only used for the read after a gain or pan change.
+ */
+#define MAKE_RAMP_MIXER(TYPE, ADD)                                            \
+static void mix_block_ramp_##TYPE(TYPE *buf, const TYPE *s, size_t n,         \
+   size_t maxc, size_t dest_maxc, const float *matrix, size_t done,           \
+   size_t total)                                                              \
+{                                                                             \
+   const float *from = matrix + maxc * dest_maxc;                             \
+   size_t i, c, k;                                                            \
+                                                                              \
+   for (i = 0; i < n; i++, s += maxc) {                                       \
+      const float t = (float)(done + i + 1) / total;                          \
+      for (c = 0; c < dest_maxc; c++) {                                       \
+         for (k = 0; k < maxc; k++) {                                         \
+            const float m0 = from[c*maxc + k];                                \
+            const float m = m0 + (matrix[c*maxc + k] - m0) * t;               \
+            ADD(*buf, s[k] * m);                                              \
+         }                                                                    \
+         buf++;                                                               \
+      }                                                                       \
+   }                                                                          \
+}
+
+#define ADD_FLOAT(dst, x)  ((dst) += (x))
+#define ADD_INT16(dst, x)  ((dst) = add_sat16((dst), (x)))
+
+MAKE_RAMP_MIXER(float, ADD_FLOAT)
+MAKE_RAMP_MIXER(int16_t, ADD_INT16)
+
+#undef MAKE_RAMP_MIXER
+
+
+/* The same for planar mixers (see al_set_mixer_planar), whose buffer holds
+ * one plane of `stride' values per channel.  The terms of each output value
+ * are added in the same order as above, so the result is the same as mixing
+ * interleaved and deinterleaving afterwards.
+ */
+#define MAKE_PLANAR_MIXER(TYPE, ADD)                                          \
+static void mix_block_planar_generic_##TYPE(TYPE *buf, size_t stride,         \
+   const TYPE *s, size_t n, size_t maxc, size_t dest_maxc,                    \
+   const float *matrix)                                                       \
+{                                                                             \
+   size_t c, i, k;                                                            \
+                                                                              \
+   for (c = 0; c < dest_maxc; c++) {                                          \
+      TYPE *d = buf + c*stride;                                               \
+      for (i = 0; i < n; i++) {                                               \
+         k = maxc;                                                            \
+         while (k-- > 0) {                                                    \
+            ADD(d[i], s[i*maxc + k] * matrix[c*maxc + k]);                    \
+         }                                                                    \
+      }                                                                       \
+   }                                                                          \
+}                                                                             \
+                                                                              \
+static void mix_block_planar_ramp_##TYPE(TYPE *buf, size_t stride,            \
+   const TYPE *s, size_t n, size_t maxc, size_t dest_maxc,                    \
+   const float *matrix, size_t done, size_t total)                            \
+{                                                                             \
+   const float *from = matrix + maxc * dest_maxc;                             \
+   size_t i, c, k;                                                            \
+                                                                              \
+   for (c = 0; c < dest_maxc; c++) {                                          \
+      TYPE *d = buf + c*stride;                                               \
+      for (i = 0; i < n; i++) {                                               \
+         const float t = (float)(done + i + 1) / total;                       \
+         for (k = 0; k < maxc; k++) {                                         \
+            const float m0 = from[c*maxc + k];                                \
+            const float m = m0 + (matrix[c*maxc + k] - m0) * t;               \
+            ADD(d[i], s[i*maxc + k] * m);                                     \
+         }                                                                    \
+      }                                                                       \
+   }                                                                          \
+}
+
+MAKE_PLANAR_MIXER(float, ADD_FLOAT)
+MAKE_PLANAR_MIXER(int16_t, ADD_INT16)
+
+#undef ADD_FLOAT
+#undef ADD_INT16
+#undef MAKE_PLANAR_MIXER
+
+
+static void mix_block_planar_float(float *buf, size_t stride, const float *s,
+   size_t n, size_t maxc, size_t dest_maxc, const float *matrix)
+{
+   size_t c;
+
+   if (maxc > 2) {
+      mix_block_planar_generic_float(buf, stride, s, n, maxc, dest_maxc,
+         matrix);
+      return;
+   }
+
+   for (c = 0; c < dest_maxc; c++) {
+      const float *m = matrix + c*maxc;
+      float *d = buf + c*stride;
+      size_t i = 0;
+
+      if (maxc == 1) {
+         const float m0 = m[0];
+#ifdef __SSE__
+         const __m128 mm = _mm_set1_ps(m0);
+         for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(d + i, _mm_add_ps(_mm_loadu_ps(d + i),
+               _mm_mul_ps(_mm_loadu_ps(s + i), mm)));
+         }
+#endif
+         for (; i < n; i++) {
+            d[i] += s[i] * m0;
+         }
+         continue;
+      }
+
+      if (maxc == 2) {
+         const float m0 = m[0], m1 = m[1];
+#ifdef __SSE__
+         const __m128 ml = _mm_set1_ps(m0);
+         const __m128 mr = _mm_set1_ps(m1);
+         for (; i + 4 <= n; i += 4) {
+            const __m128 x0 = _mm_loadu_ps(s + i*2);
+            const __m128 x1 = _mm_loadu_ps(s + i*2 + 4);
+            const __m128 l = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 r = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+            __m128 acc = _mm_loadu_ps(d + i);
+            acc = _mm_add_ps(acc, _mm_mul_ps(r, mr));
+            acc = _mm_add_ps(acc, _mm_mul_ps(l, ml));
+            _mm_storeu_ps(d + i, acc);
+         }
+#endif
+         for (; i < n; i++) {
+            d[i] += s[i*2 + 1] * m1;
+            d[i] += s[i*2 + 0] * m0;
+         }
+      }
+   }
+}
+
+
+/* The 16-bit mixers have no fast paths. */
+#define mix_block_planar_int16_t mix_block_planar_generic_int16_t
+
+
+/* Mix as many sample values as possible from the source sample into a mixer
+ * buffer.  Implements stream_reader_t.
+ *
+ * TYPE is the type of the sample values in the mixer buffer, and
+ * READ_BLOCK must fill a block of frames of the same type, advancing the
+ * sample position (see kcm_mixer_helpers.inc).
+ *
+ * Blocks extend for as long as the position is known to stay clear of the
+ * loop points, then the whole block is passed through the matrix by
+ * mix_block_TYPE, or mix_block_planar_TYPE if the mixer is planar, in which
+ * case each plane of the buffer is `*samples' values long.
+ *
+ * Instances too quiet to hear (see virtual_threshold) are not read at all;
+ * their position is moved along by skip_frames, stopping at the same loop
+ * points, so that they carry on from the right place when they get louder.
+ * 
+ * Note: Uses Bresenham to keep the precise sample position.
+ */
+#define BRESENHAM                                                             \
+   do {                                                                       \
+      delta = spl->step > 0 ? spl->step : spl->step - spl->step_denom + 1;    \
+      delta /= spl->step_denom;                                               \
+      delta_error = spl->step - delta * spl->step_denom;                      \
+   } while (0)
+
+#define MAKE_MIXER(NAME, READ_BLOCK, TYPE)                                    \
+static void NAME(void *source, void **vbuf, unsigned int *samples,            \
+   ALLEGRO_AUDIO_DEPTH buffer_depth, size_t dest_maxc)                        \
+{                                                                             \
+   ALLEGRO_SAMPLE_INSTANCE *spl = (ALLEGRO_SAMPLE_INSTANCE *)source;          \
+   TYPE *buf = *vbuf;                                                         \
+   size_t maxc = al_get_channel_count(spl->spl_data.chan_conf);               \
+   size_t samples_l = *samples;                                               \
+   size_t done = 0;                                                           \
+   const bool planar = spl->parent.u.mixer->planar;                           \
+   int delta, delta_error;                                                    \
+   bool ramp;                                                                 \
+   TYPE block[MIXER_BLOCK_FRAMES * ALLEGRO_MAX_CHANNELS];                     \
+                                                                              \
+   if (!spl->is_playing)                                                      \
+      return;                                                                 \
+                                                                              \
+   ramp = update_instance_params(spl);                                        \
+   BRESENHAM;                                                                 \
+   spl->is_virtual = !ramp && spl->is_inaudible;                              \
+                                                                              \
+   while (samples_l > 0) {                                                    \
+      int old_step = spl->step;                                               \
+      size_t n;                                                               \
+                                                                              \
+      if (!fix_looped_position(spl))                                          \
+         return;                                                              \
+      if (old_step != spl->step) {                                            \
+         BRESENHAM;                                                           \
+      }                                                                       \
+                                                                              \
+      if (spl->is_virtual) {                                                  \
+         n = frames_before_boundary(spl, delta, samples_l);                   \
+         skip_frames(spl, n, delta, delta_error);                             \
+         samples_l -= n;                                                      \
+         continue;                                                            \
+      }                                                                       \
+                                                                              \
+      n = frames_before_boundary(spl, delta,                                  \
+         samples_l < MIXER_BLOCK_FRAMES ? samples_l : MIXER_BLOCK_FRAMES);    \
+      READ_BLOCK(block, spl, maxc, n, delta, delta_error);                    \
+                                                                              \
+      if (planar) {                                                           \
+         if (ramp) {                                                          \
+            mix_block_planar_ramp_##TYPE(buf, *samples, block, n, maxc,       \
+               dest_maxc, spl->matrix, done, *samples);                       \
+         }                                                                    \
+         else {                                                               \
+            mix_block_planar_##TYPE(buf, *samples, block, n, maxc,            \
+               dest_maxc, spl->matrix);                                       \
+         }                                                                    \
+         buf += n;                                                            \
+      }                                                                       \
+      else {                                                                  \
+         if (ramp) {                                                          \
+            mix_block_ramp_##TYPE(buf, block, n, maxc, dest_maxc,             \
+               spl->matrix, done, *samples);                                  \
+         }                                                                    \
+         else {                                                               \
+            mix_block_##TYPE(buf, block, n, maxc, dest_maxc, spl->matrix);    \
+         }                                                                    \
+         buf += n * dest_maxc;                                                \
+      }                                                                       \
+      samples_l -= n;                                                         \
+      done += n;                                                              \
+   }                                                                          \
+   fix_looped_position(spl);                                                  \
+   (void)buffer_depth;                                                        \
+}
+
+MAKE_MIXER(read_to_mixer_point_float_32, point_spl32, float)
+MAKE_MIXER(read_to_mixer_linear_float_32, linear_spl32, float)
+MAKE_MIXER(read_to_mixer_cubic_float_32, cubic_spl32, float)
+MAKE_MIXER(read_to_mixer_sinc_float_32, sinc_spl32, float)
+MAKE_MIXER(read_to_mixer_point_int16_t_16, point_spl16, int16_t)
+MAKE_MIXER(read_to_mixer_linear_int16_t_16, linear_spl16, int16_t)
+MAKE_MIXER(read_to_mixer_sinc_int16_t_16, sinc_spl16, int16_t)
+MAKE_MIXER(read_adpcm_to_mixer_point_float_32, adpcm_point_spl32, float)
+MAKE_MIXER(read_adpcm_to_mixer_linear_float_32, adpcm_linear_spl32, float)
+MAKE_MIXER(read_adpcm_to_mixer_point_int16_t_16, adpcm_point_spl16, int16_t)
+MAKE_MIXER(read_adpcm_to_mixer_linear_int16_t_16, adpcm_linear_spl16, int16_t)
+
+#undef MAKE_MIXER
+
+
+/* Sub-mixer worker pool.
+ *
+ * If the [audio] mixer_threads config value is set, the sub-mixers attached
+ * directly to a mixer that is attached to a voice (or rendered with
+ * al_render_mixer) are mixed concurrently by a pool of worker threads, each
+ * into its own buffer.  The calling thread keeps mixing the other attached
+ * streams in the usual order, and adds each sub-mixer's buffer in at the
+ * point where it would have mixed that sub-mixer itself, so the result is
+ * the same as mixing serially.
+ *
+ * The calling thread holds the voice mutex throughout, as it would when
+ * mixing serially.  The workers only touch the sub-mixer trees handed to
+ * them, which nothing else can touch while the voice mutex is held.
+ */
+typedef enum MIXER_JOB_STATE {
+   MIXER_JOB_PENDING,
+   MIXER_JOB_RUNNING,
+   MIXER_JOB_DONE
+} MIXER_JOB_STATE;
+
+typedef struct MIXER_JOB {
+   ALLEGRO_MIXER *mixer;
+   void *buf;
+   MIXER_JOB_STATE state;
+} MIXER_JOB;
+
+static struct {
+   ALLEGRO_THREAD **threads;
+   int num_threads;
+   ALLEGRO_MUTEX *mutex;
+   ALLEGRO_COND *work_cond;
+   ALLEGRO_COND *done_cond;
+   MIXER_JOB *jobs;
+   int num_jobs;
+   int max_jobs;
+   int next_job;
+   unsigned int samples;
+   bool busy;
+   bool quit;
+} mixer_pool;
+
+
+static void run_mixer_job(MIXER_JOB *job, unsigned int samples)
+{
+   void *buf = NULL;
+
+   _al_kcm_mixer_read(&job->mixer->ss, &buf, &samples,
+      job->mixer->ss.spl_data.depth, 0);
+   job->buf = buf;
+}
+
+
+static void *mixer_pool_thread(ALLEGRO_THREAD *self, void *arg)
+{
+   (void)self;
+   (void)arg;
+
+   al_lock_mutex(mixer_pool.mutex);
+   while (!mixer_pool.quit) {
+      MIXER_JOB *job;
+
+      while (mixer_pool.next_job < mixer_pool.num_jobs &&
+            mixer_pool.jobs[mixer_pool.next_job].state != MIXER_JOB_PENDING) {
+         mixer_pool.next_job++;
+      }
+      if (mixer_pool.next_job >= mixer_pool.num_jobs) {
+         al_wait_cond(mixer_pool.work_cond, mixer_pool.mutex);
+         continue;
+      }
+
+      job = &mixer_pool.jobs[mixer_pool.next_job++];
+      job->state = MIXER_JOB_RUNNING;
+      al_unlock_mutex(mixer_pool.mutex);
+
+      run_mixer_job(job, mixer_pool.samples);
+
+      al_lock_mutex(mixer_pool.mutex);
+      job->state = MIXER_JOB_DONE;
+      al_broadcast_cond(mixer_pool.done_cond);
+   }
+   al_unlock_mutex(mixer_pool.mutex);
+
+   return NULL;
+}
+
+
+static void init_mixer_pool(void)
+{
+   const char *p;
+   int n;
+   int i;
+
+   if (mixer_pool.mutex)
+      return;
+
+   p = al_get_config_value(al_get_system_config(), "audio", "mixer_threads");
+   n = (p && p[0] != '\0') ? atoi(p) : 0;
+   if (n <= 0)
+      return;
+
+   mixer_pool.mutex = al_create_mutex();
+   mixer_pool.work_cond = al_create_cond();
+   mixer_pool.done_cond = al_create_cond();
+   mixer_pool.threads = al_calloc(n, sizeof(ALLEGRO_THREAD *));
+   if (!mixer_pool.mutex || !mixer_pool.work_cond || !mixer_pool.done_cond ||
+         !mixer_pool.threads) {
+      ALLEGRO_ERROR("Unable to create the mixer worker pool\n");
+      _al_kcm_shutdown_mixer_pool();
+      return;
+   }
+
+   for (i = 0; i < n; i++) {
+      ALLEGRO_THREAD *thread = al_create_thread(mixer_pool_thread, NULL);
+      if (!thread)
+         break;
+      mixer_pool.threads[mixer_pool.num_threads++] = thread;
+      al_start_thread(thread);
+   }
+
+   ALLEGRO_INFO("Mixing sub-mixers on %d worker threads\n",
+      mixer_pool.num_threads);
+}
+
+
+/* _al_kcm_shutdown_mixer_pool:
+ *  Stops the sub-mixer worker threads, if any were started.
+ */
+void _al_kcm_shutdown_mixer_pool(void)
+{
+   int i;
+
+   if (!mixer_pool.mutex)
+      return;
+
+   al_lock_mutex(mixer_pool.mutex);
+   mixer_pool.quit = true;
+   al_broadcast_cond(mixer_pool.work_cond);
+   al_unlock_mutex(mixer_pool.mutex);
+
+   for (i = 0; i < mixer_pool.num_threads; i++) {
+      al_destroy_thread(mixer_pool.threads[i]);
+   }
+   al_free(mixer_pool.threads);
+   al_free(mixer_pool.jobs);
+
+   if (mixer_pool.done_cond)
+      al_destroy_cond(mixer_pool.done_cond);
+   if (mixer_pool.work_cond)
+      al_destroy_cond(mixer_pool.work_cond);
+   al_destroy_mutex(mixer_pool.mutex);
+
+   memset(&mixer_pool, 0, sizeof(mixer_pool));
+}
+
+
+/* Hands the sub-mixers attached to the mixer over to the worker pool, in the
+ * order _al_kcm_mixer_read visits them.  Returns false if they are to be
+ * mixed serially instead.
+ */
+static bool dispatch_sub_mixers(ALLEGRO_MIXER *mixer, unsigned int samples)
+{
+   int count = 0;
+   int i;
+
+   if (mixer_pool.num_threads == 0)
+      return false;
+
+   /* Only the top of the tree is split up, so that workers never wait on
+    * each other.
+    */
+   if (mixer->ss.parent.u.ptr && !mixer->ss.parent.is_voice)
+      return false;
+
+   for (i = _al_vector_size(&mixer->streams) - 1; i >= 0; i--) {
+      ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&mixer->streams, i);
+      if ((*slot)->is_mixer)
+         count++;
+   }
+   if (count < 2)
+      return false;
+
+   al_lock_mutex(mixer_pool.mutex);
+
+   /* Another voice is using the pool. */
+   if (mixer_pool.busy) {
+      al_unlock_mutex(mixer_pool.mutex);
+      return false;
+   }
+
+   if (count > mixer_pool.max_jobs) {
+      MIXER_JOB *jobs = al_realloc(mixer_pool.jobs, count * sizeof(MIXER_JOB));
+      if (!jobs) {
+         al_unlock_mutex(mixer_pool.mutex);
+         return false;
+      }
+      mixer_pool.jobs = jobs;
+      mixer_pool.max_jobs = count;
+   }
+
+   mixer_pool.num_jobs = 0;
+   for (i = _al_vector_size(&mixer->streams) - 1; i >= 0; i--) {
+      ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&mixer->streams, i);
+      if ((*slot)->is_mixer) {
+         MIXER_JOB *job = &mixer_pool.jobs[mixer_pool.num_jobs++];
+         job->mixer = (ALLEGRO_MIXER *)*slot;
+         job->buf = NULL;
+         job->state = MIXER_JOB_PENDING;
+      }
+   }
+   mixer_pool.next_job = 0;
+   mixer_pool.samples = samples;
+   mixer_pool.busy = true;
+   al_broadcast_cond(mixer_pool.work_cond);
+
+   al_unlock_mutex(mixer_pool.mutex);
+
+   return true;
+}
+
+
+/* Waits for the given job to finish, running it on the calling thread if no
+ * worker has picked it up yet.  Returns the mixed buffer, or NULL if the
+ * sub-mixer is not playing.
+ */
+static void *collect_sub_mixer(int index)
+{
+   MIXER_JOB *job = &mixer_pool.jobs[index];
+
+   al_lock_mutex(mixer_pool.mutex);
+   if (job->state == MIXER_JOB_PENDING) {
+      job->state = MIXER_JOB_RUNNING;
+      al_unlock_mutex(mixer_pool.mutex);
+
+      run_mixer_job(job, mixer_pool.samples);
+
+      al_lock_mutex(mixer_pool.mutex);
+      job->state = MIXER_JOB_DONE;
+   }
+   while (job->state != MIXER_JOB_DONE) {
+      al_wait_cond(mixer_pool.done_cond, mixer_pool.mutex);
+   }
+   al_unlock_mutex(mixer_pool.mutex);
+
+   return job->buf;
+}
+
+
+static void release_sub_mixers(void)
+{
+   al_lock_mutex(mixer_pool.mutex);
+   mixer_pool.num_jobs = 0;
+   mixer_pool.next_job = 0;
+   mixer_pool.busy = false;
+   al_unlock_mutex(mixer_pool.mutex);
+}
+
+
+/* Adds a mixed buffer into the buffer of the mixer it is attached to. */
+static void add_mixer_buffer(ALLEGRO_AUDIO_DEPTH depth, void *dest,
+   const void *src, int samples_l)
+{
+   switch (depth) {
+      case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
+         /* We don't need to clamp in the mixer yet. */
+         float *lbuf = dest;
+         const float *lsrc = src;
+         while (samples_l-- > 0) {
+            *lbuf += *lsrc;
+            lbuf++;
+            lsrc++;
+         }
+         break;
+      }
+
+      case ALLEGRO_AUDIO_DEPTH_INT16: {
+         int16_t *lbuf = dest;
+         const int16_t *lsrc = src;
+         while (samples_l-- > 0) {
+            int32_t x = *lbuf + *lsrc;
+            if (x < -32768)
+               x = -32768;
+            else if (x > 32767)
+               x = 32767;
+            *lbuf = (int16_t)x;
+            lbuf++;
+            lsrc++;
+         }
+         break;
+      }
+
+      case ALLEGRO_AUDIO_DEPTH_INT8:
+      case ALLEGRO_AUDIO_DEPTH_INT24:
+      case ALLEGRO_AUDIO_DEPTH_UINT8:
+      case ALLEGRO_AUDIO_DEPTH_UINT16:
+      case ALLEGRO_AUDIO_DEPTH_UINT24:
+         /* Unsupported mixer depths. */
+         ASSERT(false);
+         break;
+   }
+}
+
+
+/* Like add_mixer_buffer, from a planar buffer into an interleaved one or the
+ * other way around.  Both hold `samples' frames of `maxc' channels.
+ */
+static void add_mixer_buffer_relaid(ALLEGRO_AUDIO_DEPTH depth, void *dest,
+   bool dest_planar, const void *src, int samples, int maxc)
+{
+   const int dest_step = dest_planar ? samples : 1;
+   const int dest_frame = dest_planar ? 1 : maxc;
+   const int src_step = dest_planar ? 1 : samples;
+   const int src_frame = dest_planar ? maxc : 1;
+   int c, i;
+
+   for (c = 0; c < maxc; c++) {
+      switch (depth) {
+         case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
+            float *lbuf = (float *)dest + c * dest_step;
+            const float *lsrc = (const float *)src + c * src_step;
+            for (i = 0; i < samples; i++) {
+               lbuf[i * dest_frame] += lsrc[i * src_frame];
+            }
+            break;
+         }
+
+         case ALLEGRO_AUDIO_DEPTH_INT16: {
+            int16_t *lbuf = (int16_t *)dest + c * dest_step;
+            const int16_t *lsrc = (const int16_t *)src + c * src_step;
+            for (i = 0; i < samples; i++) {
+               int32_t x = lbuf[i * dest_frame] + lsrc[i * src_frame];
+               if (x < -32768)
+                  x = -32768;
+               else if (x > 32767)
+                  x = 32767;
+               lbuf[i * dest_frame] = (int16_t)x;
+            }
+            break;
+         }
+
+         default:
+            /* Unsupported mixer depths. */
+            ASSERT(false);
+            break;
+      }
+   }
+}
+
+
+/* Interleaves the buffer of a planar mixer into interleave_buf, which then
+ * becomes the mixer buffer, so the conversions for the voice that follow
+ * work on frames as usual.
+ */
+static void interleave_mixer_buffer(ALLEGRO_MIXER *mixer, int samples,
+   int maxc)
+{
+   void *planes = mixer->ss.spl_data.buffer.ptr;
+   int c, i;
+
+   if (!mixer->interleave_buf) {
+      mixer->interleave_buf =
+         al_malloc(mixer->ss.spl_data.len * maxc * sizeof(float));
+      if (!mixer->interleave_buf) {
+         ALLEGRO_ERROR("Out of memory interleaving planar mixer buffer\n");
+         memset(planes, 0, samples * maxc *
+            al_get_audio_depth_size(mixer->ss.spl_data.depth));
+         return;
+      }
+   }
+
+   if (mixer->ss.spl_data.depth == ALLEGRO_AUDIO_DEPTH_FLOAT32) {
+      const float *src = planes;
+      float *dst = mixer->interleave_buf;
+      i = 0;
+#ifdef __SSE__
+      if (maxc == 2) {
+         for (; i + 4 <= samples; i += 4) {
+            const __m128 l = _mm_loadu_ps(src + i);
+            const __m128 r = _mm_loadu_ps(src + samples + i);
+            _mm_storeu_ps(dst + i*2, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(dst + i*2 + 4, _mm_unpackhi_ps(l, r));
+         }
+      }
+#endif
+      for (; i < samples; i++) {
+         for (c = 0; c < maxc; c++) {
+            dst[i*maxc + c] = src[c*samples + i];
+         }
+      }
+   }
+   else {
+      const int16_t *src = planes;
+      int16_t *dst = mixer->interleave_buf;
+      for (i = 0; i < samples; i++) {
+         for (c = 0; c < maxc; c++) {
+            dst[i*maxc + c] = src[c*samples + i];
+         }
+      }
+   }
+
+   mixer->ss.spl_data.buffer.ptr = mixer->interleave_buf;
+   mixer->interleave_buf = planes;
+}
+
+
+/* Applies the mixer gain to the mixed buffer. */
+static void apply_mixer_gain(ALLEGRO_MIXER *mixer, int samples_l)
+{
+   const float mixer_gain = mixer->ss.gain;
+   int i;
+
+   if (mixer_gain == 1.0f)
+      return;
+
+   switch (mixer->ss.spl_data.depth) {
+      case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
+         float *p = mixer->ss.spl_data.buffer.f32;
+         i = 0;
+#ifdef __SSE__
+         {
+            const __m128 g = _mm_set1_ps(mixer_gain);
+            for (; i + 4 <= samples_l; i += 4) {
+               _mm_storeu_ps(p + i, _mm_mul_ps(_mm_loadu_ps(p + i), g));
+            }
+         }
+#endif
+         for (; i < samples_l; i++) {
+            p[i] *= mixer_gain;
+         }
+         break;
+      }
+
+      case ALLEGRO_AUDIO_DEPTH_INT16: {
+         int16_t *p = mixer->ss.spl_data.buffer.s16;
+         i = 0;
+#ifdef __SSE2__
+         {
+            /* Clamping before truncating gives the same as add_sat16. */
+            const __m128 g = _mm_set1_ps(mixer_gain);
+            const __m128 vlo = _mm_set1_ps(-32768.0f);
+            const __m128 vhi = _mm_set1_ps(32767.0f);
+            for (; i + 8 <= samples_l; i += 8) {
+               const __m128i x = _mm_loadu_si128((__m128i *)(p + i));
+               __m128 lo = _mm_cvtepi32_ps(
+                  _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+               __m128 hi = _mm_cvtepi32_ps(
+                  _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+               lo = _mm_min_ps(_mm_max_ps(_mm_mul_ps(lo, g), vlo), vhi);
+               hi = _mm_min_ps(_mm_max_ps(_mm_mul_ps(hi, g), vlo), vhi);
+               _mm_storeu_si128((__m128i *)(p + i), _mm_packs_epi32(
+                  _mm_cvttps_epi32(lo), _mm_cvttps_epi32(hi)));
+            }
+         }
+#endif
+         for (; i < samples_l; i++) {
+            p[i] = add_sat16(0, p[i] * mixer_gain);
+         }
+         break;
+      }
+
+      case ALLEGRO_AUDIO_DEPTH_INT8:
+      case ALLEGRO_AUDIO_DEPTH_INT24:
+      case ALLEGRO_AUDIO_DEPTH_UINT8:
+      case ALLEGRO_AUDIO_DEPTH_UINT16:
+      case ALLEGRO_AUDIO_DEPTH_UINT24:
+         /* Unsupported mixer depths. */
+         ASSERT(false);
+         break;
+   }
+}
+
+
+/* Returns triangular (TPDF) dither noise between -1 and 1 LSB. */
+static INLINE float tpdf_noise(uint32_t *seed)
+{
+   float r1, r2;
+
+   *seed = *seed * 1664525 + 1013904223;
+   r1 = (*seed >> 8) * (1.0f / 16777216.0f);
+   *seed = *seed * 1664525 + 1013904223;
+   r2 = (*seed >> 8) * (1.0f / 16777216.0f);
+
+   return r1 - r2;
+}
+
+
+/* Converts the float mixer buffer in place to the integer voice depth,
+ * applying the mixer gain, the optional dither and clamping on the way.
+ * Without dither the values are truncated, as they always have been.  The
+ * gain is applied before the scale rather than folded into it, so that the
+ * result is rounded the same as when the gain was applied separately.
+ */
+static void convert_float_buffer(ALLEGRO_MIXER *mixer,
+   ALLEGRO_AUDIO_DEPTH voice_depth, int samples_l)
+{
+   const ALLEGRO_AUDIO_DEPTH depth = voice_depth & ~ALLEGRO_AUDIO_DEPTH_UNSIGNED;
+   const bool is_unsigned = (voice_depth & ALLEGRO_AUDIO_DEPTH_UNSIGNED) != 0;
+   const int bits = (depth == ALLEGRO_AUDIO_DEPTH_INT8) ? 8 :
+      (depth == ALLEGRO_AUDIO_DEPTH_INT16) ? 16 : 24;
+   const int32_t hi = (1 << (bits - 1)) - 1;
+   const int32_t lo = ~hi;
+   const int32_t off = is_unsigned ? (1 << (bits - 1)) : 0;
+   const float gain = mixer->ss.gain;
+   const float scale = (float)hi + 0.5f;
+   const float *src = mixer->ss.spl_data.buffer.f32;
+   uint32_t seed = mixer->dither_seed;
+   int i = 0;
+
+   ASSERT(depth == ALLEGRO_AUDIO_DEPTH_INT8 ||
+      depth == ALLEGRO_AUDIO_DEPTH_INT16 ||
+      depth == ALLEGRO_AUDIO_DEPTH_INT24);
+
+#ifdef __SSE2__
+   {
+      const __m128 vgain = _mm_set1_ps(gain);
+      const __m128 vscale = _mm_set1_ps(scale);
+      const __m128 vlo = _mm_set1_ps((float)lo);
+      const __m128 vhi = _mm_set1_ps((float)hi);
+      const __m128i voff = _mm_set1_epi32(off);
+
+      for (; i + 4 <= samples_l; i += 4) {
+         __m128 v = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(src + i), vgain),
+            vscale);
+         __m128i iv;
+
+         if (mixer->dither) {
+            const float n0 = tpdf_noise(&seed);
+            const float n1 = tpdf_noise(&seed);
+            const float n2 = tpdf_noise(&seed);
+            const float n3 = tpdf_noise(&seed);
+            v = _mm_add_ps(v, _mm_set_ps(n3, n2, n1, n0));
+            v = _mm_min_ps(_mm_max_ps(v, vlo), vhi);
+            iv = _mm_cvtps_epi32(v);
+         }
+         else {
+            v = _mm_min_ps(_mm_max_ps(v, vlo), vhi);
+            iv = _mm_cvttps_epi32(v);
+         }
+
+         /* The destination is never wider than the source, so writing
+          * behind the read position is safe.  Unsigned 8 and 16-bit values
+          * are packed as signed ones and then have their sign bit flipped.
+          */
+         switch (bits) {
+            case 8: {
+               __m128i w = _mm_packs_epi16(_mm_packs_epi32(iv, iv), iv);
+               uint32_t packed = _mm_cvtsi128_si32(w);
+               if (is_unsigned)
+                  packed ^= 0x80808080;
+               memcpy(mixer->ss.spl_data.buffer.s8 + i, &packed, 4);
+               break;
+            }
+            case 16: {
+               __m128i w = _mm_packs_epi32(iv, iv);
+               if (is_unsigned)
+                  w = _mm_xor_si128(w, _mm_set1_epi16((short)0x8000));
+               _mm_storel_epi64((__m128i *)(mixer->ss.spl_data.buffer.s16 + i), w);
+               break;
+            }
+            default:
+               iv = _mm_add_epi32(iv, voff);
+               _mm_storeu_si128((__m128i *)(mixer->ss.spl_data.buffer.s24 + i), iv);
+               break;
+         }
+      }
+   }
+#endif
+
+   for (; i < samples_l; i++) {
+      float v = (src[i] * gain) * scale;
+      int32_t x;
+
+      if (mixer->dither) {
+         v += tpdf_noise(&seed);
+         v = (v < lo) ? lo : (v > hi) ? hi : v;
+         x = lrintf(v);
+      }
+      else {
+         v = (v < lo) ? lo : (v > hi) ? hi : v;
+         x = (int32_t)v;
+      }
+      x += off;
+
+      switch (bits) {
+         case 8:
+            mixer->ss.spl_data.buffer.s8[i] = (int8_t)x;
+            break;
+         case 16:
+            mixer->ss.spl_data.buffer.s16[i] = (int16_t)x;
+            break;
+         default:
+            mixer->ss.spl_data.buffer.s24[i] = x;
+            break;
+      }
+   }
+
+   mixer->dither_seed = seed;
+}
+
+
+/* Converts the int16 mixer buffer in place to the voice depth. */
+static void convert_int16_buffer(ALLEGRO_MIXER *mixer,
+   ALLEGRO_AUDIO_DEPTH voice_depth, int samples_l)
+{
+   int16_t *src = mixer->ss.spl_data.buffer.s16;
+   int i;
+
+   switch (voice_depth) {
+      case ALLEGRO_AUDIO_DEPTH_INT16:
+         break;
+
+      case ALLEGRO_AUDIO_DEPTH_UINT16:
+         i = 0;
+#ifdef __SSE2__
+         {
+            const __m128i sign = _mm_set1_epi16((short)0x8000);
+            for (; i + 8 <= samples_l; i += 8) {
+               __m128i x = _mm_loadu_si128((__m128i *)(src + i));
+               _mm_storeu_si128((__m128i *)(src + i), _mm_xor_si128(x, sign));
+            }
+         }
+#endif
+         for (; i < samples_l; i++) {
+            src[i] ^= 0x8000;
+         }
+         break;
+
+      case ALLEGRO_AUDIO_DEPTH_INT8:
+      case ALLEGRO_AUDIO_DEPTH_UINT8: {
+         const int8_t off = (voice_depth == ALLEGRO_AUDIO_DEPTH_UINT8) ? 0x80 : 0;
+         int8_t *dst = mixer->ss.spl_data.buffer.s8;
+         i = 0;
+#ifdef __SSE2__
+         {
+            const __m128i voff = _mm_set1_epi8(off);
+            for (; i + 16 <= samples_l; i += 16) {
+               const __m128i a = _mm_srai_epi16(
+                  _mm_loadu_si128((__m128i *)(src + i)), 8);
+               const __m128i b = _mm_srai_epi16(
+                  _mm_loadu_si128((__m128i *)(src + i + 8)), 8);
+               _mm_storeu_si128((__m128i *)(dst + i),
+                  _mm_xor_si128(_mm_packs_epi16(a, b), voff));
+            }
+         }
+#endif
+         for (; i < samples_l; i++) {
+            dst[i] = (int8_t)((src[i] >> 8) ^ off);
+         }
+         break;
+      }
+
+      /* Widening conversions work backwards so as not to overwrite the
+       * values still to be read.  A block of 8 values is loaded before it
+       * is stored, and its store only reaches the values from twice its
+       * index on, which have been read already.
+       */
+      case ALLEGRO_AUDIO_DEPTH_INT24:
+      case ALLEGRO_AUDIO_DEPTH_UINT24: {
+         const int32_t off =
+            (voice_depth == ALLEGRO_AUDIO_DEPTH_UINT24) ? 0x800000 : 0;
+         int32_t *dst = mixer->ss.spl_data.buffer.s24;
+         i = samples_l;
+#ifdef __SSE2__
+         {
+            const __m128i voff = _mm_set1_epi32(off);
+            for (; i >= 8; i -= 8) {
+               const __m128i x = _mm_loadu_si128((__m128i *)(src + i - 8));
+               const __m128i lo = _mm_slli_epi32(
+                  _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16), 8);
+               const __m128i hi = _mm_slli_epi32(
+                  _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16), 8);
+               _mm_storeu_si128((__m128i *)(dst + i - 4),
+                  _mm_add_epi32(hi, voff));
+               _mm_storeu_si128((__m128i *)(dst + i - 8),
+                  _mm_add_epi32(lo, voff));
+            }
+         }
+#endif
+         for (i = i - 1; i >= 0; i--) {
+            dst[i] = (src[i] * 256) + off;
+         }
+         break;
+      }
+
+      case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
+         float *dst = mixer->ss.spl_data.buffer.f32;
+         i = samples_l;
+#ifdef __SSE2__
+         {
+            const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+            for (; i >= 8; i -= 8) {
+               const __m128i x = _mm_loadu_si128((__m128i *)(src + i - 8));
+               const __m128 lo = _mm_cvtepi32_ps(
+                  _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+               const __m128 hi = _mm_cvtepi32_ps(
+                  _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+               _mm_storeu_ps(dst + i - 4, _mm_mul_ps(hi, scale));
+               _mm_storeu_ps(dst + i - 8, _mm_mul_ps(lo, scale));
+            }
+         }
+#endif
+         for (i = i - 1; i >= 0; i--) {
+            dst[i] = src[i] * (1.0f / 32768.0f);
+         }
+         break;
+      }
+   }
+}
+
+
+/* _al_kcm_mixer_read:
+ *  Mixes the streams attached to the mixer and writes additively to the
+ *  specified buffer (or if *buf is NULL, indicating a voice, convert it and
+ *  set it to the buffer pointer).
+ */
+void _al_kcm_mixer_read(void *source, void **buf, unsigned int *samples,
+   ALLEGRO_AUDIO_DEPTH buffer_depth, size_t dest_maxc)
+{
+   const ALLEGRO_MIXER *mixer;
+   ALLEGRO_MIXER *m = (ALLEGRO_MIXER *)source;
+   int maxc = al_get_channel_count(m->ss.spl_data.chan_conf);
+   int samples_l = *samples;
+   bool parallel;
+   int job = 0;
+   unsigned int real_voices = 0;
+   unsigned int virtual_voices = 0;
+   double start;
+   int i;
+
+   if (!m->ss.is_playing)
+      return;
+
+   start = al_get_time();
+
+   /* Make sure the mixer buffer is big enough.  It is converted to the
+    * voice depth in place, which may take up to four bytes per sample.
+    */
+   if (m->ss.spl_data.len*maxc < samples_l*maxc) {
+      al_free(m->ss.spl_data.buffer.ptr);
+      al_free(m->interleave_buf);
+      m->interleave_buf = NULL;
+      m->ss.spl_data.buffer.ptr = al_malloc(samples_l*maxc*sizeof(float));
+      if (!m->ss.spl_data.buffer.ptr) {
+         _al_set_error(ALLEGRO_GENERIC_ERROR,
+            "Out of memory allocating mixer buffer");
+         m->ss.spl_data.len = 0;
+         return;
+      }
+      m->ss.spl_data.len = samples_l;
+   }
+
+   mixer = m;
 
-            case ALLEGRO_AUDIO_DEPTH_INT16:
-               /* Handle signedness differences. */
-               if (buffer_depth != ALLEGRO_AUDIO_DEPTH_INT16) {
-                  int16_t *lbuf = mixer->ss.spl_data.buffer.s16;
-                  while (samples_l > 0) {
-                     *lbuf++ ^= 0x8000;
-                     samples_l--;
-                  }
-               }
-               break;
+   /* Clear the buffer to silence. */
+   memset(mixer->ss.spl_data.buffer.ptr, 0, samples_l * maxc * al_get_audio_depth_size(mixer->ss.spl_data.depth));
 
-            case ALLEGRO_AUDIO_DEPTH_INT8:
-            case ALLEGRO_AUDIO_DEPTH_INT24:
-            case ALLEGRO_AUDIO_DEPTH_UINT8:
-            case ALLEGRO_AUDIO_DEPTH_UINT16:
-            case ALLEGRO_AUDIO_DEPTH_UINT24:
-               /* Unsupported mixer depths. */
-               ASSERT(false);
-               break;
+   /* Mix the streams into the mixer buffer. */
+   parallel = dispatch_sub_mixers(m, *samples);
+   for (i = _al_vector_size(&mixer->streams) - 1; i >= 0; i--) {
+      ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&mixer->streams, i);
+      ALLEGRO_SAMPLE_INSTANCE *spl = *slot;
+      bool was_playing;
+      ASSERT(spl->spl_read);
+      if (parallel && spl->is_mixer) {
+         void *sub = collect_sub_mixer(job++);
+         /* The job hands back interleaved frames, as for a voice. */
+         if (sub && m->planar) {
+            add_mixer_buffer_relaid(m->ss.spl_data.depth,
+               mixer->ss.spl_data.buffer.ptr, true, sub, samples_l, maxc);
          }
-         break;
+         else if (sub) {
+            add_mixer_buffer(m->ss.spl_data.depth,
+               mixer->ss.spl_data.buffer.ptr, sub, samples_l * maxc);
+         }
+         continue;
+      }
+      was_playing = spl->is_playing;
+      if (spl->loop == _ALLEGRO_PLAYMODE_STREAM_ONCE ||
+            spl->loop == _ALLEGRO_PLAYMODE_STREAM_ONEDIR) {
+         ALLEGRO_AUDIO_STREAM *stream = (ALLEGRO_AUDIO_STREAM *)spl;
+         const double stream_start = al_get_time();
+         spl->spl_read(spl, (void **) &mixer->ss.spl_data.buffer.ptr,
+            samples, m->ss.spl_data.depth, maxc);
+         _al_kcm_add_mix_time(&stream->stats, stream_start, al_get_time(),
+            (double)samples_l / m->ss.spl_data.frequency);
+      }
+      else {
+         spl->spl_read(spl, (void **) &mixer->ss.spl_data.buffer.ptr,
+            samples, m->ss.spl_data.depth, maxc);
+      }
+      if (was_playing && !spl->is_mixer) {
+         if (spl->is_virtual)
+            virtual_voices++;
+         else
+            real_voices++;
+      }
+   }
+   if (parallel)
+      release_sub_mixers();
 
-      /* Ugh, do we really want to support 8-bit output? */
-      case ALLEGRO_AUDIO_DEPTH_INT8:
-         switch (mixer->ss.spl_data.depth) {
-            case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
-               int8_t off = ((buffer_depth & ALLEGRO_AUDIO_DEPTH_UNSIGNED)
-                              ? 0x80 : 0);
-               int8_t *lbuf = mixer->ss.spl_data.buffer.s8;
-               float *src = mixer->ss.spl_data.buffer.f32;
-
-               while (samples_l > 0) {
-                  *lbuf = clamp(*(src++) * ((float)0x7F + 0.5f), ~0x7F, 0x7F);
-                  *lbuf += off;
-                  lbuf++;
-                  samples_l--;
-               }
-               break;
-            }
+   m->real_voices = real_voices;
+   m->virtual_voices = virtual_voices;
 
-            case ALLEGRO_AUDIO_DEPTH_INT16:
-               /* XXX not yet implemented */
-               ASSERT(false);
-               break;
+   /* Call the post-processing callback. */
+   if (mixer->planar_postprocess_callback) {
+      const double callback_start = al_get_time();
+      void *planes[ALLEGRO_MAX_CHANNELS];
+      const int size = al_get_audio_depth_size(m->ss.spl_data.depth);
+      ASSERT(m->planar);
+      for (i = 0; i < maxc; i++) {
+         planes[i] = (char *)mixer->ss.spl_data.buffer.ptr +
+            i * samples_l * size;
+      }
+      mixer->planar_postprocess_callback(planes, *samples,
+         mixer->planar_pp_callback_userdata);
+      _al_kcm_add_callback_time(&m->stats, al_get_time() - callback_start);
+   }
+   else if (mixer->postprocess_callback) {
+      const double callback_start = al_get_time();
+      ASSERT(!m->planar);
+      mixer->postprocess_callback(mixer->ss.spl_data.buffer.ptr,
+         *samples, mixer->pp_callback_userdata);
+      _al_kcm_add_callback_time(&m->stats, al_get_time() - callback_start);
+   }
 
-            case ALLEGRO_AUDIO_DEPTH_INT8:
-            case ALLEGRO_AUDIO_DEPTH_INT24:
-            case ALLEGRO_AUDIO_DEPTH_UINT8:
-            case ALLEGRO_AUDIO_DEPTH_UINT16:
-            case ALLEGRO_AUDIO_DEPTH_UINT24:
-               /* Unsupported mixer depths. */
-               ASSERT(false);
-               break;
-         }
-         break;
+   /* Feeding to a non-voice.
+    * Currently we only support mixers of the same audio depth doing this.
+    */
+   if (*buf) {
+      const bool parent_planar = m->ss.parent.u.mixer->planar;
+      apply_mixer_gain(m, samples_l * maxc);
+      if (m->planar != parent_planar) {
+         add_mixer_buffer_relaid(m->ss.spl_data.depth, *buf, parent_planar,
+            mixer->ss.spl_data.buffer.ptr, samples_l, maxc);
+      }
+      else {
+         add_mixer_buffer(m->ss.spl_data.depth, *buf,
+            mixer->ss.spl_data.buffer.ptr, samples_l * maxc);
+      }
+      _al_kcm_add_mix_time(&m->stats, start, al_get_time(),
+         (double)samples_l / m->ss.spl_data.frequency);
+      return;
+   }
 
-      case ALLEGRO_AUDIO_DEPTH_UINT8:
-      case ALLEGRO_AUDIO_DEPTH_UINT16:
-      case ALLEGRO_AUDIO_DEPTH_UINT24:
-         /* Impossible. */
-         ASSERT(false);
-         break;
+   /* We're feeding to a voice.
+    * Clamp and convert the mixed data for the voice.
+    */
+   if (m->planar)
+      interleave_mixer_buffer(m, samples_l, maxc);
+   samples_l *= maxc;
+   *buf = mixer->ss.spl_data.buffer.ptr;
+   if (m->ss.spl_data.depth == ALLEGRO_AUDIO_DEPTH_FLOAT32 &&
+         buffer_depth != ALLEGRO_AUDIO_DEPTH_FLOAT32) {
+      /* The gain is applied by the conversion. */
+      convert_float_buffer(m, buffer_depth, samples_l);
+   }
+   else {
+      apply_mixer_gain(m, samples_l);
+      if (m->ss.spl_data.depth == ALLEGRO_AUDIO_DEPTH_INT16) {
+         convert_int16_buffer(m, buffer_depth, samples_l);
+      }
    }
 
+   _al_kcm_add_mix_time(&m->stats, start, al_get_time(),
+      (double)*samples / m->ss.spl_data.frequency);
+
    (void)dest_maxc;
 }
 
@@ -629,6 +2033,10 @@ ALLEGRO_MIXER *al_create_mixer(unsigned int freq,
          ALLEGRO_INFO("Cubic interpolation\n");
          default_mixer_quality = ALLEGRO_MIXER_QUALITY_CUBIC;
       }
+      else if (!_al_stricmp(p, "sinc")) {
+         ALLEGRO_INFO("Windowed-sinc interpolation\n");
+         default_mixer_quality = ALLEGRO_MIXER_QUALITY_SINC;
+      }
    }
 
    if (!freq) {
@@ -665,6 +2073,27 @@ ALLEGRO_MIXER *al_create_mixer(unsigned int freq,
 
    mixer->quality = default_mixer_quality;
 
+   p = al_get_config_value(al_get_system_config(), "audio", "ramp_parameters");
+   mixer->ramp_params = (p && atoi(p) != 0);
+
+   p = al_get_config_value(al_get_system_config(), "audio",
+      "virtual_voice_threshold");
+   mixer->virtual_threshold = (p && p[0] != '\0') ? atof(p) : 0.0f;
+
+   p = al_get_config_value(al_get_system_config(), "audio", "dither");
+   mixer->dither = (p && atoi(p) != 0);
+   mixer->dither_seed = 1;
+
+   p = al_get_config_value(al_get_system_config(), "audio",
+      "preconvert_samples");
+   mixer->preconvert = (p && atoi(p) != 0);
+
+   /* Shared by all mixers, and cheap enough to build up front rather than
+    * from the audio thread.
+    */
+   init_sinc_table();
+   init_mixer_pool();
+
    _al_vector_init(&mixer->streams, sizeof(ALLEGRO_SAMPLE_INSTANCE *));
 
    _al_kcm_register_destructor(mixer, (void (*)(void *)) al_destroy_mixer);
@@ -685,12 +2114,53 @@ void al_destroy_mixer(ALLEGRO_MIXER *mixer)
 
 
 /* This function is ALLEGRO_MIXER aware */
+/* _al_kcm_mixer_convert_sample:
+ *  Returns the data of the sample instance converted to the depth of the
+ *  mixer, if the mixer wants that, or NULL to read the data as it is.
+ *  Audio streams and mixers are never converted.
+ */
+const ALLEGRO_SAMPLE *_al_kcm_mixer_convert_sample(ALLEGRO_MIXER *mixer,
+   ALLEGRO_SAMPLE_INSTANCE *spl)
+{
+   if (!mixer->preconvert || spl->is_mixer || spl->spl_data.compressed ||
+         spl->loop == _ALLEGRO_PLAYMODE_STREAM_ONCE ||
+         spl->loop == _ALLEGRO_PLAYMODE_STREAM_ONEDIR) {
+      return NULL;
+   }
+
+   return _al_kcm_get_converted_sample(&spl->spl_data,
+      mixer->ss.spl_data.depth);
+}
+
+
+/* ADPCM compressed samples are only point sampled or linearly interpolated;
+ * the wider filters would need more blocks decoded at once.
+ */
+static stream_reader_t adpcm_reader(const ALLEGRO_MIXER *mixer)
+{
+   const bool point = (mixer->quality == ALLEGRO_MIXER_QUALITY_POINT);
+
+   if (!point && mixer->quality != ALLEGRO_MIXER_QUALITY_LINEAR) {
+      ALLEGRO_WARN("Falling back to linear interpolation for ADPCM sample\n");
+   }
+
+   if (mixer->ss.spl_data.depth == ALLEGRO_AUDIO_DEPTH_FLOAT32) {
+      return point ? read_adpcm_to_mixer_point_float_32
+         : read_adpcm_to_mixer_linear_float_32;
+   }
+   ASSERT(mixer->ss.spl_data.depth == ALLEGRO_AUDIO_DEPTH_INT16);
+   return point ? read_adpcm_to_mixer_point_int16_t_16
+      : read_adpcm_to_mixer_linear_int16_t_16;
+}
+
+
 /* Function: al_attach_sample_instance_to_mixer
  */
 bool al_attach_sample_instance_to_mixer(ALLEGRO_SAMPLE_INSTANCE *spl,
    ALLEGRO_MIXER *mixer)
 {
    ALLEGRO_SAMPLE_INSTANCE **slot;
+   const ALLEGRO_SAMPLE *converted;
 
    ASSERT(mixer);
    ASSERT(spl);
@@ -702,6 +2172,9 @@ bool al_attach_sample_instance_to_mixer(ALLEGRO_SAMPLE_INSTANCE *spl,
       return false;
    }
 
+   /* Convert outside the lock, the mixer need not wait for it. */
+   converted = _al_kcm_mixer_convert_sample(mixer, spl);
+
    maybe_lock_mutex(mixer->ss.mutex);
    
    _al_kcm_stream_set_mutex(spl, mixer->ss.mutex);
@@ -717,21 +2190,19 @@ bool al_attach_sample_instance_to_mixer(ALLEGRO_SAMPLE_INSTANCE *spl,
    }
    (*slot) = spl;
 
-   spl->step = (spl->spl_data.frequency) * spl->speed;
-   spl->step_denom = mixer->ss.spl_data.frequency;
-   /* Don't want to be trapped with a step value of 0. */
-   if (spl->step == 0) {
-      if (spl->speed > 0.0f)
-         spl->step = 1;
-      else
-         spl->step = -1;
-   }
+   spl->converted = converted;
+   _al_kcm_mixer_set_step(mixer, spl);
+   spl->applied_serial = _al_atomic_load(&spl->param_serial);
 
    /* Set the proper sample stream reader. */
    ASSERT(spl->spl_read == NULL);
    if (spl->is_mixer) {
       spl->spl_read = _al_kcm_mixer_read;
    }
+   else if (spl->spl_data.adpcm) {
+      spl->spl_read = adpcm_reader(mixer);
+      _al_kcm_mixer_rejig_sample_matrix(mixer, spl);
+   }
    else {
       switch (mixer->ss.spl_data.depth) {
          case ALLEGRO_AUDIO_DEPTH_FLOAT32:
@@ -745,6 +2216,9 @@ bool al_attach_sample_instance_to_mixer(ALLEGRO_SAMPLE_INSTANCE *spl,
                case ALLEGRO_MIXER_QUALITY_CUBIC:
                   spl->spl_read = read_to_mixer_cubic_float_32;
                   break;
+               case ALLEGRO_MIXER_QUALITY_SINC:
+                  spl->spl_read = read_to_mixer_sinc_float_32;
+                  break;
             }
             break;
 
@@ -759,6 +2233,9 @@ bool al_attach_sample_instance_to_mixer(ALLEGRO_SAMPLE_INSTANCE *spl,
                case ALLEGRO_MIXER_QUALITY_LINEAR:
                   spl->spl_read = read_to_mixer_linear_int16_t_16;
                   break;
+               case ALLEGRO_MIXER_QUALITY_SINC:
+                  spl->spl_read = read_to_mixer_sinc_int16_t_16;
+                  break;
             }
             break;
 
@@ -780,6 +2257,12 @@ bool al_attach_sample_instance_to_mixer(ALLEGRO_SAMPLE_INSTANCE *spl,
 
    maybe_unlock_mutex(mixer->ss.mutex);
 
+   /* A compressed sample is heard through its decoder. */
+   if (spl->decoder && !al_attach_audio_stream_to_mixer(spl->decoder, mixer)) {
+      _al_kcm_detach_from_parent(spl);
+      return false;
+   }
+
    return true;
 }
 
@@ -829,6 +2312,13 @@ bool al_set_mixer_postprocess_callback(ALLEGRO_MIXER *mixer,
 
    maybe_lock_mutex(mixer->ss.mutex);
 
+   if (pp_callback && mixer->planar) {
+      maybe_unlock_mutex(mixer->ss.mutex);
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "Attempted to set an interleaved callback on a planar mixer");
+      return false;
+   }
+
    mixer->postprocess_callback = pp_callback;
    mixer->pp_callback_userdata = pp_callback_userdata;
 
@@ -838,6 +2328,32 @@ bool al_set_mixer_postprocess_callback(ALLEGRO_MIXER *mixer,
 }
 
 
+/* Function: al_set_mixer_planar_postprocess_callback
+ */
+bool al_set_mixer_planar_postprocess_callback(ALLEGRO_MIXER *mixer,
+   void (*pp_callback)(void **planes, unsigned int samples, void *data),
+   void *pp_callback_userdata)
+{
+   ASSERT(mixer);
+
+   maybe_lock_mutex(mixer->ss.mutex);
+
+   if (pp_callback && !mixer->planar) {
+      maybe_unlock_mutex(mixer->ss.mutex);
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "Attempted to set a planar callback on an interleaved mixer");
+      return false;
+   }
+
+   mixer->planar_postprocess_callback = pp_callback;
+   mixer->planar_pp_callback_userdata = pp_callback_userdata;
+
+   maybe_unlock_mutex(mixer->ss.mutex);
+
+   return true;
+}
+
+
 /* Function: al_get_mixer_frequency
  */
 unsigned int al_get_mixer_frequency(const ALLEGRO_MIXER *mixer)
@@ -908,6 +2424,46 @@ bool al_get_mixer_attached(const ALLEGRO_MIXER *mixer)
 }
 
 
+/* Function: al_get_mixer_real_voices
+ */
+unsigned int al_get_mixer_real_voices(const ALLEGRO_MIXER *mixer)
+{
+   ASSERT(mixer);
+
+   return mixer->real_voices;
+}
+
+
+/* Function: al_get_mixer_virtual_voices
+ */
+unsigned int al_get_mixer_virtual_voices(const ALLEGRO_MIXER *mixer)
+{
+   ASSERT(mixer);
+
+   return mixer->virtual_voices;
+}
+
+
+/* Function: al_get_mixer_preconvert_samples
+ */
+bool al_get_mixer_preconvert_samples(const ALLEGRO_MIXER *mixer)
+{
+   ASSERT(mixer);
+
+   return mixer->preconvert;
+}
+
+
+/* Function: al_get_mixer_planar
+ */
+bool al_get_mixer_planar(const ALLEGRO_MIXER *mixer)
+{
+   ASSERT(mixer);
+
+   return mixer->planar;
+}
+
+
 /* Function: al_set_mixer_frequency
  */
 bool al_set_mixer_frequency(ALLEGRO_MIXER *mixer, unsigned int val)
@@ -991,6 +2547,44 @@ bool al_set_mixer_playing(ALLEGRO_MIXER *mixer, bool val)
 }
 
 
+/* Function: al_set_mixer_preconvert_samples
+ */
+bool al_set_mixer_preconvert_samples(ALLEGRO_MIXER *mixer, bool val)
+{
+   ASSERT(mixer);
+
+   maybe_lock_mutex(mixer->ss.mutex);
+   mixer->preconvert = val;
+   maybe_unlock_mutex(mixer->ss.mutex);
+
+   return true;
+}
+
+
+/* Function: al_set_mixer_planar
+ */
+bool al_set_mixer_planar(ALLEGRO_MIXER *mixer, bool val)
+{
+   ASSERT(mixer);
+
+   maybe_lock_mutex(mixer->ss.mutex);
+
+   /* A callback would be handed a buffer laid out the wrong way. */
+   if (val ? mixer->postprocess_callback != NULL :
+         mixer->planar_postprocess_callback != NULL) {
+      maybe_unlock_mutex(mixer->ss.mutex);
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "Attempted to change the layout of a mixer with a callback");
+      return false;
+   }
+
+   mixer->planar = val;
+   maybe_unlock_mutex(mixer->ss.mutex);
+
+   return true;
+}
+
+
 /* Function: al_detach_mixer
  */
 bool al_detach_mixer(ALLEGRO_MIXER *mixer)
@@ -1003,4 +2597,192 @@ bool al_detach_mixer(ALLEGRO_MIXER *mixer)
 }
 
 
+/* Returns the number of mixer frames that can be rendered before any stream
+ * fed by a feeder thread under the mixer may run out of buffered data, or
+ * 'max' if there are no such streams.  Sets *waiting if one of those streams
+ * still has fragments waiting to be refilled.
+ */
+static unsigned int feeder_safe_frames(const ALLEGRO_MIXER *mixer,
+   unsigned int max, bool *waiting)
+{
+   int i;
+
+   for (i = _al_vector_size(&mixer->streams) - 1; i >= 0; i--) {
+      ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&mixer->streams, i);
+      ALLEGRO_SAMPLE_INSTANCE *spl = *slot;
+      ALLEGRO_AUDIO_STREAM *stream;
+      uint64_t frames;
+
+      if (spl->is_mixer) {
+         max = feeder_safe_frames((ALLEGRO_MIXER *)spl, max, waiting);
+         continue;
+      }
+
+      if (spl->loop != _ALLEGRO_PLAYMODE_STREAM_ONCE &&
+            spl->loop != _ALLEGRO_PLAYMODE_STREAM_ONEDIR)
+         continue;
+
+      stream = (ALLEGRO_AUDIO_STREAM *)spl;
+      if (!(stream->feed_thread || stream->fed_by_pool) ||
+            stream->quit_feed_thread ||
+            stream->is_draining || !spl->is_playing)
+         continue;
+
+      if (stream->used_bufs[0])
+         *waiting = true;
+
+      /* The fragments queued behind the current one are always available. */
+      frames = (uint64_t)(stream->buf_count - 1) * spl->spl_data.len;
+      frames = frames * spl->step_denom / (spl->step < 0 ? -spl->step : spl->step);
+      if (frames < 1)
+         frames = 1;
+      if (frames < max)
+         max = frames;
+   }
+
+   return max;
+}
+
+
+/* _al_kcm_wake_renderer:
+ *  Wakes al_render_mixer() up if it is rendering the mixer tree the
+ *  instance is attached to, and waiting for the instance's feeder.  The
+ *  caller must be holding the instance's mutex.
+ */
+void _al_kcm_wake_renderer(ALLEGRO_SAMPLE_INSTANCE *spl)
+{
+   while (spl->parent.u.ptr && !spl->parent.is_voice)
+      spl = &spl->parent.u.mixer->ss;
+
+   if (spl->is_mixer && ((ALLEGRO_MIXER *)spl)->render_cond)
+      al_broadcast_cond(((ALLEGRO_MIXER *)spl)->render_cond);
+}
+
+
+/* Asks the feeders of the streams attached to the mixer, directly or not,
+ * to fill any fragments they have free.  Otherwise a stream that has not
+ * been read yet would never be asked for anything.
+ */
+static void request_feeder_fragments(ALLEGRO_MIXER *mixer)
+{
+   int i;
+
+   for (i = _al_vector_size(&mixer->streams) - 1; i >= 0; i--) {
+      ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&mixer->streams, i);
+      ALLEGRO_SAMPLE_INSTANCE *spl = *slot;
+      ALLEGRO_AUDIO_STREAM *stream;
+
+      if (spl->is_mixer) {
+         request_feeder_fragments((ALLEGRO_MIXER *)spl);
+         continue;
+      }
+
+      if (spl->loop != _ALLEGRO_PLAYMODE_STREAM_ONCE &&
+            spl->loop != _ALLEGRO_PLAYMODE_STREAM_ONEDIR)
+         continue;
+
+      stream = (ALLEGRO_AUDIO_STREAM *)spl;
+      if ((stream->feed_thread || stream->fed_by_pool) &&
+            !stream->quit_feed_thread && spl->is_playing) {
+         _al_kcm_emit_stream_events(stream);
+      }
+   }
+}
+
+
+/* Function: al_render_mixer
+ */
+bool al_render_mixer(ALLEGRO_MIXER *mixer, void *buf, unsigned int samples,
+   ALLEGRO_AUDIO_DEPTH depth)
+{
+   size_t frame_size;
+   char *out = buf;
+
+   ASSERT(mixer);
+   ASSERT(buf);
+
+   if (mixer->ss.parent.u.ptr) {
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "Attempted to render a mixer that is attached");
+      return false;
+   }
+
+   if (depth != ALLEGRO_AUDIO_DEPTH_FLOAT32 &&
+         (depth & ~ALLEGRO_AUDIO_DEPTH_UNSIGNED) != ALLEGRO_AUDIO_DEPTH_INT8 &&
+         (depth & ~ALLEGRO_AUDIO_DEPTH_UNSIGNED) != ALLEGRO_AUDIO_DEPTH_INT16 &&
+         (depth & ~ALLEGRO_AUDIO_DEPTH_UNSIGNED) != ALLEGRO_AUDIO_DEPTH_INT24) {
+      _al_set_error(ALLEGRO_INVALID_PARAM,
+         "Unsupported depth for rendering this mixer");
+      return false;
+   }
+
+   /* Without a voice there is no mutex shared with the stream feeder
+    * threads, so give the mixer one of its own.
+    */
+   if (!mixer->render_mutex) {
+      mixer->render_mutex = al_create_mutex_recursive();
+      mixer->render_cond = al_create_cond();
+      if (!mixer->render_mutex || !mixer->render_cond) {
+         _al_set_error(ALLEGRO_GENERIC_ERROR,
+            "Out of memory allocating mixer mutex");
+         if (mixer->render_mutex)
+            al_destroy_mutex(mixer->render_mutex);
+         if (mixer->render_cond)
+            al_destroy_cond(mixer->render_cond);
+         mixer->render_mutex = NULL;
+         mixer->render_cond = NULL;
+         return false;
+      }
+   }
+   _al_kcm_stream_set_mutex(&mixer->ss, mixer->render_mutex);
+
+   frame_size = al_get_channel_count(mixer->ss.spl_data.chan_conf) *
+      al_get_audio_depth_size(depth);
+
+   al_lock_mutex(mixer->render_mutex);
+   request_feeder_fragments(mixer);
+   al_unlock_mutex(mixer->render_mutex);
+
+   while (samples > 0) {
+      unsigned int n;
+      void *data = NULL;
+      bool waiting;
+
+      /* Streams loaded with al_load_audio_stream() are refilled by their
+       * feeder threads.  Give those a chance to catch up, so that rendering
+       * faster than real time does not cause them to underrun.  The feeders
+       * signal us as each fragment comes back; the timeout only covers a
+       * feeder which stops without handing one back.
+       */
+      al_lock_mutex(mixer->render_mutex);
+      for (;;) {
+         ALLEGRO_TIMEOUT timeout;
+
+         waiting = false;
+         n = feeder_safe_frames(mixer, samples, &waiting);
+         if (!waiting)
+            break;
+         al_init_timeout(&timeout, 0.01);
+         al_wait_cond_until(mixer->render_cond, mixer->render_mutex,
+            &timeout);
+      }
+
+      _al_kcm_mixer_read(&mixer->ss, &data, &n, depth, 0);
+      if (data) {
+         memcpy(out, data, n * frame_size);
+      }
+      else {
+         al_fill_silence(out, n, depth, mixer->ss.spl_data.chan_conf);
+      }
+
+      al_unlock_mutex(mixer->render_mutex);
+
+      out += n * frame_size;
+      samples -= n;
+   }
+
+   return true;
+}
+
+
 /* vim: set sts=3 sw=3 et: */
@@ -31,14 +31,61 @@ static ALLEGRO_VOICE *allegro_voice = NULL;
 static ALLEGRO_MIXER *allegro_mixer = NULL;
 static ALLEGRO_MIXER *default_mixer = NULL;
 
-static _AL_VECTOR auto_samples = _AL_VECTOR_INITIALIZER(ALLEGRO_SAMPLE_INSTANCE *);
-static _AL_VECTOR auto_sample_ids = _AL_VECTOR_INITIALIZER(int);
+/* The sample instances reserved by al_reserve_samples for al_play_sample. */
+typedef struct AUTO_SAMPLE {
+   ALLEGRO_SAMPLE_INSTANCE *inst;
+   int id;
+   int priority;
+   int stolen_id;       /* The last play on this slot that was stolen. */
+   bool is_free;        /* Whether the slot is on the free list. */
+   bool is_queued;      /* Whether the slot is in its priority's queue. */
+   int prev, next;      /* Its neighbours there, -1 at the ends. */
+} AUTO_SAMPLE;
+
+static _AL_VECTOR auto_samples = _AL_VECTOR_INITIALIZER(AUTO_SAMPLE);
+
+/* Indices of the slots known to be free, used as a stack. */
+static _AL_VECTOR free_auto_samples = _AL_VECTOR_INITIALIZER(int);
+
+/* The slots started with one priority, oldest first, which are playing
+ * unless the mixer has just finished with them.
+ */
+typedef struct PRIORITY_QUEUE {
+   int priority;
+   int first;
+   int last;
+} PRIORITY_QUEUE;
+
+/* The queues in use, lowest priority first. */
+static _AL_VECTOR priority_queues = _AL_VECTOR_INITIALIZER(PRIORITY_QUEUE);
+
+/* Slots whose instances have stopped, pushed by the mixer or whoever stopped
+ * them and popped by al_play_sample.  They are pushed with the default
+ * mixer's mutex held, so there is one producer at a time, and one consumer.
+ */
+typedef struct FINISHED_RING {
+   int *slots;
+   unsigned int mask;
+   volatile _AL_ATOMIC head;
+   volatile _AL_ATOMIC tail;
+   volatile _AL_ATOMIC dropped;
+} FINISHED_RING;
+
+static FINISHED_RING finished_ring;
+
+typedef enum STEAL_POLICY {
+   STEAL_OLDEST,
+   STEAL_QUIETEST
+} STEAL_POLICY;
+
+static STEAL_POLICY steal_policy = STEAL_OLDEST;
 
 
 static bool create_default_mixer(void);
 static bool do_play_sample(ALLEGRO_SAMPLE_INSTANCE *spl, ALLEGRO_SAMPLE *data,
       float gain, float pan, float speed, ALLEGRO_PLAYMODE loop);
 static void free_sample_vector(void);
+static bool reset_auto_sample_slots(void);
 
 
 static int string_to_depth(const char *s)
@@ -169,26 +216,66 @@ static void stop_sample_instances_helper(void *object, void (*func)(void *),
 
    /* This is ugly. */
    if (func == (void (*)(void *)) al_destroy_sample_instance
-      && al_get_sample_data(al_get_sample(splinst)) == userdata
-      && al_get_sample_instance_playing(splinst))
+      && (al_get_sample_data(al_get_sample(splinst)) == userdata
+         || (splinst->spl_data.adpcm
+            && splinst->spl_data.adpcm == userdata)
+         || (splinst->spl_data.compressed
+            && splinst->spl_data.compressed == userdata)))
    {
-      al_stop_sample_instance(splinst);
+      if (al_get_sample_instance_playing(splinst))
+         al_stop_sample_instance(splinst);
+      splinst->converted = NULL;
+      if (splinst->spl_data.compressed) {
+         /* The decoder would keep the encoded file alive. */
+         _al_kcm_set_sample_decoder(splinst, NULL);
+         splinst->spl_data.compressed = NULL;
+      }
    }
 }
 
 
+/* _al_kcm_stop_sample_instances:
+ *  Stops the sample instances playing from the given sample data, which is
+ *  about to be freed, and frees the copies of it converted for mixers.
+ */
+void _al_kcm_stop_sample_instances(void *buffer)
+{
+   _al_kcm_foreach_destructor(stop_sample_instances_helper, buffer);
+   _al_kcm_forget_converted_samples(buffer);
+}
+
+
 /* Function: al_destroy_sample
  */
 void al_destroy_sample(ALLEGRO_SAMPLE *spl)
 {
    if (spl) {
-      _al_kcm_foreach_destructor(stop_sample_instances_helper,
-         al_get_sample_data(spl));
+      if (spl->cache_entry) {
+         /* The data belongs to the sample cache, which stops any instances
+          * still playing it when it lets go of it.
+          */
+         _al_kcm_unregister_destructor(spl);
+         _al_kcm_release_cached_sample(spl->cache_entry);
+         al_free(spl);
+         return;
+      }
+
+      if (spl->compressed)
+         _al_kcm_stop_sample_instances(spl->compressed);
+      else if (spl->adpcm)
+         _al_kcm_stop_sample_instances(spl->adpcm);
+      else
+         _al_kcm_stop_sample_instances(al_get_sample_data(spl));
       _al_kcm_unregister_destructor(spl);
 
       if (spl->free_buf && spl->buffer.ptr) {
          al_free(spl->buffer.ptr);
       }
+      else if (spl->release_buf) {
+         spl->release_buf(spl);
+      }
+      _al_kcm_destroy_adpcm_data(spl->adpcm);
+      spl->adpcm = NULL;
       spl->buffer.ptr = NULL;
       spl->free_buf = false;
       al_free(spl);
@@ -217,15 +304,14 @@ bool al_reserve_samples(int reserve_samples)
    if (current_samples_count < reserve_samples) {
       /* We need to reserve more samples than currently are reserved. */
       for (i = 0; i < reserve_samples - current_samples_count; i++) {
-         ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_alloc_back(&auto_samples);
-         int *id = _al_vector_alloc_back(&auto_sample_ids);
-         *id = 0;
-         *slot = al_create_sample_instance(NULL);
-         if (!*slot) {
+         AUTO_SAMPLE *slot = _al_vector_alloc_back(&auto_samples);
+         memset(slot, 0, sizeof(*slot));
+         slot->inst = al_create_sample_instance(NULL);
+         if (!slot->inst) {
             ALLEGRO_ERROR("al_create_sample failed\n");
             goto Error;
          }
-         if (!al_attach_sample_instance_to_mixer(*slot, default_mixer)) {
+         if (!al_attach_sample_instance_to_mixer(slot->inst, default_mixer)) {
             ALLEGRO_ERROR("al_attach_mixer_to_sample failed\n");
             goto Error;
          }
@@ -234,11 +320,15 @@ bool al_reserve_samples(int reserve_samples)
    else if (current_samples_count > reserve_samples) {
       /* We need to reserve fewer samples than currently are reserved. */
       while (current_samples_count-- > reserve_samples) {
+         AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, current_samples_count);
+         al_destroy_sample_instance(slot->inst);
          _al_vector_delete_at(&auto_samples, current_samples_count);
-         _al_vector_delete_at(&auto_sample_ids, current_samples_count);
       }
    }
 
+   if (!reset_auto_sample_slots())
+      goto Error;
+
    return true;
 
  Error:
@@ -270,22 +360,24 @@ bool al_set_default_mixer(ALLEGRO_MIXER *mixer)
       /* Destroy all current sample instances, recreate them, and
        * attach them to the new mixer */
       for (i = 0; i < (int) _al_vector_size(&auto_samples); i++) {
-         ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&auto_samples, i);
-         int *id = _al_vector_ref(&auto_sample_ids, i);
+         AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, i);
 
-         *id = 0;
-         al_destroy_sample_instance(*slot);
+         al_destroy_sample_instance(slot->inst);
+         memset(slot, 0, sizeof(*slot));
 
-         *slot = al_create_sample_instance(NULL);
-         if (!*slot) {
+         slot->inst = al_create_sample_instance(NULL);
+         if (!slot->inst) {
             ALLEGRO_ERROR("al_create_sample failed\n");
             goto Error;
          }
-         if (!al_attach_sample_instance_to_mixer(*slot, default_mixer)) {
+         if (!al_attach_sample_instance_to_mixer(slot->inst, default_mixer)) {
             ALLEGRO_ERROR("al_attach_mixer_to_sample failed\n");
             goto Error;
          }
-      }      
+      }
+
+      if (!reset_auto_sample_slots())
+         goto Error;
    }
 
    return true;
@@ -330,13 +422,301 @@ void al_set_default_voice(ALLEGRO_VOICE *voice)
 }
 
 
-/* Function: al_play_sample
+/* Called when one of the reserved instances stops, by the mixer when it has
+ * played to the end or by whoever stopped it.
  */
-bool al_play_sample(ALLEGRO_SAMPLE *spl, float gain, float pan, float speed,
-   ALLEGRO_PLAYMODE loop, ALLEGRO_SAMPLE_ID *ret_id)
+static void auto_sample_finished(ALLEGRO_SAMPLE_INSTANCE *spl, void *data)
+{
+   FINISHED_RING *ring = &finished_ring;
+   _AL_ATOMIC head = ring->head;
+   (void)spl;
+
+   if ((unsigned int)(head - _al_atomic_load(&ring->tail)) > ring->mask) {
+      /* al_play_sample will look for the slot when it runs out. */
+      _al_atomic_store(&ring->dropped, 1);
+      return;
+   }
+
+   ring->slots[head & ring->mask] = (int)(intptr_t)data;
+   _al_atomic_store(&ring->head, head + 1);
+}
+
+
+/* Returns the queue for the given priority, which is added if `create' is
+ * set.  Returns NULL if there is none.
+ */
+static PRIORITY_QUEUE *find_priority_queue(int priority, bool create)
+{
+   PRIORITY_QUEUE *queue;
+   unsigned int i;
+
+   for (i = 0; i < _al_vector_size(&priority_queues); i++) {
+      queue = _al_vector_ref(&priority_queues, i);
+      if (queue->priority == priority)
+         return queue;
+      if (queue->priority > priority)
+         break;
+   }
+
+   if (!create)
+      return NULL;
+
+   queue = _al_vector_alloc_mid(&priority_queues, i);
+   if (queue) {
+      queue->priority = priority;
+      queue->first = -1;
+      queue->last = -1;
+   }
+   return queue;
+}
+
+
+/* Adds a slot which has just been started to the back of its queue. */
+static void queue_slot(int index)
+{
+   AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, index);
+   PRIORITY_QUEUE *queue = find_priority_queue(slot->priority, true);
+
+   /* Without a queue the slot can't be stolen, but is freed all the same. */
+   if (!queue)
+      return;
+
+   slot->prev = queue->last;
+   slot->next = -1;
+   if (queue->last >= 0)
+      ((AUTO_SAMPLE *)_al_vector_ref(&auto_samples, queue->last))->next = index;
+   else
+      queue->first = index;
+   queue->last = index;
+   slot->is_queued = true;
+}
+
+
+static void unqueue_slot(int index)
+{
+   AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, index);
+   PRIORITY_QUEUE *queue;
+
+   if (!slot->is_queued)
+      return;
+   slot->is_queued = false;
+
+   queue = find_priority_queue(slot->priority, false);
+   ASSERT(queue);
+
+   if (slot->prev >= 0)
+      ((AUTO_SAMPLE *)_al_vector_ref(&auto_samples, slot->prev))->next = slot->next;
+   else
+      queue->first = slot->next;
+   if (slot->next >= 0)
+      ((AUTO_SAMPLE *)_al_vector_ref(&auto_samples, slot->next))->prev = slot->prev;
+   else
+      queue->last = slot->prev;
+
+   if (queue->first < 0)
+      _al_vector_find_and_delete(&priority_queues, queue);
+}
+
+
+static void push_free_slot(int index)
+{
+   AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, index);
+   int *entry;
+
+   unqueue_slot(index);
+   if (slot->is_free)
+      return;
+
+   entry = _al_vector_alloc_back(&free_auto_samples);
+   if (entry) {
+      *entry = index;
+      slot->is_free = true;
+   }
+}
+
+
+/* Moves the slots the mixer has finished with onto the free list. */
+static void collect_finished_slots(void)
+{
+   FINISHED_RING *ring = &finished_ring;
+   _AL_ATOMIC head = _al_atomic_load(&ring->head);
+   _AL_ATOMIC tail = ring->tail;
+
+   if (!ring->slots)
+      return;
+
+   while (tail != head) {
+      const int index = ring->slots[tail & ring->mask];
+      AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, index);
+      tail++;
+
+      /* The slot may have been stolen and restarted since. */
+      if (!al_get_sample_instance_playing(slot->inst))
+         push_free_slot(index);
+   }
+   _al_atomic_store(&ring->tail, tail);
+
+   if (_al_atomic_load(&ring->dropped)) {
+      unsigned int i;
+      _al_atomic_store(&ring->dropped, 0);
+      for (i = 0; i < _al_vector_size(&auto_samples); i++) {
+         AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, i);
+         if (!al_get_sample_instance_playing(slot->inst))
+            push_free_slot(i);
+      }
+   }
+}
+
+
+/* Rebuilds the free list, the queues and the finished ring after the
+ * reserved instances have changed.  The slots still playing are queued in
+ * slot order.
+ */
+static bool reset_auto_sample_slots(void)
 {
-   static int next_id = 0;
+   const unsigned int count = _al_vector_size(&auto_samples);
+   unsigned int size = 1;
+   ALLEGRO_MUTEX *mutex = default_mixer ? default_mixer->ss.mutex : NULL;
+   int *slots;
    unsigned int i;
+   const char *p;
+
+   p = al_get_config_value(al_get_system_config(), "audio",
+      "sample_steal_policy");
+   if (p && !_al_stricmp(p, "quietest"))
+      steal_policy = STEAL_QUIETEST;
+   else
+      steal_policy = STEAL_OLDEST;
+
+   /* Each slot may finish more than once before al_play_sample next looks,
+    * so leave some headroom.
+    */
+   while (size < 2 * count)
+      size *= 2;
+   slots = al_malloc(size * sizeof(int));
+   if (!slots)
+      return false;
+
+   if (mutex)
+      al_lock_mutex(mutex);
+   al_free(finished_ring.slots);
+   finished_ring.slots = slots;
+   finished_ring.mask = size - 1;
+   finished_ring.head = 0;
+   finished_ring.tail = 0;
+   finished_ring.dropped = 0;
+   for (i = 0; i < count; i++) {
+      AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, i);
+      slot->inst->stop_callback = auto_sample_finished;
+      slot->inst->stop_callback_data = (void *)(intptr_t)i;
+   }
+   if (mutex)
+      al_unlock_mutex(mutex);
+
+   _al_vector_free(&free_auto_samples);
+   _al_vector_free(&priority_queues);
+   for (i = 0; i < count; i++) {
+      AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, i);
+      slot->is_free = false;
+      slot->is_queued = false;
+      if (al_get_sample_instance_playing(slot->inst))
+         queue_slot(i);
+   }
+   for (i = count; i > 0; i--) {
+      AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, i - 1);
+      if (!slot->is_queued)
+         push_free_slot(i - 1);
+   }
+
+   return true;
+}
+
+
+/* Pops a slot off the free list, in constant time unless the mixer has
+ * finished with more slots than we were told about.  Returns -1 if there
+ * are none.
+ */
+static int pop_free_slot(void)
+{
+   collect_finished_slots();
+
+   while (_al_vector_is_nonempty(&free_auto_samples)) {
+      const int index = *(int *)_al_vector_ref_back(&free_auto_samples);
+      AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, index);
+
+      _al_vector_delete_at(&free_auto_samples,
+         _al_vector_size(&free_auto_samples) - 1);
+      slot->is_free = false;
+
+      /* The slot may have been restarted after it was stopped. */
+      if (!al_get_sample_instance_playing(slot->inst))
+         return index;
+   }
+
+   return -1;
+}
+
+
+/* Picks the slot to stop for a sound of the given priority: of those with
+ * the lowest priority, the oldest or the one quietest now.  Returns -1 if
+ * every slot is playing something more important.
+ */
+static int find_slot_to_steal(int priority)
+{
+   PRIORITY_QUEUE *queue;
+   AUTO_SAMPLE *slot;
+   float best_gain;
+   int best;
+   int i;
+
+   if (!_al_vector_is_nonempty(&priority_queues))
+      return -1;
+   queue = _al_vector_ref_front(&priority_queues);
+   if (queue->priority > priority)
+      return -1;
+
+   best = queue->first;
+   if (steal_policy != STEAL_QUIETEST)
+      return best;
+
+   slot = _al_vector_ref(&auto_samples, best);
+   best_gain = al_get_sample_instance_gain(slot->inst);
+   for (i = slot->next; i >= 0; i = slot->next) {
+      float gain;
+
+      slot = _al_vector_ref(&auto_samples, i);
+      gain = al_get_sample_instance_gain(slot->inst);
+      if (gain < best_gain) {
+         best = i;
+         best_gain = gain;
+      }
+   }
+
+   return best;
+}
+
+
+/* Ids tell the plays on a slot apart.  They wrap around, skipping 0, which
+ * no play has, and -1, which ALLEGRO_SAMPLE_ID uses for no play at all.
+ */
+static int next_sample_id(void)
+{
+   static unsigned int next_id = 0;
+
+   do {
+      next_id++;
+   } while (next_id == 0 || next_id == (unsigned int)-1);
+
+   return (int)next_id;
+}
+
+
+static bool play_auto_sample(ALLEGRO_SAMPLE *spl, float gain, float pan,
+   float speed, ALLEGRO_PLAYMODE loop, int priority, bool steal,
+   ALLEGRO_SAMPLE_ID *ret_id)
+{
+   AUTO_SAMPLE *slot;
+   int index;
    
    ASSERT(spl);
 
@@ -345,26 +725,75 @@ bool al_play_sample(ALLEGRO_SAMPLE *spl, float gain, float pan, float speed,
       ret_id->_index = 0;
    }
 
-   for (i = 0; i < _al_vector_size(&auto_samples); i++) {
-      ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&auto_samples, i);
-      ALLEGRO_SAMPLE_INSTANCE *splinst = (*slot);
-
-      if (!al_get_sample_instance_playing(splinst)) {
-         int *id = _al_vector_ref(&auto_sample_ids, i);
+   index = pop_free_slot();
+   if (index < 0 && steal) {
+      index = find_slot_to_steal(priority);
+      if (index >= 0) {
+         slot = _al_vector_ref(&auto_samples, index);
+         /* The mixer may have finished with it since we looked. */
+         if (al_get_sample_instance_playing(slot->inst)) {
+            ALLEGRO_DEBUG("Stealing sample slot %d (priority %d)\n", index,
+               slot->priority);
+            slot->stolen_id = slot->id;
+            al_stop_sample_instance(slot->inst);
+         }
+         unqueue_slot(index);
+      }
+   }
+   if (index < 0)
+      return false;
 
-         if (!do_play_sample(splinst, spl, gain, pan, speed, loop))
-            break;
+   slot = _al_vector_ref(&auto_samples, index);
+   if (!do_play_sample(slot->inst, spl, gain, pan, speed, loop)) {
+      push_free_slot(index);
+      return false;
+   }
 
-         if (ret_id != NULL) {
-            ret_id->_index = (int) i;
-            ret_id->_id = *id = ++next_id;
-         }
+   slot->id = next_sample_id();
+   slot->priority = priority;
+   queue_slot(index);
 
-         return true;
-      }
+   if (ret_id != NULL) {
+      ret_id->_index = index;
+      ret_id->_id = slot->id;
    }
 
-   return false;
+   return true;
+}
+
+
+/* Function: al_play_sample
+ */
+bool al_play_sample(ALLEGRO_SAMPLE *spl, float gain, float pan, float speed,
+   ALLEGRO_PLAYMODE loop, ALLEGRO_SAMPLE_ID *ret_id)
+{
+   return play_auto_sample(spl, gain, pan, speed, loop, 0, false, ret_id);
+}
+
+
+/* Function: al_play_sample_with_priority
+ */
+bool al_play_sample_with_priority(ALLEGRO_SAMPLE *spl, float gain, float pan,
+   float speed, ALLEGRO_PLAYMODE loop, int priority, ALLEGRO_SAMPLE_ID *ret_id)
+{
+   return play_auto_sample(spl, gain, pan, speed, loop, priority, true, ret_id);
+}
+
+
+/* Function: al_get_sample_id_stolen
+ */
+bool al_get_sample_id_stolen(const ALLEGRO_SAMPLE_ID *spl_id)
+{
+   AUTO_SAMPLE *slot;
+
+   ASSERT(spl_id);
+
+   if (spl_id->_id == -1 ||
+         spl_id->_index >= (int) _al_vector_size(&auto_samples))
+      return false;
+
+   slot = _al_vector_ref(&auto_samples, spl_id->_index);
+   return slot->stolen_id == spl_id->_id;
 }
 
 
@@ -396,18 +825,15 @@ static bool do_play_sample(ALLEGRO_SAMPLE_INSTANCE *splinst,
  */
 void al_stop_sample(ALLEGRO_SAMPLE_ID *spl_id)
 {
-   int *id;
+   AUTO_SAMPLE *slot;
 
    ASSERT(spl_id->_id != -1);
    ASSERT(spl_id->_index < (int) _al_vector_size(&auto_samples));
-   ASSERT(spl_id->_index < (int) _al_vector_size(&auto_sample_ids));
 
-   id = _al_vector_ref(&auto_sample_ids, spl_id->_index);
-   if (*id == spl_id->_id) {
-      ALLEGRO_SAMPLE_INSTANCE **slot, *spl;
-      slot = _al_vector_ref(&auto_samples, spl_id->_index);
-      spl = (*slot);
-      al_stop_sample_instance(spl);
+   slot = _al_vector_ref(&auto_samples, spl_id->_index);
+   if (slot->id == spl_id->_id) {
+      al_stop_sample_instance(slot->inst);
+      push_free_slot(spl_id->_index);
    }
 }
 
@@ -419,9 +845,9 @@ void al_stop_samples(void)
    unsigned int i;
 
    for (i = 0; i < _al_vector_size(&auto_samples); i++) {
-      ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&auto_samples, i);
-      ALLEGRO_SAMPLE_INSTANCE *spl = (*slot);
-      al_stop_sample_instance(spl);
+      AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, i);
+      al_stop_sample_instance(slot->inst);
+      push_free_slot(i);
    }
 }
 
@@ -482,11 +908,15 @@ static void free_sample_vector(void)
    int j;
 
    for (j = 0; j < (int) _al_vector_size(&auto_samples); j++) {
-      ALLEGRO_SAMPLE_INSTANCE **slot = _al_vector_ref(&auto_samples, j);
-      al_destroy_sample_instance(*slot);
+      AUTO_SAMPLE *slot = _al_vector_ref(&auto_samples, j);
+      al_destroy_sample_instance(slot->inst);
    }
    _al_vector_free(&auto_samples);
-   _al_vector_free(&auto_sample_ids);
+   _al_vector_free(&free_auto_samples);
+   _al_vector_free(&priority_queues);
+
+   al_free(finished_ring.slots);
+   memset(&finished_ring, 0, sizeof(finished_ring));
 }
 
 
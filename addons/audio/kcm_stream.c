@@ -8,6 +8,7 @@
 /* Title: Stream functions
  */
 
+#include <math.h>
 #include <stdio.h>
 
 #include "allegro5/allegro_audio.h"
@@ -17,11 +18,11 @@
 ALLEGRO_DEBUG_CHANNEL("audio")
 
 /*
- * The highest quality interpolator is a cubic interpolator requiring
- * four sample points.  In the streaming case we lag the true sample
- * position by three.
+ * The highest quality interpolator is the windowed-sinc interpolator
+ * requiring _AL_KCM_SINC_TAPS sample points.  In the streaming case we lag
+ * the true sample position by up to one less than that.
  */
-#define MAX_LAG   (3)
+#define MAX_LAG   (_AL_KCM_SINC_TAPS - 1)
 
 
 static void maybe_lock_mutex(ALLEGRO_MUTEX *mutex)
@@ -141,7 +142,7 @@ ALLEGRO_AUDIO_STREAM *al_create_audio_stream(size_t fragment_count,
 void al_destroy_audio_stream(ALLEGRO_AUDIO_STREAM *stream)
 {
    if (stream) {
-      if (stream->feed_thread) {
+      if (stream->unload_feeder) {
          stream->unload_feeder(stream);
       }
       /* See commented out call to _al_kcm_register_destructor. */
@@ -176,6 +177,16 @@ void al_drain_audio_stream(ALLEGRO_AUDIO_STREAM *stream)
 }
 
 
+/* Function: al_get_audio_stream_underruns
+ */
+unsigned int al_get_audio_stream_underruns(const ALLEGRO_AUDIO_STREAM *stream)
+{
+   ASSERT(stream);
+
+   return stream->stats.underruns;
+}
+
+
 /* Function: al_get_audio_stream_frequency
  */
 unsigned int al_get_audio_stream_frequency(const ALLEGRO_AUDIO_STREAM *stream)
@@ -322,28 +333,40 @@ uint64_t al_get_audio_stream_played_samples(const ALLEGRO_AUDIO_STREAM *stream)
    return result;
 }
 
-/* Function: al_get_audio_stream_fragment
-*/
-void *al_get_audio_stream_fragment(const ALLEGRO_AUDIO_STREAM *stream)
+
+/* take_used_fragment:
+ *  Removes the first fragment from the used list and returns it, or returns
+ *  NULL if there are none.  The caller must hold the stream mutex.
+ */
+static void *take_used_fragment(const ALLEGRO_AUDIO_STREAM *stream)
 {
    size_t i;
    void *fragment;
-   ASSERT(stream);
-
-   maybe_lock_mutex(stream->spl.mutex);
 
    if (!stream->used_bufs[0]) {
       /* No free fragments are available. */
-      fragment = NULL;
+      return NULL;
    }
-   else {
-      fragment = stream->used_bufs[0];
-      for (i = 0; i < stream->buf_count-1 && stream->used_bufs[i]; i++) {
-         stream->used_bufs[i] = stream->used_bufs[i+1];
-      }
-      stream->used_bufs[i] = NULL;
+
+   fragment = stream->used_bufs[0];
+   for (i = 0; i < stream->buf_count-1 && stream->used_bufs[i]; i++) {
+      stream->used_bufs[i] = stream->used_bufs[i+1];
    }
+   stream->used_bufs[i] = NULL;
+
+   return fragment;
+}
 
+
+/* Function: al_get_audio_stream_fragment
+*/
+void *al_get_audio_stream_fragment(const ALLEGRO_AUDIO_STREAM *stream)
+{
+   void *fragment;
+   ASSERT(stream);
+
+   maybe_lock_mutex(stream->spl.mutex);
+   fragment = take_used_fragment(stream);
    maybe_unlock_mutex(stream->spl.mutex);
 
    return fragment;
@@ -368,21 +391,9 @@ bool al_set_audio_stream_speed(ALLEGRO_AUDIO_STREAM *stream, float val)
       return false;
    }
 
+   /* The mixer picks up the new speed at the start of its next read. */
    stream->spl.speed = val;
-   if (stream->spl.parent.u.mixer) {
-      ALLEGRO_MIXER *mixer = stream->spl.parent.u.mixer;
-
-      maybe_lock_mutex(stream->spl.mutex);
-
-      stream->spl.step = (stream->spl.spl_data.frequency) * stream->spl.speed;
-      stream->spl.step_denom = mixer->ss.spl_data.frequency;
-      /* Don't wanna be trapped with a step value of 0 */
-      if (stream->spl.step == 0) {
-         stream->spl.step = 1;
-      }
-
-      maybe_unlock_mutex(stream->spl.mutex);
-   }
+   _al_fetch_and_add1(&stream->spl.param_serial);
 
    return true;
 }
@@ -403,16 +414,10 @@ bool al_set_audio_stream_gain(ALLEGRO_AUDIO_STREAM *stream, float val)
    if (stream->spl.gain != val) {
       stream->spl.gain = val;
 
-      /* If attached to a mixer already, need to recompute the sample
-       * matrix to take into account the gain.
+      /* The mixer recomputes the sample matrix at the start of its next
+       * read, without us having to wait for it.
        */
-      if (stream->spl.parent.u.mixer) {
-         ALLEGRO_MIXER *mixer = stream->spl.parent.u.mixer;
-
-         maybe_lock_mutex(stream->spl.mutex);
-         _al_kcm_mixer_rejig_sample_matrix(mixer, &stream->spl);
-         maybe_unlock_mutex(stream->spl.mutex);
-      }
+      _al_fetch_and_add1(&stream->spl.param_serial);
    }
 
    return true;
@@ -438,16 +443,10 @@ bool al_set_audio_stream_pan(ALLEGRO_AUDIO_STREAM *stream, float val)
    if (stream->spl.pan != val) {
       stream->spl.pan = val;
 
-      /* If attached to a mixer already, need to recompute the sample
-       * matrix to take into account the panning.
+      /* The mixer recomputes the sample matrix at the start of its next
+       * read, without us having to wait for it.
        */
-      if (stream->spl.parent.u.mixer) {
-         ALLEGRO_MIXER *mixer = stream->spl.parent.u.mixer;
-
-         maybe_lock_mutex(stream->spl.mutex);
-         _al_kcm_mixer_rejig_sample_matrix(mixer, &stream->spl);
-         maybe_unlock_mutex(stream->spl.mutex);
-      }
+      _al_fetch_and_add1(&stream->spl.param_serial);
    }
 
    return true;
@@ -586,6 +585,7 @@ bool al_set_audio_stream_fragment(ALLEGRO_AUDIO_STREAM *stream, void *val)
       ;
    if (i < stream->buf_count) {
       stream->pending_bufs[i] = val;
+      _al_kcm_wake_renderer(&stream->spl);
       ret = true;
    }
    else {
@@ -600,6 +600,38 @@ bool al_set_audio_stream_fragment(ALLEGRO_AUDIO_STREAM *stream, void *val)
 }
 
 
+/* fill_fragment_from_callback:
+ *  Takes a used fragment, has the stream's fill callback write into it, and
+ *  queues it.  Called from the audio thread with the stream mutex held, and
+ *  only when no other fragment is pending.
+ */
+static void fill_fragment_from_callback(ALLEGRO_AUDIO_STREAM *stream)
+{
+   const unsigned int len = stream->spl.spl_data.len;
+   const int bytes_per_sample =
+      al_get_channel_count(stream->spl.spl_data.chan_conf) *
+      al_get_audio_depth_size(stream->spl.spl_data.depth);
+   char *fragment;
+   unsigned int written;
+   double start;
+
+   fragment = take_used_fragment(stream);
+   if (!fragment)
+      return;
+
+   start = al_get_time();
+   written = stream->fill_callback(stream, fragment, len,
+      stream->fill_callback_userdata);
+   _al_kcm_add_callback_time(&stream->stats, al_get_time() - start);
+   if (written < len) {
+      al_fill_silence(fragment + written * bytes_per_sample, len - written,
+         stream->spl.spl_data.depth, stream->spl.spl_data.chan_conf);
+   }
+
+   stream->pending_bufs[0] = fragment;
+}
+
+
 /* _al_kcm_refill_stream:
  *  Called by the mixer when the current buffer has been used up.  It should
  *  point to the next pending buffer and reset the sample position.
@@ -629,6 +661,14 @@ bool _al_kcm_refill_stream(ALLEGRO_AUDIO_STREAM *stream)
       stream->used_bufs[i] = old_buf;
    }
 
+   /* Fragments queued by the user are played first.  After that, a stream
+    * with a fill callback gets the next fragment from it right now.
+    */
+   if (!stream->pending_bufs[0] && stream->fill_callback &&
+         !stream->is_draining) {
+      fill_fragment_from_callback(stream);
+   }
+
    new_buf = stream->pending_bufs[0];
    stream->spl.spl_data.buffer.ptr = new_buf;
    if (!new_buf) {
@@ -657,6 +697,74 @@ bool _al_kcm_refill_stream(ALLEGRO_AUDIO_STREAM *stream)
 }
 
 
+/* feed_stream_fragment:
+ *  Fills one used fragment of the stream from its feeder and queues it.
+ *  Returns false if the feeder has run out of data and the stream is to be
+ *  drained; true otherwise, including when there was no fragment to fill.
+ */
+static bool feed_stream_fragment(ALLEGRO_AUDIO_STREAM *stream)
+{
+   char *fragment;
+   unsigned long bytes;
+   unsigned long bytes_written;
+
+   fragment = al_get_audio_stream_fragment(stream);
+   if (!fragment) {
+      /* This is not an error. */
+      return true;
+   }
+
+   bytes = (stream->spl.spl_data.len) *
+         al_get_channel_count(stream->spl.spl_data.chan_conf) *
+         al_get_audio_depth_size(stream->spl.spl_data.depth);
+
+   maybe_lock_mutex(stream->spl.mutex);
+   bytes_written = stream->feeder(stream, fragment, bytes);
+   maybe_unlock_mutex(stream->spl.mutex);
+
+   if (stream->spl.loop == _ALLEGRO_PLAYMODE_STREAM_ONEDIR) {
+      /* Keep rewinding until the fragment is filled. */
+      while (bytes_written < bytes &&
+               stream->spl.loop == _ALLEGRO_PLAYMODE_STREAM_ONEDIR) {
+         size_t bw;
+         al_rewind_audio_stream(stream);
+         maybe_lock_mutex(stream->spl.mutex);
+         bw = stream->feeder(stream, fragment + bytes_written,
+            bytes - bytes_written);
+         bytes_written += bw;
+         maybe_unlock_mutex(stream->spl.mutex);
+      }
+   }
+   else if (bytes_written < bytes) {
+      /* Fill the rest of the fragment with silence. */
+      int silence_samples = (bytes - bytes_written) /
+         (al_get_channel_count(stream->spl.spl_data.chan_conf) *
+          al_get_audio_depth_size(stream->spl.spl_data.depth));
+      al_fill_silence(fragment + bytes_written, silence_samples,
+                      stream->spl.spl_data.depth, stream->spl.spl_data.chan_conf);
+   }
+
+   if (!al_set_audio_stream_fragment(stream, fragment)) {
+      ALLEGRO_ERROR("Error setting stream buffer.\n");
+      return true;
+   }
+
+   /* The streaming source doesn't feed any more. */
+   return !(bytes_written != bytes &&
+      stream->spl.loop == _ALLEGRO_PLAYMODE_STREAM_ONCE);
+}
+
+
+static void emit_stream_finished(ALLEGRO_AUDIO_STREAM *stream)
+{
+   ALLEGRO_EVENT event;
+
+   event.user.type = ALLEGRO_EVENT_AUDIO_STREAM_FINISHED;
+   event.user.timestamp = al_get_time();
+   al_emit_user_event(&stream->spl.es, &event, NULL);
+}
+
+
 /* _al_kcm_feed_stream:
  * A routine running in another thread that feeds the stream buffers as
  * neccesary, usually getting data from some file reader backend.
@@ -665,7 +773,6 @@ void *_al_kcm_feed_stream(ALLEGRO_THREAD *self, void *vstream)
 {
    ALLEGRO_AUDIO_STREAM *stream = vstream;
    ALLEGRO_EVENT_QUEUE *queue;
-   ALLEGRO_EVENT event;
    (void)self;
 
    ALLEGRO_DEBUG("Stream feeder thread started.\n");
@@ -681,60 +788,14 @@ void *_al_kcm_feed_stream(ALLEGRO_THREAD *self, void *vstream)
    stream->quit_feed_thread = false;
 
    while (!stream->quit_feed_thread) {
-      char *fragment;
       ALLEGRO_EVENT event;
 
       al_wait_for_event(queue, &event);
 
       if (event.type == ALLEGRO_EVENT_AUDIO_STREAM_FRAGMENT
           && !stream->is_draining) {
-         unsigned long bytes;
-         unsigned long bytes_written;
-
-         fragment = al_get_audio_stream_fragment(stream);
-         if (!fragment) {
-            /* This is not an error. */
-            continue;
-         }
-
-         bytes = (stream->spl.spl_data.len) *
-               al_get_channel_count(stream->spl.spl_data.chan_conf) *
-               al_get_audio_depth_size(stream->spl.spl_data.depth);
-
-         maybe_lock_mutex(stream->spl.mutex);
-         bytes_written = stream->feeder(stream, fragment, bytes);
-         maybe_unlock_mutex(stream->spl.mutex);
-
-         if (stream->spl.loop == _ALLEGRO_PLAYMODE_STREAM_ONEDIR) {
-            /* Keep rewinding until the fragment is filled. */
-            while (bytes_written < bytes &&
-                     stream->spl.loop == _ALLEGRO_PLAYMODE_STREAM_ONEDIR) {
-               size_t bw;
-               al_rewind_audio_stream(stream);
-               maybe_lock_mutex(stream->spl.mutex);
-               bw = stream->feeder(stream, fragment + bytes_written,
-                  bytes - bytes_written);
-               bytes_written += bw;
-               maybe_unlock_mutex(stream->spl.mutex);
-            }
-         }
-         else if (bytes_written < bytes) {
-            /* Fill the rest of the fragment with silence. */
-            int silence_samples = (bytes - bytes_written) /
-               (al_get_channel_count(stream->spl.spl_data.chan_conf) *
-                al_get_audio_depth_size(stream->spl.spl_data.depth));
-            al_fill_silence(fragment + bytes_written, silence_samples,
-                            stream->spl.spl_data.depth, stream->spl.spl_data.chan_conf);
-         }
-
-         if (!al_set_audio_stream_fragment(stream, fragment)) {
-            ALLEGRO_ERROR("Error setting stream buffer.\n");
-            continue;
-         }
-
-         /* The streaming source doesn't feed any more, drain buffers and quit. */
-         if (bytes_written != bytes &&
-            stream->spl.loop == _ALLEGRO_PLAYMODE_STREAM_ONCE) {
+         if (!feed_stream_fragment(stream)) {
+            /* Drain buffers and quit. */
             al_drain_audio_stream(stream);
             stream->quit_feed_thread = true;
          }
@@ -744,9 +805,7 @@ void *_al_kcm_feed_stream(ALLEGRO_THREAD *self, void *vstream)
       }
    }
    
-   event.user.type = ALLEGRO_EVENT_AUDIO_STREAM_FINISHED;
-   event.user.timestamp = al_get_time();
-   al_emit_user_event(&stream->spl.es, &event, NULL);
+   emit_stream_finished(stream);
 
    al_destroy_event_queue(queue);
 
@@ -756,6 +815,298 @@ void *_al_kcm_feed_stream(ALLEGRO_THREAD *self, void *vstream)
 }
 
 
+/* Shared stream feeder pool.
+ *
+ * If the [audio] stream_feeder_threads config value is above 0, streams
+ * loaded with al_load_audio_stream are fed by a small pool of worker threads
+ * instead of a thread each.  The mixer asks for a stream to be refilled when
+ * it hands a fragment back (see _al_kcm_emit_stream_events), without going
+ * through the stream's event source, and the workers always fill the
+ * requested stream with the least audio left queued first.
+ *
+ * The workers only hold the pool mutex while choosing a stream.  The mixer
+ * takes it with the voice mutex held, so the workers must never take a voice
+ * mutex while holding it.
+ */
+static struct {
+   ALLEGRO_THREAD **threads;
+   int num_threads;
+   ALLEGRO_MUTEX *mutex;
+   ALLEGRO_COND *work_cond;
+   ALLEGRO_COND *done_cond;
+   _AL_VECTOR streams;
+   bool initialised;
+   bool quit;
+} feeder_pool = { NULL, 0, NULL, NULL, NULL,
+   _AL_VECTOR_INITIALIZER(ALLEGRO_AUDIO_STREAM *), false, false };
+
+
+/* Returns how long the stream can keep playing from the fragments it has
+ * queued, in seconds.
+ */
+static double stream_time_left(const ALLEGRO_AUDIO_STREAM *stream)
+{
+   const ALLEGRO_SAMPLE_INSTANCE *spl = &stream->spl;
+   double rate = spl->spl_data.frequency * fabs(spl->speed);
+   int frames = 0;
+   size_t i;
+
+   for (i = 0; i < stream->buf_count && stream->pending_bufs[i]; i++) {
+      frames += spl->spl_data.len;
+   }
+   if (spl->spl_data.buffer.ptr)
+      frames -= spl->pos;
+
+   if (rate <= 0.0)
+      return 0.0;
+   return frames / rate;
+}
+
+
+/* Picks the requested stream that will run out first.  Called with the pool
+ * mutex held.
+ */
+static ALLEGRO_AUDIO_STREAM *next_stream_to_feed(void)
+{
+   ALLEGRO_AUDIO_STREAM *best = NULL;
+   double best_time = 0.0;
+   unsigned int i;
+
+   for (i = 0; i < _al_vector_size(&feeder_pool.streams); i++) {
+      ALLEGRO_AUDIO_STREAM **slot = _al_vector_ref(&feeder_pool.streams, i);
+      ALLEGRO_AUDIO_STREAM *stream = *slot;
+      double t;
+
+      if (!stream->feed_requested || stream->feeding ||
+            stream->quit_feed_thread || stream->is_draining)
+         continue;
+
+      t = stream_time_left(stream);
+      if (!best || t < best_time) {
+         best = stream;
+         best_time = t;
+      }
+   }
+
+   return best;
+}
+
+
+static void *feeder_pool_thread(ALLEGRO_THREAD *self, void *arg)
+{
+   (void)self;
+   (void)arg;
+
+   al_lock_mutex(feeder_pool.mutex);
+   while (!feeder_pool.quit) {
+      ALLEGRO_AUDIO_STREAM *stream = next_stream_to_feed();
+      bool more;
+
+      if (!stream) {
+         al_wait_cond(feeder_pool.work_cond, feeder_pool.mutex);
+         continue;
+      }
+
+      stream->feeding = true;
+      stream->feed_requested = false;
+      al_unlock_mutex(feeder_pool.mutex);
+
+      more = feed_stream_fragment(stream);
+      if (!more) {
+         ALLEGRO_DEBUG("Stream feeder reached the end of a stream.\n");
+         stream->quit_feed_thread = true;
+         if (al_get_audio_stream_attached(stream)) {
+            /* The mixer stops the stream and emits the FINISHED event once
+             * the queued fragments have been played.
+             */
+            stream->is_draining = true;
+         }
+         else {
+            al_set_audio_stream_playing(stream, false);
+            emit_stream_finished(stream);
+         }
+      }
+
+      al_lock_mutex(feeder_pool.mutex);
+      stream->feeding = false;
+      if (more && stream->used_bufs[0])
+         stream->feed_requested = true;
+      al_broadcast_cond(feeder_pool.done_cond);
+   }
+   al_unlock_mutex(feeder_pool.mutex);
+
+   return NULL;
+}
+
+
+static bool init_feeder_pool(void)
+{
+   const char *p;
+   int n;
+   int i;
+
+   if (feeder_pool.initialised)
+      return feeder_pool.num_threads > 0;
+   feeder_pool.initialised = true;
+
+   p = al_get_config_value(al_get_system_config(), "audio",
+      "stream_feeder_threads");
+   n = p ? atoi(p) : 0;
+   if (n <= 0)
+      return false;
+
+   feeder_pool.mutex = al_create_mutex();
+   feeder_pool.work_cond = al_create_cond();
+   feeder_pool.done_cond = al_create_cond();
+   feeder_pool.threads = al_calloc(n, sizeof(ALLEGRO_THREAD *));
+   if (!feeder_pool.mutex || !feeder_pool.work_cond ||
+         !feeder_pool.done_cond || !feeder_pool.threads) {
+      ALLEGRO_ERROR("Unable to create the stream feeder pool\n");
+      _al_kcm_shutdown_stream_feeders();
+      feeder_pool.initialised = true;
+      return false;
+   }
+
+   for (i = 0; i < n; i++) {
+      ALLEGRO_THREAD *thread = al_create_thread(feeder_pool_thread, NULL);
+      if (!thread)
+         break;
+      feeder_pool.threads[feeder_pool.num_threads++] = thread;
+      al_start_thread(thread);
+   }
+
+   ALLEGRO_INFO("Feeding streams on %d worker threads\n",
+      feeder_pool.num_threads);
+
+   return feeder_pool.num_threads > 0;
+}
+
+
+/* _al_kcm_start_stream_feeder:
+ *  Starts feeding a stream loaded with al_load_audio_stream: from the feeder
+ *  pool if there is one, otherwise from a thread of its own.
+ */
+void _al_kcm_start_stream_feeder(ALLEGRO_AUDIO_STREAM *stream)
+{
+   ALLEGRO_AUDIO_STREAM **slot = NULL;
+
+   if (init_feeder_pool()) {
+      al_lock_mutex(feeder_pool.mutex);
+      slot = _al_vector_alloc_back(&feeder_pool.streams);
+      if (slot) {
+         *slot = stream;
+         stream->fed_by_pool = true;
+         stream->quit_feed_thread = false;
+         stream->feed_requested = false;
+         stream->feeding = false;
+      }
+      al_unlock_mutex(feeder_pool.mutex);
+      if (slot)
+         return;
+   }
+
+   stream->feed_thread = al_create_thread(_al_kcm_feed_stream, stream);
+   stream->feed_thread_started_cond = al_create_cond();
+   stream->feed_thread_started_mutex = al_create_mutex();
+   al_start_thread(stream->feed_thread);
+}
+
+
+/* _al_kcm_stop_stream_feeder:
+ *  Stops feeding the stream, waiting for a pool worker that is filling it or
+ *  its own thread to finish.  Does nothing if the stream is not being fed.
+ */
+void _al_kcm_stop_stream_feeder(ALLEGRO_AUDIO_STREAM *stream)
+{
+   ALLEGRO_EVENT quit_event;
+   bool finished;
+
+   if (stream->fed_by_pool) {
+      stream->fed_by_pool = false;
+
+      if (!feeder_pool.mutex)
+         return;
+
+      al_lock_mutex(feeder_pool.mutex);
+      _al_vector_find_and_delete(&feeder_pool.streams, &stream);
+      while (stream->feeding) {
+         al_wait_cond(feeder_pool.done_cond, feeder_pool.mutex);
+      }
+      finished = stream->quit_feed_thread;
+      stream->quit_feed_thread = true;
+      al_unlock_mutex(feeder_pool.mutex);
+
+      /* A feeder thread announces that it has quit in either case. */
+      if (!finished)
+         emit_stream_finished(stream);
+      return;
+   }
+
+   if (!stream->feed_thread)
+      return;
+
+   /* Need to wait for the thread to start, otherwise the quit event may be
+    * sent before the event source is registered with the queue. */
+   al_lock_mutex(stream->feed_thread_started_mutex);
+   while (!stream->feed_thread_started) {
+      al_wait_cond(stream->feed_thread_started_cond, stream->feed_thread_started_mutex);
+   }
+   al_unlock_mutex(stream->feed_thread_started_mutex);
+
+   quit_event.type = _KCM_STREAM_FEEDER_QUIT_EVENT_TYPE;
+   al_emit_user_event(al_get_audio_stream_event_source(stream), &quit_event, NULL);
+   al_join_thread(stream->feed_thread, NULL);
+   al_destroy_thread(stream->feed_thread);
+   al_destroy_cond(stream->feed_thread_started_cond);
+   al_destroy_mutex(stream->feed_thread_started_mutex);
+
+   stream->feed_thread = NULL;
+}
+
+
+/* _al_kcm_shutdown_stream_feeders:
+ *  Stops the stream feeder threads, if any were started.
+ */
+void _al_kcm_shutdown_stream_feeders(void)
+{
+   unsigned int i;
+   int j;
+
+   if (feeder_pool.mutex) {
+      al_lock_mutex(feeder_pool.mutex);
+      feeder_pool.quit = true;
+      al_broadcast_cond(feeder_pool.work_cond);
+      al_unlock_mutex(feeder_pool.mutex);
+   }
+
+   for (j = 0; j < feeder_pool.num_threads; j++) {
+      al_destroy_thread(feeder_pool.threads[j]);
+   }
+   al_free(feeder_pool.threads);
+   feeder_pool.threads = NULL;
+   feeder_pool.num_threads = 0;
+
+   /* Streams still loaded can no longer be fed. */
+   for (i = 0; i < _al_vector_size(&feeder_pool.streams); i++) {
+      ALLEGRO_AUDIO_STREAM **slot = _al_vector_ref(&feeder_pool.streams, i);
+      (*slot)->quit_feed_thread = true;
+   }
+   _al_vector_free(&feeder_pool.streams);
+
+   if (feeder_pool.done_cond)
+      al_destroy_cond(feeder_pool.done_cond);
+   if (feeder_pool.work_cond)
+      al_destroy_cond(feeder_pool.work_cond);
+   if (feeder_pool.mutex)
+      al_destroy_mutex(feeder_pool.mutex);
+   feeder_pool.done_cond = NULL;
+   feeder_pool.work_cond = NULL;
+   feeder_pool.mutex = NULL;
+   feeder_pool.quit = false;
+   feeder_pool.initialised = false;
+}
+
+
 void _al_kcm_emit_stream_events(ALLEGRO_AUDIO_STREAM *stream)
 {
    /* Emit one event for each stream fragment available right now.
@@ -771,6 +1122,21 @@ void _al_kcm_emit_stream_events(ALLEGRO_AUDIO_STREAM *stream)
     */
    int count = al_get_available_audio_stream_fragments(stream);
 
+   /* Streams with a fill callback are refilled by the mixer itself. */
+   if (stream->fill_callback)
+      return;
+
+   /* Streams fed by the pool are woken up directly. */
+   if (stream->fed_by_pool) {
+      if (count > 0 && feeder_pool.mutex) {
+         al_lock_mutex(feeder_pool.mutex);
+         stream->feed_requested = true;
+         al_signal_cond(feeder_pool.work_cond);
+         al_unlock_mutex(feeder_pool.mutex);
+      }
+      return;
+   }
+
    while (count--) {
       ALLEGRO_EVENT event;
       event.user.type = ALLEGRO_EVENT_AUDIO_STREAM_FRAGMENT;
@@ -780,6 +1146,32 @@ void _al_kcm_emit_stream_events(ALLEGRO_AUDIO_STREAM *stream)
 }
 
 
+/* Function: al_set_audio_stream_fill_callback
+ */
+bool al_set_audio_stream_fill_callback(ALLEGRO_AUDIO_STREAM *stream,
+   unsigned int (*cb)(ALLEGRO_AUDIO_STREAM *stream, void *buf,
+      unsigned int samples, void *data),
+   void *data)
+{
+   ASSERT(stream);
+
+   if (stream->feeder) {
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "Attempted to set a fill callback on a loaded stream");
+      return false;
+   }
+
+   maybe_lock_mutex(stream->spl.mutex);
+
+   stream->fill_callback = cb;
+   stream->fill_callback_userdata = data;
+
+   maybe_unlock_mutex(stream->spl.mutex);
+
+   return true;
+}
+
+
 /* Function: al_rewind_audio_stream
  */
 bool al_rewind_audio_stream(ALLEGRO_AUDIO_STREAM *stream)
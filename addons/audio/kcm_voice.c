@@ -50,9 +50,16 @@ const void *_al_voice_update(ALLEGRO_VOICE *voice, ALLEGRO_MUTEX *mutex,
 
    al_lock_mutex(voice->mutex);
    if (voice->attached_stream) {
+      const bool was_playing = voice->attached_stream->is_playing;
+      const unsigned int requested = *samples;
+      const double start = al_get_time();
       ASSERT(voice->attached_stream->spl_read);
       voice->attached_stream->spl_read(voice->attached_stream, &buf, samples,
          voice->depth, 0);
+      _al_kcm_add_mix_time(&voice->stats, start, al_get_time(),
+         (double)requested / voice->frequency);
+      if (was_playing && !buf)
+         voice->stats.underruns++;
    }
    al_unlock_mutex(voice->mutex);
 
@@ -145,6 +152,20 @@ bool al_attach_sample_instance_to_voice(ALLEGRO_SAMPLE_INSTANCE *spl,
       return false;
    }
 
+   if (spl->spl_data.adpcm) {
+      ALLEGRO_WARN("ADPCM samples must be played through a mixer\n");
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "ADPCM samples must be played through a mixer");
+      return false;
+   }
+
+   if (spl->spl_data.compressed) {
+      ALLEGRO_WARN("Compressed samples must be played through a mixer\n");
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "Compressed samples must be played through a mixer");
+      return false;
+   }
+
    if (voice->chan_conf != spl->spl_data.chan_conf ||
       voice->frequency != spl->spl_data.frequency ||
       voice->depth != spl->spl_data.depth)
@@ -0,0 +1,458 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Null audio driver.
+ *
+ *      Pulls audio from the voice without a sound device, either paced in
+ *      real time or as fast as possible, and optionally writes it to a
+ *      WAV file.  Useful for headless machines and for benchmarking.
+ *
+ *      See readme.txt for copyright information.
+ */
+
+#include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_audio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+ALLEGRO_DEBUG_CHANNEL("null_audio")
+
+
+/* Default number of frames pulled from the voice per update. */
+#define NULL_BUFFER_SIZE   1024
+
+static bool null_realtime = true;
+static unsigned int null_buffer_size = NULL_BUFFER_SIZE;
+static char null_wav_file[512];
+
+
+typedef struct NULL_VOICE {
+   unsigned int frame_size; /* in bytes */
+   unsigned int buffer_size; /* in frames */
+   void *silence;
+
+   volatile bool stopped;
+   volatile bool stop;
+
+   ALLEGRO_FILE *wav;
+   int64_t wav_bytes;
+
+   /* Timing statistics, reported when the voice is destroyed. */
+   uint64_t frames;
+   uint64_t updates;
+   double start_time;
+   double mix_time;
+   double max_update_time;
+
+   ALLEGRO_THREAD *thread;
+} NULL_VOICE;
+
+
+static int null_open(void)
+{
+   ALLEGRO_CONFIG *config = al_get_system_config();
+   const char *value;
+
+   null_realtime = true;
+   null_buffer_size = NULL_BUFFER_SIZE;
+   null_wav_file[0] = '\0';
+
+   if (config) {
+      value = al_get_config_value(config, "null_audio", "mode");
+      if (value && !_al_stricmp(value, "fast")) {
+         null_realtime = false;
+      }
+
+      value = al_get_config_value(config, "null_audio", "buffer_size");
+      if (value && atoi(value) > 0) {
+         null_buffer_size = atoi(value);
+      }
+
+      value = al_get_config_value(config, "null_audio", "wav_file");
+      if (value) {
+         _al_sane_strncpy(null_wav_file, value, sizeof(null_wav_file));
+      }
+   }
+
+   ALLEGRO_INFO("Mixing %s, %u frames per update\n",
+      null_realtime ? "in real time" : "as fast as possible",
+      null_buffer_size);
+
+   return 0;
+}
+
+
+static void null_close(void)
+{
+}
+
+
+/* WAV output.  The sizes in the header are filled in when the voice is
+ * destroyed.
+ */
+static bool wav_depth_supported(ALLEGRO_AUDIO_DEPTH depth)
+{
+   return depth == ALLEGRO_AUDIO_DEPTH_UINT8 ||
+      depth == ALLEGRO_AUDIO_DEPTH_INT16 ||
+      depth == ALLEGRO_AUDIO_DEPTH_FLOAT32;
+}
+
+
+static bool wav_write_header(ALLEGRO_FILE *f, ALLEGRO_VOICE *voice,
+   int64_t data_bytes)
+{
+   const int channels = al_get_channel_count(voice->chan_conf);
+   const int bits = al_get_audio_depth_size(voice->depth) * 8;
+   const int format = (voice->depth == ALLEGRO_AUDIO_DEPTH_FLOAT32) ? 3 : 1;
+
+   al_fputs(f, "RIFF");
+   al_fwrite32le(f, 36 + data_bytes);
+   al_fputs(f, "WAVE");
+
+   al_fputs(f, "fmt ");
+   al_fwrite32le(f, 16);
+   al_fwrite16le(f, format);
+   al_fwrite16le(f, channels);
+   al_fwrite32le(f, voice->frequency);
+   al_fwrite32le(f, voice->frequency * channels * bits / 8);
+   al_fwrite16le(f, channels * bits / 8);
+   al_fwrite16le(f, bits);
+
+   al_fputs(f, "data");
+   al_fwrite32le(f, data_bytes);
+
+   return !al_ferror(f);
+}
+
+
+static void wav_write_data(NULL_VOICE *nv, ALLEGRO_VOICE *voice,
+   const void *data, unsigned int frames)
+{
+   const size_t samples = frames * al_get_channel_count(voice->chan_conf);
+   size_t i;
+
+   switch (voice->depth) {
+      case ALLEGRO_AUDIO_DEPTH_UINT8:
+         al_fwrite(nv->wav, data, samples);
+         break;
+
+      case ALLEGRO_AUDIO_DEPTH_INT16: {
+         const int16_t *p = data;
+         for (i = 0; i < samples; i++) {
+            al_fwrite16le(nv->wav, p[i]);
+         }
+         break;
+      }
+
+      case ALLEGRO_AUDIO_DEPTH_FLOAT32: {
+         const float *p = data;
+         for (i = 0; i < samples; i++) {
+            uint32_t bits;
+            memcpy(&bits, &p[i], sizeof(bits));
+            al_fwrite32le(nv->wav, bits);
+         }
+         break;
+      }
+
+      default:
+         ASSERT(false);
+         return;
+   }
+
+   nv->wav_bytes += frames * nv->frame_size;
+}
+
+
+static void wav_close(NULL_VOICE *nv, ALLEGRO_VOICE *voice)
+{
+   if (!nv->wav)
+      return;
+
+   if (al_fseek(nv->wav, 0, ALLEGRO_SEEK_SET))
+      wav_write_header(nv->wav, voice, nv->wav_bytes);
+   al_fclose(nv->wav);
+   nv->wav = NULL;
+}
+
+
+/* Reads the next chunk of a non-streaming voice directly from the attached
+ * sample, like the OSS driver does.
+ */
+static const void *null_update_nonstream_voice(ALLEGRO_VOICE *voice,
+   NULL_VOICE *nv, unsigned int *frames)
+{
+   ALLEGRO_SAMPLE_INSTANCE *spl = voice->attached_stream;
+   const int len = spl->spl_data.len;
+   const void *buf;
+
+   if (spl->pos >= len) {
+      if (spl->loop == ALLEGRO_PLAYMODE_ONCE) {
+         nv->stop = true;
+         spl->pos = 0;
+         return NULL;
+      }
+      spl->pos = 0;
+   }
+
+   buf = (const char *)spl->spl_data.buffer.ptr + spl->pos * nv->frame_size;
+   if (spl->pos + (int)*frames > len)
+      *frames = len - spl->pos;
+   spl->pos += *frames;
+
+   return buf;
+}
+
+
+static void *null_update(ALLEGRO_THREAD *self, void *arg)
+{
+   ALLEGRO_VOICE *voice = arg;
+   NULL_VOICE *nv = voice->extra;
+   uint64_t paced_frames = 0;
+   double pace_start = al_get_time();
+
+   nv->start_time = pace_start;
+
+   while (!al_get_thread_should_stop(self)) {
+      unsigned int frames = nv->buffer_size;
+      const void *data = NULL;
+      double t0, t1;
+
+      if (nv->stop != nv->stopped) {
+         nv->stopped = nv->stop;
+         paced_frames = 0;
+         pace_start = al_get_time();
+      }
+
+      if (nv->stopped) {
+         al_rest(0.001);
+         continue;
+      }
+
+      t0 = al_get_time();
+      if (voice->is_streaming) {
+         data = _al_voice_update(voice, voice->mutex, &frames);
+      }
+      else {
+         data = null_update_nonstream_voice(voice, nv, &frames);
+      }
+      t1 = al_get_time();
+
+      if (!data) {
+         /* Play silence for the voice. */
+         data = nv->silence;
+         frames = nv->buffer_size;
+      }
+      else {
+         nv->mix_time += t1 - t0;
+         if (t1 - t0 > nv->max_update_time)
+            nv->max_update_time = t1 - t0;
+         nv->updates++;
+      }
+
+      nv->frames += frames;
+
+      if (nv->wav) {
+         wav_write_data(nv, voice, data, frames);
+      }
+
+      if (null_realtime) {
+         double due;
+
+         paced_frames += frames;
+         due = pace_start + (double)paced_frames / voice->frequency;
+         if (due > al_get_time()) {
+            al_rest(due - al_get_time());
+         }
+      }
+   }
+
+   return NULL;
+}
+
+
+static int null_allocate_voice(ALLEGRO_VOICE *voice)
+{
+   NULL_VOICE *nv = al_calloc(1, sizeof(NULL_VOICE));
+   if (!nv)
+      return 1;
+
+   nv->frame_size = al_get_channel_count(voice->chan_conf) *
+      al_get_audio_depth_size(voice->depth);
+   nv->buffer_size = voice->buffer_size ? voice->buffer_size :
+      null_buffer_size;
+   nv->stop = true;
+   nv->stopped = true;
+
+   nv->silence = al_malloc(nv->buffer_size * nv->frame_size);
+   if (!nv->silence) {
+      al_free(nv);
+      return 1;
+   }
+   al_fill_silence(nv->silence, nv->buffer_size, voice->depth,
+      voice->chan_conf);
+
+   if (null_wav_file[0] != '\0') {
+      if (!wav_depth_supported(voice->depth)) {
+         ALLEGRO_WARN("Cannot write voice depth %d to WAV.\n", voice->depth);
+      }
+      else {
+         nv->wav = al_fopen(null_wav_file, "wb");
+         if (!nv->wav || !wav_write_header(nv->wav, voice, 0)) {
+            ALLEGRO_ERROR("Failed to open %s for writing.\n", null_wav_file);
+            if (nv->wav)
+               al_fclose(nv->wav);
+            nv->wav = NULL;
+         }
+         else {
+            ALLEGRO_INFO("Writing voice output to %s\n", null_wav_file);
+         }
+      }
+   }
+
+   voice->extra = nv;
+   nv->thread = al_create_thread(null_update, voice);
+   if (!nv->thread) {
+      wav_close(nv, voice);
+      al_free(nv->silence);
+      al_free(nv);
+      voice->extra = NULL;
+      return 1;
+   }
+   al_start_thread(nv->thread);
+
+   return 0;
+}
+
+
+static void null_deallocate_voice(ALLEGRO_VOICE *voice)
+{
+   NULL_VOICE *nv = voice->extra;
+   double elapsed;
+
+   /* We do NOT hold the voice mutex here, so this does NOT result in a
+    * deadlock when null_update calls _al_voice_update.
+    */
+   al_join_thread(nv->thread, NULL);
+   al_destroy_thread(nv->thread);
+
+   elapsed = al_get_time() - nv->start_time;
+   ALLEGRO_INFO("Voice produced %.3f s of audio (%lu frames) in %.3f s\n",
+      (double)nv->frames / voice->frequency, (unsigned long)nv->frames,
+      elapsed);
+   if (nv->updates > 0) {
+      ALLEGRO_INFO("Mixing took %.3f s over %lu updates: "
+         "%.3f ms average, %.3f ms worst, %.1fx real time\n",
+         nv->mix_time, (unsigned long)nv->updates,
+         1000.0 * nv->mix_time / nv->updates,
+         1000.0 * nv->max_update_time,
+         (nv->mix_time > 0.0) ?
+            ((double)nv->frames / voice->frequency) / nv->mix_time : 0.0);
+   }
+
+   wav_close(nv, voice);
+   al_free(nv->silence);
+   al_free(nv);
+   voice->extra = NULL;
+}
+
+
+static int null_load_voice(ALLEGRO_VOICE *voice, const void *data)
+{
+   if (voice->attached_stream->loop == ALLEGRO_PLAYMODE_BIDIR) {
+      ALLEGRO_INFO("Backwards playing not supported by the driver.\n");
+      return -1;
+   }
+
+   voice->attached_stream->pos = 0;
+
+   return 0;
+   (void)data;
+}
+
+
+static void null_unload_voice(ALLEGRO_VOICE *voice)
+{
+   (void)voice;
+}
+
+
+static int null_start_voice(ALLEGRO_VOICE *voice)
+{
+   NULL_VOICE *nv = voice->extra;
+   nv->stop = false;
+   return 0;
+}
+
+
+static int null_stop_voice(ALLEGRO_VOICE *voice)
+{
+   NULL_VOICE *nv = voice->extra;
+
+   nv->stop = true;
+   if (!voice->is_streaming) {
+      voice->attached_stream->pos = 0;
+   }
+
+   while (!nv->stopped)
+      al_rest(0.001);
+
+   return 0;
+}
+
+
+static bool null_voice_is_playing(const ALLEGRO_VOICE *voice)
+{
+   NULL_VOICE *nv = voice->extra;
+   return !nv->stopped;
+}
+
+
+static unsigned int null_get_voice_position(const ALLEGRO_VOICE *voice)
+{
+   return voice->attached_stream->pos;
+}
+
+
+static int null_set_voice_position(ALLEGRO_VOICE *voice, unsigned int val)
+{
+   voice->attached_stream->pos = val;
+   return 0;
+}
+
+
+ALLEGRO_AUDIO_DRIVER _al_kcm_null_driver =
+{
+   "null",
+
+   null_open,
+   null_close,
+
+   null_allocate_voice,
+   null_deallocate_voice,
+
+   null_load_voice,
+   null_unload_voice,
+
+   null_start_voice,
+   null_stop_voice,
+
+   null_voice_is_playing,
+
+   null_get_voice_position,
+   null_set_voice_position,
+
+   NULL,
+   NULL
+};
+
+/* vim: set sts=3 sw=3 et: */
@@ -404,7 +404,6 @@ static void *pulse_audio_update_recorder(ALLEGRO_THREAD *t, void *data)
 {
    ALLEGRO_AUDIO_RECORDER *r = (ALLEGRO_AUDIO_RECORDER *) data;
    PULSEAUDIO_RECORDER *pa = (PULSEAUDIO_RECORDER *) r->extra;
-   ALLEGRO_EVENT user_event;
    uint8_t *null_buffer;
    unsigned int fragment_i = 0;
    
@@ -425,14 +424,11 @@ static void *pulse_audio_update_recorder(ALLEGRO_THREAD *t, void *data)
          pa_simple_read(pa->s, null_buffer, 1024, NULL);
       }
       else {
-         ALLEGRO_AUDIO_RECORDER_EVENT *e;
          al_unlock_mutex(r->mutex);
          if (pa_simple_read(pa->s, r->fragments[fragment_i], r->fragment_size, NULL) >= 0) {
-            user_event.user.type = ALLEGRO_EVENT_AUDIO_RECORDER_FRAGMENT;
-            e = al_get_audio_recorder_event(&user_event);
-            e->buffer = r->fragments[fragment_i];
-            e->samples = r->samples;           
-            al_emit_user_event(&r->source, &user_event, NULL);
+            al_lock_mutex(r->mutex);
+            _al_kcm_emit_recorder_fragment(r, r->fragments[fragment_i], r->samples);
+            al_unlock_mutex(r->mutex);
          
             if (++fragment_i == r->fragment_count) {
                fragment_i = 0;
@@ -71,7 +71,10 @@ ALLEGRO_AUDIO_RECORDER *al_create_audio_recorder(size_t fragment_count,
    }
   
    r->is_recording = false;
-   r->mutex = al_create_mutex();
+   /* Recursive, so that a recorder callback run with the mutex held may
+    * call the recorder functions.
+    */
+   r->mutex = al_create_mutex_recursive();
    r->cond = al_create_cond();
    
    al_init_user_event_source(&r->source);
@@ -162,5 +165,188 @@ void al_destroy_audio_recorder(ALLEGRO_AUDIO_RECORDER *r)
    al_destroy_mutex(r->mutex);
    al_destroy_cond(r->cond);
    
+   al_free(r->ring);
    al_free(r);
-}
\ No newline at end of file
+}
+
+
+/* Copies as many of the samples as fit into the ring, dropping the rest. */
+static void push_ring(ALLEGRO_AUDIO_RECORDER *r, const char *buffer,
+   unsigned int samples)
+{
+   const unsigned int write = (unsigned int)r->ring_write;
+   const unsigned int read = (unsigned int)_al_atomic_load(&r->ring_read);
+   const unsigned int space = r->ring_size - (write - read);
+   const unsigned int pos = write & (r->ring_size - 1);
+   unsigned int n = samples < space ? samples : space;
+   unsigned int first = r->ring_size - pos;
+
+   if (first > n)
+      first = n;
+   memcpy(r->ring + pos * r->sample_size, buffer, first * r->sample_size);
+   memcpy(r->ring, buffer + first * r->sample_size,
+      (n - first) * r->sample_size);
+
+   _al_atomic_store(&r->ring_write, (_AL_ATOMIC)(write + n));
+
+   if (n < samples) {
+      _al_atomic_store(&r->ring_dropped,
+         (_AL_ATOMIC)((unsigned int)r->ring_dropped + samples - n));
+   }
+}
+
+
+/* _al_kcm_emit_recorder_fragment:
+ *  Hands a captured fragment to the user.  The driver thread calls this with
+ *  the recorder mutex held.
+ */
+void _al_kcm_emit_recorder_fragment(ALLEGRO_AUDIO_RECORDER *r,
+   void *buffer, unsigned int samples)
+{
+   if (r->ring) {
+      push_ring(r, buffer, samples);
+   }
+
+   if (r->callback) {
+      r->callback(buffer, samples, r->callback_data);
+   }
+   else {
+      ALLEGRO_EVENT user_event;
+      ALLEGRO_AUDIO_RECORDER_EVENT *e;
+      user_event.user.type = ALLEGRO_EVENT_AUDIO_RECORDER_FRAGMENT;
+      e = al_get_audio_recorder_event(&user_event);
+      e->buffer = buffer;
+      e->samples = samples;
+      al_emit_user_event(&r->source, &user_event, NULL);
+   }
+}
+
+
+/* Function: al_set_audio_recorder_callback
+ */
+bool al_set_audio_recorder_callback(ALLEGRO_AUDIO_RECORDER *r,
+   void (*callback)(void *buf, unsigned int samples, void *data), void *data)
+{
+   ASSERT(r);
+
+   al_lock_mutex(r->mutex);
+   r->callback = callback;
+   r->callback_data = data;
+   al_unlock_mutex(r->mutex);
+
+   return true;
+}
+
+
+/* Function: al_set_audio_recorder_ring_size
+ */
+bool al_set_audio_recorder_ring_size(ALLEGRO_AUDIO_RECORDER *r,
+   unsigned int samples)
+{
+   unsigned int size = 0;
+   char *ring = NULL;
+
+   ASSERT(r);
+
+   if (samples > (1U << 30) / r->sample_size) {
+      _al_set_error(ALLEGRO_INVALID_PARAM, "Recorder ring too large");
+      return false;
+   }
+
+   /* Round up to a power of two, so that the positions may wrap around. */
+   if (samples > 0) {
+      size = 1;
+      while (size < samples)
+         size <<= 1;
+      ring = al_malloc(size * r->sample_size);
+      if (!ring) {
+         _al_set_error(ALLEGRO_GENERIC_ERROR,
+            "Out of memory allocating recorder ring");
+         return false;
+      }
+   }
+
+   al_lock_mutex(r->mutex);
+
+   if (r->is_recording) {
+      al_unlock_mutex(r->mutex);
+      al_free(ring);
+      _al_set_error(ALLEGRO_INVALID_OBJECT,
+         "Attempted to resize the ring of a recording recorder");
+      return false;
+   }
+
+   al_free(r->ring);
+   r->ring = ring;
+   r->ring_size = size;
+   r->ring_write = 0;
+   r->ring_read = 0;
+   r->ring_dropped = 0;
+
+   al_unlock_mutex(r->mutex);
+
+   return true;
+}
+
+
+/* Function: al_get_audio_recorder_ring_size
+ */
+unsigned int al_get_audio_recorder_ring_size(ALLEGRO_AUDIO_RECORDER *r)
+{
+   ASSERT(r);
+
+   return r->ring_size;
+}
+
+
+/* Function: al_read_audio_recorder
+ */
+unsigned int al_read_audio_recorder(ALLEGRO_AUDIO_RECORDER *r, void *buf,
+   unsigned int samples)
+{
+   unsigned int read, available, pos, n, first;
+
+   ASSERT(r);
+   ASSERT(buf);
+
+   if (!r->ring)
+      return 0;
+
+   read = (unsigned int)r->ring_read;
+   available = (unsigned int)_al_atomic_load(&r->ring_write) - read;
+   pos = read & (r->ring_size - 1);
+   n = samples < available ? samples : available;
+   first = r->ring_size - pos;
+   if (first > n)
+      first = n;
+
+   memcpy(buf, r->ring + pos * r->sample_size, first * r->sample_size);
+   memcpy((char *)buf + first * r->sample_size, r->ring,
+      (n - first) * r->sample_size);
+
+   _al_atomic_store(&r->ring_read, (_AL_ATOMIC)(read + n));
+
+   return n;
+}
+
+
+/* Function: al_get_available_audio_recorder_samples
+ */
+unsigned int al_get_available_audio_recorder_samples(
+   ALLEGRO_AUDIO_RECORDER *r)
+{
+   ASSERT(r);
+
+   return (unsigned int)_al_atomic_load(&r->ring_write) -
+      (unsigned int)_al_atomic_load(&r->ring_read);
+}
+
+
+/* Function: al_get_dropped_audio_recorder_samples
+ */
+unsigned int al_get_dropped_audio_recorder_samples(ALLEGRO_AUDIO_RECORDER *r)
+{
+   ASSERT(r);
+
+   return (unsigned int)_al_atomic_load(&r->ring_dropped);
+}
@@ -0,0 +1,244 @@
+/*
+ * Loading many samples at once on worker threads.
+ */
+
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_audio.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_audio.h"
+
+ALLEGRO_DEBUG_CHANNEL("audio")
+
+
+struct ALLEGRO_SAMPLE_BATCH {
+   char **filenames;
+   ALLEGRO_SAMPLE **samples;
+   int count;
+
+   ALLEGRO_THREAD **threads;
+   int num_threads;
+
+   const ALLEGRO_FILE_INTERFACE *file_interface;
+                        /* The caller's, for the workers to load with. */
+
+   ALLEGRO_MUTEX *mutex;
+   int next;            /* The next file to load. */
+   bool cancelled;
+
+   ALLEGRO_EVENT_SOURCE es;
+};
+
+
+static void *sample_batch_thread(ALLEGRO_THREAD *self, void *arg)
+{
+   ALLEGRO_SAMPLE_BATCH *batch = arg;
+   (void)self;
+
+   /* The file interface is per thread, so a new thread would otherwise
+    * load with stdio.
+    */
+   al_set_new_file_interface(batch->file_interface);
+
+   al_lock_mutex(batch->mutex);
+   while (!batch->cancelled && batch->next < batch->count) {
+      const int i = batch->next++;
+      ALLEGRO_SAMPLE *spl;
+      ALLEGRO_EVENT event;
+
+      al_unlock_mutex(batch->mutex);
+      spl = al_load_sample(batch->filenames[i]);
+      if (!spl) {
+         ALLEGRO_WARN("Unable to load %s\n", batch->filenames[i]);
+      }
+      al_lock_mutex(batch->mutex);
+
+      /* Nobody wants the sample any more. */
+      if (batch->cancelled) {
+         al_unlock_mutex(batch->mutex);
+         al_destroy_sample(spl);
+         al_lock_mutex(batch->mutex);
+         break;
+      }
+
+      batch->samples[i] = spl;
+      al_unlock_mutex(batch->mutex);
+
+      event.user.type = ALLEGRO_EVENT_AUDIO_SAMPLE_LOADED;
+      event.user.timestamp = al_get_time();
+      event.user.data1 = i;
+      event.user.data2 = (intptr_t)spl;
+      al_emit_user_event(&batch->es, &event, NULL);
+
+      al_lock_mutex(batch->mutex);
+   }
+   al_unlock_mutex(batch->mutex);
+
+   return NULL;
+}
+
+
+static void free_sample_batch(ALLEGRO_SAMPLE_BATCH *batch)
+{
+   int i;
+
+   if (batch->filenames) {
+      for (i = 0; i < batch->count; i++)
+         al_free(batch->filenames[i]);
+   }
+   al_free(batch->filenames);
+   al_free(batch->samples);
+   al_free(batch->threads);
+   if (batch->mutex)
+      al_destroy_mutex(batch->mutex);
+   al_free(batch);
+}
+
+
+/* Function: al_load_samples_async
+ */
+ALLEGRO_SAMPLE_BATCH *al_load_samples_async(const char * const *filenames,
+   int count, int threads)
+{
+   ALLEGRO_SAMPLE_BATCH *batch;
+   int i;
+
+   ASSERT(filenames || count == 0);
+
+   batch = al_calloc(1, sizeof(*batch));
+   if (!batch) {
+      _al_set_error(ALLEGRO_GENERIC_ERROR,
+         "Out of memory allocating sample batch");
+      return NULL;
+   }
+
+   if (threads <= 0)
+      threads = al_get_cpu_count();
+   if (threads > count)
+      threads = count;
+   if (threads < 1)
+      threads = 1;
+
+   batch->count = count;
+   batch->filenames = al_calloc(count + 1, sizeof(char *));
+   batch->samples = al_calloc(count + 1, sizeof(ALLEGRO_SAMPLE *));
+   batch->threads = al_calloc(threads, sizeof(ALLEGRO_THREAD *));
+   batch->mutex = al_create_mutex();
+   if (!batch->filenames || !batch->samples || !batch->threads ||
+         !batch->mutex) {
+      _al_set_error(ALLEGRO_GENERIC_ERROR,
+         "Out of memory allocating sample batch");
+      free_sample_batch(batch);
+      return NULL;
+   }
+
+   for (i = 0; i < count; i++) {
+      size_t len = strlen(filenames[i]);
+      batch->filenames[i] = al_malloc(len + 1);
+      if (!batch->filenames[i]) {
+         _al_set_error(ALLEGRO_GENERIC_ERROR,
+            "Out of memory allocating sample batch");
+         free_sample_batch(batch);
+         return NULL;
+      }
+      memcpy(batch->filenames[i], filenames[i], len + 1);
+   }
+
+   batch->file_interface = al_get_new_file_interface();
+   al_init_user_event_source(&batch->es);
+
+   /* Set up the sample cache before the workers race to do it. */
+   al_get_sample_cache_stats(NULL, NULL, NULL);
+
+   for (i = 0; i < threads; i++) {
+      ALLEGRO_THREAD *thread = al_create_thread(sample_batch_thread, batch);
+      if (!thread)
+         break;
+      batch->threads[batch->num_threads++] = thread;
+      al_start_thread(thread);
+   }
+
+   if (batch->num_threads == 0 && count > 0) {
+      _al_set_error(ALLEGRO_GENERIC_ERROR,
+         "Unable to create sample loading threads");
+      al_destroy_user_event_source(&batch->es);
+      free_sample_batch(batch);
+      return NULL;
+   }
+
+   return batch;
+}
+
+
+/* Function: al_get_sample_batch_event_source
+ */
+ALLEGRO_EVENT_SOURCE *al_get_sample_batch_event_source(
+   ALLEGRO_SAMPLE_BATCH *batch)
+{
+   ASSERT(batch);
+
+   return &batch->es;
+}
+
+
+/* Function: al_get_sample_batch_sample
+ */
+ALLEGRO_SAMPLE *al_get_sample_batch_sample(ALLEGRO_SAMPLE_BATCH *batch,
+   int index)
+{
+   ALLEGRO_SAMPLE *spl;
+
+   ASSERT(batch);
+   ASSERT(index >= 0 && index < batch->count);
+
+   al_lock_mutex(batch->mutex);
+   spl = batch->samples[index];
+   al_unlock_mutex(batch->mutex);
+
+   return spl;
+}
+
+
+/* Function: al_cancel_sample_batch
+ */
+void al_cancel_sample_batch(ALLEGRO_SAMPLE_BATCH *batch)
+{
+   ASSERT(batch);
+
+   al_lock_mutex(batch->mutex);
+   batch->cancelled = true;
+   al_unlock_mutex(batch->mutex);
+}
+
+
+/* Function: al_wait_for_sample_batch
+ */
+void al_wait_for_sample_batch(ALLEGRO_SAMPLE_BATCH *batch)
+{
+   int i;
+
+   ASSERT(batch);
+
+   for (i = 0; i < batch->num_threads; i++) {
+      al_join_thread(batch->threads[i], NULL);
+      al_destroy_thread(batch->threads[i]);
+   }
+   batch->num_threads = 0;
+}
+
+
+/* Function: al_destroy_sample_batch
+ */
+void al_destroy_sample_batch(ALLEGRO_SAMPLE_BATCH *batch)
+{
+   if (!batch)
+      return;
+
+   al_cancel_sample_batch(batch);
+   al_wait_for_sample_batch(batch);
+
+   al_destroy_user_event_source(&batch->es);
+   free_sample_batch(batch);
+}
+
+
+/* vim: set sts=3 sw=3 et: */
@@ -0,0 +1,329 @@
+/*
+ * Cache of decoded samples, shared between the samples loaded from the same
+ * file.
+ */
+
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_audio.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_audio.h"
+#include "allegro5/internal/aintern_vector.h"
+
+ALLEGRO_DEBUG_CHANNEL("audio")
+
+
+/* One decoded file.  The entry owns the sample data; the ALLEGRO_SAMPLE
+ * objects handed out by al_load_sample point into it and hold a reference.
+ * Entries nobody references any more stay cached until the total size goes
+ * over the budget.
+ */
+struct SAMPLE_CACHE_ENTRY {
+   char *path;
+   const ALLEGRO_FILE_INTERFACE *file_interface;
+   ALLEGRO_SAMPLE data;
+   size_t size;
+   int refcount;
+};
+
+
+static struct {
+   bool initialised;
+   ALLEGRO_MUTEX *mutex;
+   size_t budget;
+   size_t size;
+   unsigned int hits;
+   unsigned int misses;
+   _AL_VECTOR entries;
+                     /* Least recently used first. */
+} cache = { false, NULL, 0, 0, 0, 0,
+   _AL_VECTOR_INITIALIZER(SAMPLE_CACHE_ENTRY *) };
+
+
+static void destroy_entry(SAMPLE_CACHE_ENTRY *entry)
+{
+   al_free(entry->data.buffer.ptr);
+   al_free(entry->path);
+   al_free(entry);
+}
+
+
+static void free_entry(SAMPLE_CACHE_ENTRY *entry)
+{
+   /* Instances may still be playing the data, if they were created from a
+    * sample that has since been destroyed.
+    */
+   _al_kcm_stop_sample_instances(entry->data.buffer.ptr);
+   destroy_entry(entry);
+}
+
+
+/* Evicts the least recently used entries nobody references until the cache
+ * fits in the budget.  Called with the mutex held.
+ */
+static void trim_cache(void)
+{
+   unsigned int i = 0;
+
+   while (cache.size > cache.budget && i < _al_vector_size(&cache.entries)) {
+      SAMPLE_CACHE_ENTRY **slot = _al_vector_ref(&cache.entries, i);
+      SAMPLE_CACHE_ENTRY *entry = *slot;
+
+      if (entry->refcount > 0) {
+         i++;
+         continue;
+      }
+
+      ALLEGRO_DEBUG("Evicting %s from the sample cache\n", entry->path);
+      cache.size -= entry->size;
+      _al_vector_delete_at(&cache.entries, i);
+      free_entry(entry);
+   }
+}
+
+
+/* _al_kcm_shutdown_sample_cache:
+ *  Frees the cache.  Called by al_uninstall_audio once the destructors have
+ *  destroyed the samples and instances, so nothing is playing the entries
+ *  and normally nothing references them any more.  Any that are still
+ *  referenced are left to be freed by _al_kcm_release_cached_sample.
+ */
+void _al_kcm_shutdown_sample_cache(void)
+{
+   unsigned int i;
+
+   for (i = 0; i < _al_vector_size(&cache.entries); i++) {
+      SAMPLE_CACHE_ENTRY **slot = _al_vector_ref(&cache.entries, i);
+      if ((*slot)->refcount == 0)
+         destroy_entry(*slot);
+   }
+   _al_vector_free(&cache.entries);
+
+   if (cache.mutex)
+      al_destroy_mutex(cache.mutex);
+   cache.mutex = NULL;
+   cache.budget = 0;
+   cache.size = 0;
+   cache.hits = 0;
+   cache.misses = 0;
+   cache.initialised = false;
+}
+
+
+static bool init_sample_cache(void)
+{
+   const char *p;
+
+   if (cache.initialised)
+      return cache.mutex != NULL;
+   cache.initialised = true;
+
+   cache.mutex = al_create_mutex();
+   if (!cache.mutex) {
+      ALLEGRO_ERROR("Unable to create the sample cache mutex\n");
+      return false;
+   }
+
+   p = al_get_config_value(al_get_system_config(), "audio",
+      "sample_cache_size");
+   if (p && p[0] != '\0')
+      cache.budget = strtoul(p, NULL, 10);
+
+   return true;
+}
+
+
+/* Hands out a new sample referencing the entry.  Called with the mutex
+ * held.
+ */
+static ALLEGRO_SAMPLE *reference_entry(SAMPLE_CACHE_ENTRY *entry)
+{
+   ALLEGRO_SAMPLE *spl;
+
+   spl = al_create_sample(entry->data.buffer.ptr, entry->data.len,
+      entry->data.frequency, entry->data.depth, entry->data.chan_conf, false);
+   if (!spl)
+      return NULL;
+
+   spl->cache_entry = entry;
+   entry->refcount++;
+   return spl;
+}
+
+
+static int find_entry(const char *path, const ALLEGRO_FILE_INTERFACE *fi)
+{
+   unsigned int i;
+
+   for (i = 0; i < _al_vector_size(&cache.entries); i++) {
+      SAMPLE_CACHE_ENTRY **slot = _al_vector_ref(&cache.entries, i);
+      if ((*slot)->file_interface == fi && !strcmp((*slot)->path, path))
+         return i;
+   }
+
+   return -1;
+}
+
+
+/* _al_kcm_load_cached_sample:
+ *  Loads a sample through `loader', sharing the sample data with any other
+ *  sample loaded from the same path with the same file interface.  Falls
+ *  back to plain loading if the cache is disabled.
+ */
+ALLEGRO_SAMPLE *_al_kcm_load_cached_sample(const char *filename,
+   ALLEGRO_SAMPLE *(*loader)(const char *filename))
+{
+   const ALLEGRO_FILE_INTERFACE *fi = al_get_new_file_interface();
+   SAMPLE_CACHE_ENTRY *entry;
+   SAMPLE_CACHE_ENTRY **slot;
+   ALLEGRO_SAMPLE *spl;
+   size_t len;
+   int i;
+
+   if (!init_sample_cache() || cache.budget == 0)
+      return loader(filename);
+
+   al_lock_mutex(cache.mutex);
+   i = find_entry(filename, fi);
+   if (i >= 0) {
+      slot = _al_vector_ref(&cache.entries, i);
+      entry = *slot;
+      /* Move it to the most recently used end. */
+      _al_vector_delete_at(&cache.entries, i);
+      slot = _al_vector_alloc_back(&cache.entries);
+      *slot = entry;
+      spl = reference_entry(entry);
+      if (spl)
+         cache.hits++;
+      al_unlock_mutex(cache.mutex);
+      return spl;
+   }
+   cache.misses++;
+   al_unlock_mutex(cache.mutex);
+
+   /* Decode without the mutex held, so that other files can be loaded
+    * meanwhile.  Two threads loading the same file both decode it; the
+    * second one to finish shares the first one's data.
+    */
+   spl = loader(filename);
+   if (!spl || !spl->free_buf)
+      return spl;
+
+   entry = al_calloc(1, sizeof(*entry));
+   len = strlen(filename);
+   if (entry)
+      entry->path = al_malloc(len + 1);
+   if (!entry || !entry->path) {
+      al_free(entry);
+      return spl;
+   }
+   memcpy(entry->path, filename, len + 1);
+   entry->file_interface = fi;
+
+   al_lock_mutex(cache.mutex);
+   i = find_entry(filename, fi);
+   if (i >= 0) {
+      ALLEGRO_SAMPLE *shared;
+      slot = _al_vector_ref(&cache.entries, i);
+      shared = reference_entry(*slot);
+      al_unlock_mutex(cache.mutex);
+      al_free(entry->path);
+      al_free(entry);
+      if (!shared)
+         return spl;
+      al_destroy_sample(spl);
+      return shared;
+   }
+
+   slot = _al_vector_alloc_back(&cache.entries);
+   if (!slot) {
+      al_unlock_mutex(cache.mutex);
+      al_free(entry->path);
+      al_free(entry);
+      return spl;
+   }
+
+   /* The entry takes over the data; the sample just loaded becomes its
+    * first reference.
+    */
+   entry->data = *spl;
+   entry->data.cache_entry = NULL;
+   entry->size = (size_t)spl->len *
+      al_get_channel_count(spl->chan_conf) * al_get_audio_depth_size(spl->depth);
+   entry->refcount = 1;
+   spl->free_buf = false;
+   spl->cache_entry = entry;
+   *slot = entry;
+   cache.size += entry->size;
+   trim_cache();
+   al_unlock_mutex(cache.mutex);
+
+   return spl;
+}
+
+
+/* _al_kcm_release_cached_sample:
+ *  Drops a reference to a cache entry, when a sample that was loaded through
+ *  the cache is destroyed.
+ */
+void _al_kcm_release_cached_sample(SAMPLE_CACHE_ENTRY *entry)
+{
+   /* The cache was shut down while the sample was still alive. */
+   if (!cache.mutex) {
+      ASSERT(entry->refcount > 0);
+      if (--entry->refcount == 0)
+         destroy_entry(entry);
+      return;
+   }
+
+   al_lock_mutex(cache.mutex);
+   ASSERT(entry->refcount > 0);
+   entry->refcount--;
+   if (entry->refcount == 0)
+      trim_cache();
+   al_unlock_mutex(cache.mutex);
+}
+
+
+/* Function: al_set_sample_cache_size
+ */
+bool al_set_sample_cache_size(size_t bytes)
+{
+   if (!init_sample_cache())
+      return false;
+
+   al_lock_mutex(cache.mutex);
+   cache.budget = bytes;
+   trim_cache();
+   al_unlock_mutex(cache.mutex);
+
+   return true;
+}
+
+
+/* Function: al_get_sample_cache_stats
+ */
+void al_get_sample_cache_stats(unsigned int *hits, unsigned int *misses,
+   size_t *bytes)
+{
+   if (!init_sample_cache()) {
+      if (hits)
+         *hits = 0;
+      if (misses)
+         *misses = 0;
+      if (bytes)
+         *bytes = 0;
+      return;
+   }
+
+   al_lock_mutex(cache.mutex);
+   if (hits)
+      *hits = cache.hits;
+   if (misses)
+      *misses = cache.misses;
+   if (bytes)
+      *bytes = cache.size;
+   al_unlock_mutex(cache.mutex);
+}
+
+
+/* vim: set sts=3 sw=3 et: */
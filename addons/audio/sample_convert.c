@@ -0,0 +1,278 @@
+/*
+ * Copies of sample data converted to the depth of the mixers playing it,
+ * so that the mixers read it without converting every value on every pass.
+ */
+
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_audio.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_audio.h"
+#include "allegro5/internal/aintern_vector.h"
+
+ALLEGRO_DEBUG_CHANNEL("audio")
+
+
+/* One converted copy.  It is shared by every instance playing the same
+ * sample data through a mixer of the same depth, and kept until the data is
+ * freed (see _al_kcm_stop_sample_instances).
+ */
+typedef struct CONVERTED_SAMPLE {
+   const void *source;
+   ALLEGRO_AUDIO_DEPTH source_depth;
+   ALLEGRO_SAMPLE data;
+} CONVERTED_SAMPLE;
+
+
+static struct {
+   bool initialised;
+   ALLEGRO_MUTEX *mutex;
+   size_t size;
+   _AL_VECTOR copies;
+} converted = { false, NULL, 0, _AL_VECTOR_INITIALIZER(CONVERTED_SAMPLE *) };
+
+
+/* _al_kcm_shutdown_converted_samples:
+ *  Frees all the converted copies.  Called by al_uninstall_audio once the
+ *  destructors have destroyed the instances reading them.
+ */
+void _al_kcm_shutdown_converted_samples(void)
+{
+   unsigned int i;
+
+   for (i = 0; i < _al_vector_size(&converted.copies); i++) {
+      CONVERTED_SAMPLE **slot = _al_vector_ref(&converted.copies, i);
+      al_free((*slot)->data.buffer.ptr);
+      al_free(*slot);
+   }
+   _al_vector_free(&converted.copies);
+
+   if (converted.mutex)
+      al_destroy_mutex(converted.mutex);
+   converted.mutex = NULL;
+   converted.size = 0;
+   converted.initialised = false;
+}
+
+
+static bool init_converted_samples(void)
+{
+   if (converted.initialised)
+      return converted.mutex != NULL;
+   converted.initialised = true;
+
+   converted.mutex = al_create_mutex();
+   if (!converted.mutex) {
+      ALLEGRO_ERROR("Unable to create the converted sample mutex\n");
+      return false;
+   }
+
+   return true;
+}
+
+
+/* The conversions match those the mixer makes as it reads (see
+ * misc/make_mixer_helpers.py), so the copy sounds the same.
+ */
+static void convert_to_float(float *dst, const ALLEGRO_SAMPLE *src, size_t n)
+{
+   const any_buffer_t buf = src->buffer;
+   size_t i;
+
+   switch (src->depth) {
+      case ALLEGRO_AUDIO_DEPTH_INT8:
+         for (i = 0; i < n; i++)
+            dst[i] = (float) buf.s8[i] / ((float)0x7F + 0.5f);
+         break;
+      case ALLEGRO_AUDIO_DEPTH_UINT8:
+         for (i = 0; i < n; i++)
+            dst[i] = (float) buf.u8[i] / ((float)0x7F + 0.5f) - 1.0f;
+         break;
+      case ALLEGRO_AUDIO_DEPTH_INT16:
+         for (i = 0; i < n; i++)
+            dst[i] = (float) buf.s16[i] / ((float)0x7FFF + 0.5f);
+         break;
+      case ALLEGRO_AUDIO_DEPTH_UINT16:
+         for (i = 0; i < n; i++)
+            dst[i] = (float) buf.u16[i] / ((float)0x7FFF + 0.5f) - 1.0f;
+         break;
+      case ALLEGRO_AUDIO_DEPTH_INT24:
+         for (i = 0; i < n; i++)
+            dst[i] = (float) buf.s24[i] / ((float)0x7FFFFF + 0.5f);
+         break;
+      case ALLEGRO_AUDIO_DEPTH_UINT24:
+         for (i = 0; i < n; i++)
+            dst[i] = (float) buf.u24[i] / ((float)0x7FFFFF + 0.5f) - 1.0f;
+         break;
+      case ALLEGRO_AUDIO_DEPTH_FLOAT32:
+         memcpy(dst, buf.f32, n * sizeof(float));
+         break;
+   }
+}
+
+
+static void convert_to_int16(int16_t *dst, const ALLEGRO_SAMPLE *src,
+   size_t n)
+{
+   const any_buffer_t buf = src->buffer;
+   size_t i;
+
+   switch (src->depth) {
+      case ALLEGRO_AUDIO_DEPTH_INT8:
+         for (i = 0; i < n; i++)
+            dst[i] = (int16_t) buf.s8[i] << 7;
+         break;
+      case ALLEGRO_AUDIO_DEPTH_UINT8:
+         for (i = 0; i < n; i++)
+            dst[i] = (int16_t) (buf.u8[i] - 0x80) << 7;
+         break;
+      case ALLEGRO_AUDIO_DEPTH_INT16:
+         memcpy(dst, buf.s16, n * sizeof(int16_t));
+         break;
+      case ALLEGRO_AUDIO_DEPTH_UINT16:
+         for (i = 0; i < n; i++)
+            dst[i] = (int16_t) (buf.u16[i] - 0x8000);
+         break;
+      case ALLEGRO_AUDIO_DEPTH_INT24:
+         for (i = 0; i < n; i++)
+            dst[i] = (int16_t) (buf.s24[i] >> 9);
+         break;
+      case ALLEGRO_AUDIO_DEPTH_UINT24:
+         for (i = 0; i < n; i++)
+            dst[i] = (int16_t) ((buf.u24[i] - 0x800000) >> 9);
+         break;
+      case ALLEGRO_AUDIO_DEPTH_FLOAT32:
+         for (i = 0; i < n; i++)
+            dst[i] = (int16_t) (buf.f32[i] * 0x7FFF);
+         break;
+   }
+}
+
+
+static CONVERTED_SAMPLE *find_copy(const ALLEGRO_SAMPLE *src,
+   ALLEGRO_AUDIO_DEPTH depth)
+{
+   unsigned int i;
+
+   for (i = 0; i < _al_vector_size(&converted.copies); i++) {
+      CONVERTED_SAMPLE **slot = _al_vector_ref(&converted.copies, i);
+      CONVERTED_SAMPLE *copy = *slot;
+
+      if (copy->source == src->buffer.ptr &&
+            copy->source_depth == src->depth &&
+            copy->data.depth == depth &&
+            copy->data.chan_conf == src->chan_conf &&
+            copy->data.len == src->len) {
+         return copy;
+      }
+   }
+
+   return NULL;
+}
+
+
+/* _al_kcm_get_converted_sample:
+ *  Returns the sample data converted to `depth', converting it the first
+ *  time it is asked for.  Returns NULL if there is nothing to convert, or
+ *  the copy could not be made.
+ */
+const ALLEGRO_SAMPLE *_al_kcm_get_converted_sample(const ALLEGRO_SAMPLE *src,
+   ALLEGRO_AUDIO_DEPTH depth)
+{
+   CONVERTED_SAMPLE *copy;
+   CONVERTED_SAMPLE **slot;
+   size_t n;
+   int word_size;
+
+   if (!src->buffer.ptr || src->len <= 0 || src->depth == depth)
+      return NULL;
+   if (depth != ALLEGRO_AUDIO_DEPTH_FLOAT32 &&
+         depth != ALLEGRO_AUDIO_DEPTH_INT16)
+      return NULL;
+   if (!init_converted_samples())
+      return NULL;
+
+   al_lock_mutex(converted.mutex);
+
+   copy = find_copy(src, depth);
+   if (copy) {
+      al_unlock_mutex(converted.mutex);
+      return &copy->data;
+   }
+
+   n = (size_t)src->len * al_get_channel_count(src->chan_conf);
+   word_size = al_get_audio_depth_size(depth);
+
+   copy = al_calloc(1, sizeof(*copy));
+   slot = _al_vector_alloc_back(&converted.copies);
+   if (copy)
+      copy->data.buffer.ptr = al_malloc(n * word_size);
+   if (!copy || !slot || !copy->data.buffer.ptr) {
+      ALLEGRO_WARN("Out of memory converting sample data\n");
+      if (slot)
+         _al_vector_delete_at(&converted.copies,
+            _al_vector_size(&converted.copies) - 1);
+      if (copy)
+         al_free(copy->data.buffer.ptr);
+      al_free(copy);
+      al_unlock_mutex(converted.mutex);
+      return NULL;
+   }
+
+   copy->source = src->buffer.ptr;
+   copy->source_depth = src->depth;
+   copy->data.depth = depth;
+   copy->data.chan_conf = src->chan_conf;
+   copy->data.frequency = src->frequency;
+   copy->data.len = src->len;
+
+   if (depth == ALLEGRO_AUDIO_DEPTH_FLOAT32)
+      convert_to_float(copy->data.buffer.f32, src, n);
+   else
+      convert_to_int16(copy->data.buffer.s16, src, n);
+
+   *slot = copy;
+   converted.size += n * word_size;
+   ALLEGRO_DEBUG("Converted %d frames of sample data, %lu bytes in all\n",
+      src->len, (unsigned long)converted.size);
+
+   al_unlock_mutex(converted.mutex);
+
+   return &copy->data;
+}
+
+
+/* _al_kcm_forget_converted_samples:
+ *  Frees the copies converted from the given sample data.  No instance may
+ *  be reading them any more.
+ */
+void _al_kcm_forget_converted_samples(const void *buffer)
+{
+   unsigned int i;
+
+   if (!converted.mutex)
+      return;
+
+   al_lock_mutex(converted.mutex);
+
+   for (i = 0; i < _al_vector_size(&converted.copies); ) {
+      CONVERTED_SAMPLE **slot = _al_vector_ref(&converted.copies, i);
+      CONVERTED_SAMPLE *copy = *slot;
+
+      if (copy->source != buffer) {
+         i++;
+         continue;
+      }
+
+      converted.size -= (size_t)copy->data.len *
+         al_get_channel_count(copy->data.chan_conf) *
+         al_get_audio_depth_size(copy->data.depth);
+      _al_vector_delete_at(&converted.copies, i);
+      al_free(copy->data.buffer.ptr);
+      al_free(copy);
+   }
+
+   al_unlock_mutex(converted.mutex);
+}
+
+
+/* vim: set sts=3 sw=3 et: */
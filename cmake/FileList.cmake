@@ -39,6 +39,7 @@ set(ALLEGRO_SRC_FILES
     src/mouse_cursor.c
     src/path.c
     src/pixels.c
+    src/render_stats.c
     src/shader.c
     src/system.c
     src/threads.c
@@ -244,6 +245,7 @@ set(ALLEGRO_INCLUDE_ALLEGRO_FILES
     include/allegro5/mouse_cursor.h
     include/allegro5/path.h
     include/allegro5/render_state.h
+    include/allegro5/render_stats.h
     include/allegro5/shader.h
     include/allegro5/system.h
     include/allegro5/threads.h
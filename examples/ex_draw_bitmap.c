@@ -172,6 +172,7 @@ static void redraw(void)
    int h = al_get_display_height(example.display);
    int i;
    int f1, f2;
+   int64_t flushes, switches;
    int fh = al_get_font_line_height(example.font);
    char const *info[] = {"textures", "memory buffers"};
    char const *binfo[] = {"alpha", "additive", "tinted", "solid"};
@@ -192,6 +193,7 @@ static void redraw(void)
    else if (example.blending == 3)
       al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
 
+   al_reset_render_stats(example.display);
    if (example.hold_bitmap_drawing) {
       al_hold_bitmap_drawing(true);
    }
@@ -202,6 +204,10 @@ static void redraw(void)
    if (example.hold_bitmap_drawing) {
       al_hold_bitmap_drawing(false);
    }
+   flushes = al_get_render_stat(example.display,
+      ALLEGRO_RENDER_STAT_VERTEX_FLUSHES);
+   switches = al_get_render_stat(example.display,
+      ALLEGRO_RENDER_STAT_TEXTURE_SWITCHES);
 
    al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_INVERSE_ALPHA);
    if (example.show_help) {
@@ -226,6 +232,8 @@ static void redraw(void)
       f1, f2);
    al_draw_textf(example.font, example.white, w, fh, ALLEGRO_ALIGN_RIGHT, "%4d / sec",
       (int)(1.0 / example.direct_speed_measure));
+   al_draw_textf(example.font, example.white, w, fh * 2, ALLEGRO_ALIGN_RIGHT,
+      "flushes: %d (%d texture switches)", (int)flushes, (int)switches);
    
 }
 
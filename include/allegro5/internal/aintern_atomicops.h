@@ -1,6 +1,10 @@
 #ifndef __al_included_allegro5_aintern_atomicops_h
 #define __al_included_allegro5_aintern_atomicops_h
 
+/* _al_atomic_load has acquire and _al_atomic_store has release semantics,
+ * which is what single-producer/single-consumer queues need.
+ */
+
 #if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1)
 
    /* gcc 4.1 and above have builtin atomic operations. */
@@ -19,6 +23,21 @@
       return __sync_sub_and_fetch(ptr, 1);
    })
 
+   AL_INLINE(_AL_ATOMIC,
+      _al_atomic_load, (volatile _AL_ATOMIC *ptr),
+   {
+      _AL_ATOMIC value = *ptr;
+      __sync_synchronize();
+      return value;
+   })
+
+   AL_INLINE(void,
+      _al_atomic_store, (volatile _AL_ATOMIC *ptr, _AL_ATOMIC value),
+   {
+      __sync_synchronize();
+      *ptr = value;
+   })
+
 #elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
 
    /* gcc, x86 or x86-64 */
@@ -49,6 +68,24 @@
       return old - 1;
    })
 
+   /* x86 does not reorder loads with loads or stores with stores, so
+    * preventing compiler reordering is enough for acquire/release.
+    */
+   AL_INLINE(_AL_ATOMIC,
+      _al_atomic_load, (volatile _AL_ATOMIC *ptr),
+   {
+      _AL_ATOMIC value = *ptr;
+      __asm__ __volatile__ ("" ::: "memory");
+      return value;
+   })
+
+   AL_INLINE(void,
+      _al_atomic_store, (volatile _AL_ATOMIC *ptr, _AL_ATOMIC value),
+   {
+      __asm__ __volatile__ ("" ::: "memory");
+      *ptr = value;
+   })
+
 #elif defined(_MSC_VER) && _M_IX86 >= 400
 
    /* MSVC, x86 */
@@ -68,6 +105,21 @@
       return InterlockedDecrement(ptr);
    })
 
+   AL_INLINE(_AL_ATOMIC,
+      _al_atomic_load, (volatile _AL_ATOMIC *ptr),
+   {
+      _AL_ATOMIC value = *ptr;
+      MemoryBarrier();
+      return value;
+   })
+
+   AL_INLINE(void,
+      _al_atomic_store, (volatile _AL_ATOMIC *ptr, _AL_ATOMIC value),
+   {
+      MemoryBarrier();
+      *ptr = value;
+   })
+
 #elif defined(ALLEGRO_HAVE_OSATOMIC_H)
 
    /* OS X, GCC < 4.1
@@ -93,6 +145,21 @@
       return OSAtomicDecrement32Barrier((_AL_ATOMIC *)ptr);
    })
 
+   AL_INLINE(_AL_ATOMIC,
+      _al_atomic_load, (volatile _AL_ATOMIC *ptr),
+   {
+      _AL_ATOMIC value = *ptr;
+      OSMemoryBarrier();
+      return value;
+   })
+
+   AL_INLINE(void,
+      _al_atomic_store, (volatile _AL_ATOMIC *ptr, _AL_ATOMIC value),
+   {
+      OSMemoryBarrier();
+      *ptr = value;
+   })
+
 
 #else
 
@@ -113,6 +180,18 @@
       return --(*ptr);
    })
 
+   AL_INLINE(_AL_ATOMIC,
+      _al_atomic_load, (volatile _AL_ATOMIC *ptr),
+   {
+      return *ptr;
+   })
+
+   AL_INLINE(void,
+      _al_atomic_store, (volatile _AL_ATOMIC *ptr, _AL_ATOMIC value),
+   {
+      *ptr = value;
+   })
+
 #endif
 
 #endif
@@ -8,6 +8,8 @@
 
 void _al_configure_logging(void);
 void _al_shutdown_logging(void);
+void _al_release_trace_ring(void *ring, int generation);
+bool _al_trace_async_used(void);
 
 
 #ifdef __cplusplus
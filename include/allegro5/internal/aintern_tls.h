@@ -10,6 +10,9 @@ void _al_tls_init_once(void);
 
 int *_al_tls_get_dtor_owner_count(void);
 
+void **_al_tls_get_trace_ring(int **generation);
+void _al_tls_release_trace_ring(void);
+
 
 #ifdef __cplusplus
    }
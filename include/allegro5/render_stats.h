@@ -0,0 +1,53 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Render statistics counters.
+ *
+ *      See readme.txt for copyright information.
+ */
+
+#ifndef __al_included_allegro5_render_stats_h
+#define __al_included_allegro5_render_stats_h
+
+#include "allegro5/base.h"
+#include "allegro5/display.h"
+
+#ifdef __cplusplus
+   extern "C" {
+#endif
+
+/* Enum: ALLEGRO_RENDER_STAT
+ */
+enum ALLEGRO_RENDER_STAT {
+   ALLEGRO_RENDER_STAT_BITMAP_DRAWS = 0,
+   ALLEGRO_RENDER_STAT_VERTEX_FLUSHES = 1,
+   ALLEGRO_RENDER_STAT_TEXTURE_SWITCHES = 2,
+   ALLEGRO_RENDER_STAT_BITMAP_LOCKS = 3,
+   ALLEGRO_RENDER_STAT_FORMAT_CONVERSIONS = 4,
+   ALLEGRO_RENDER_STAT_UPLOADED_BYTES = 5,
+   ALLEGRO_RENDER_STAT_FLIPS = 6,
+   ALLEGRO_RENDER_STAT_COUNT
+};
+
+AL_FUNC(int64_t, al_get_render_stat, (ALLEGRO_DISPLAY *display, int stat));
+AL_FUNC(void, al_reset_render_stats, (ALLEGRO_DISPLAY *display));
+
+#ifdef __cplusplus
+   }
+#endif
+
+#endif
+
+/*
+ * Local Variables:
+ * c-basic-offset: 3
+ * indent-tabs-mode: nil
+ * End:
+ */
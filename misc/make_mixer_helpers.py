@@ -1,7 +1,18 @@
 #!/usr/bin/env python
 #
 # Run:
-#  python misc/make_resamplers.py | indent -kr -i3 -l0
+#  python misc/make_mixer_helpers.py | indent -kr -i3 -l0
+#
+# Each generated resampler fills a block of `n' frames, starting at the
+# current sample position and stepping with the Bresenham state passed in
+# by the mixer.  The caller guarantees that the position stays clear of the
+# loop points for the whole block (see frames_before_boundary), so only the
+# neighbouring sample values used for interpolation need to wrap.
+#
+# The sample values are read from the copy converted to the mixer depth
+# when there is one (see al_set_mixer_preconvert_samples).
+
+from __future__ import print_function
 
 import sys, re
 
@@ -28,6 +39,14 @@ class Depth_f32(Depth):
       return interp("#{buf}.f32[ #{index} ]")
    def index_s16(self, buf, index):
       return interp("(int16_t) (#{buf}.f32[ #{index} ] * 0x7FFF)")
+   def raw(self, buf, index):
+      return interp("#{buf}.f32[ #{index} ]")
+   def from_raw(self, value):
+      return value
+   def s16_from_raw(self, value):
+      return interp("#{value} * 0x7FFF")
+   def raw_silence(self):
+      return "0.0f"
 
 class Depth_int24(Depth):
    def constant(self):
@@ -36,6 +55,14 @@ class Depth_int24(Depth):
       return interp("(float) #{buf}.s24[ #{index} ] / ((float)0x7FFFFF + 0.5f)")
    def index_s16(self, buf, index):
       return interp("(int16_t) (#{buf}.s24[ #{index} ] >> 9)")
+   def raw(self, buf, index):
+      return interp("(float) #{buf}.s24[ #{index} ]")
+   def from_raw(self, value):
+      return interp("#{value} / ((float)0x7FFFFF + 0.5f)")
+   def s16_from_raw(self, value):
+      return interp("#{value} * (1.0f / 512)")
+   def raw_silence(self):
+      return "0.0f"
 
 class Depth_uint24(Depth):
    def constant(self):
@@ -44,6 +71,14 @@ class Depth_uint24(Depth):
       return interp("(float) #{buf}.u24[ #{index} ] / ((float)0x7FFFFF + 0.5f) - 1.0f")
    def index_s16(self, buf, index):
       return interp("(int16_t) ((#{buf}.u24[ #{index} ] - 0x800000) >> 9)")
+   def raw(self, buf, index):
+      return interp("(float) #{buf}.u24[ #{index} ]")
+   def from_raw(self, value):
+      return interp("#{value} / ((float)0x7FFFFF + 0.5f) - 1.0f")
+   def s16_from_raw(self, value):
+      return interp("(#{value} - (float)0x800000) * (1.0f / 512)")
+   def raw_silence(self):
+      return "(float)0x800000"
 
 class Depth_int16(Depth):
    def constant(self):
@@ -52,6 +87,14 @@ class Depth_int16(Depth):
       return interp("(float) #{buf}.s16[ #{index} ] / ((float)0x7FFF + 0.5f)")
    def index_s16(self, buf, index):
       return interp("#{buf}.s16[ #{index} ]")
+   def raw(self, buf, index):
+      return interp("(float) #{buf}.s16[ #{index} ]")
+   def from_raw(self, value):
+      return interp("#{value} / ((float)0x7FFF + 0.5f)")
+   def s16_from_raw(self, value):
+      return value
+   def raw_silence(self):
+      return "0.0f"
 
 class Depth_uint16(Depth):
    def constant(self):
@@ -60,6 +103,14 @@ class Depth_uint16(Depth):
       return interp("(float) #{buf}.u16[ #{index} ] / ((float)0x7FFF + 0.5f) - 1.0f")
    def index_s16(self, buf, index):
       return interp("(int16_t) (#{buf}.u16[ #{index} ] - 0x8000)")
+   def raw(self, buf, index):
+      return interp("(float) #{buf}.u16[ #{index} ]")
+   def from_raw(self, value):
+      return interp("#{value} / ((float)0x7FFF + 0.5f) - 1.0f")
+   def s16_from_raw(self, value):
+      return interp("#{value} - (float)0x8000")
+   def raw_silence(self):
+      return "(float)0x8000"
 
 class Depth_int8(Depth):
    def constant(self):
@@ -68,6 +119,14 @@ class Depth_int8(Depth):
       return interp("(float) #{buf}.s8[ #{index} ] / ((float)0x7F + 0.5f)")
    def index_s16(self, buf, index):
       return interp("(int16_t) #{buf}.s8[ #{index} ] << 7")
+   def raw(self, buf, index):
+      return interp("(float) #{buf}.s8[ #{index} ]")
+   def from_raw(self, value):
+      return interp("#{value} / ((float)0x7F + 0.5f)")
+   def s16_from_raw(self, value):
+      return interp("#{value} * 128.0f")
+   def raw_silence(self):
+      return "0.0f"
 
 class Depth_uint8(Depth):
    def constant(self):
@@ -76,6 +135,14 @@ class Depth_uint8(Depth):
       return interp("(float) #{buf}.u8[ #{index} ] / ((float)0x7F + 0.5f) - 1.0f")
    def index_s16(self, buf, index):
       return interp("(int16_t) (#{buf}.u8[ #{index} ] - 0x80) << 7")
+   def raw(self, buf, index):
+      return interp("(float) #{buf}.u8[ #{index} ]")
+   def from_raw(self, value):
+      return interp("#{value} / ((float)0x7F + 0.5f) - 1.0f")
+   def s16_from_raw(self, value):
+      return interp("(#{value} - (float)0x80) * 128.0f")
+   def raw_silence(self):
+      return "(float)0x80"
 
 depths = [
    Depth_f32(),
@@ -87,220 +154,358 @@ depths = [
    Depth_uint8()
 ]
 
+ctype = {
+   "f32": "float",
+   "s16": "int16_t"
+}
+
+def print_header(name, fmt):
+   print(interp("""\
+static INLINE void #{name}(#{ctype[fmt]} *dst,
+   ALLEGRO_SAMPLE_INSTANCE *spl, unsigned int maxc, unsigned int n,
+   int delta, int delta_error)
+{
+   const ALLEGRO_SAMPLE *data = spl->converted ? spl->converted : &spl->spl_data;
+   const int step_denom = spl->step_denom;
+   int pos = spl->pos;
+   int err = spl->pos_bresenham_error;
+   unsigned int f;"""))
+
+def print_frame_loop_begin():
+   print("""\
+      for (f = 0; f < n; f++) {""")
+
+def print_frame_loop_end():
+   print("""\
+         dst += maxc;
+         pos += delta;
+         err += delta_error;
+         if (err >= step_denom) {
+            pos++;
+            err -= step_denom;
+         }
+      }""")
+
+def print_footer():
+   print("""\
+   }
+
+   spl->pos = pos;
+   spl->pos_bresenham_error = err;
+}
+""")
+
 def make_point_interpolator(name, fmt):
-   print interp("""\
-   static INLINE const void *
-      #{name}
-      (SAMP_BUF *samp_buf,
-       const ALLEGRO_SAMPLE_INSTANCE *spl,
-       unsigned int maxc)
-   {
-      unsigned int i0 = spl->pos*maxc;
-      unsigned int i;
-
-      switch (spl->spl_data.depth) {
-      """)
+   print_header(name, fmt)
+   print("""\
+   unsigned int i;
 
-   for depth in depths:
-      buf_index = depth.index(fmt)("spl->spl_data.buffer", "i0 + i")
-      print interp("""\
-         case #{depth.constant()}:
-            for (i = 0; i < maxc; i++) {
-               samp_buf-> #{fmt} [i] = #{buf_index};
-            }
-            break;
-         """)
+   switch (data->depth) {
+""")
 
-   print interp("""\
-      }
-      return samp_buf-> #{fmt} ;
-   }""")
+   for depth in depths:
+      buf_index = depth.index(fmt)("data->buffer", "i0 + i")
+      print(interp("""\
+   case #{depth.constant()}:"""))
+      print_frame_loop_begin()
+      print(interp("""\
+         const unsigned int i0 = pos * maxc;
+         for (i = 0; i < maxc; i++) {
+            dst[i] = #{buf_index};
+         }"""))
+      print_frame_loop_end()
+      print("""\
+      break;
+""")
+
+   print_footer()
 
 def make_linear_interpolator(name, fmt):
    assert fmt == "f32" or fmt == "s16"
 
-   print interp("""\
-   static INLINE const void *
-      #{name}
-      (SAMP_BUF *samp_buf,
-       const ALLEGRO_SAMPLE_INSTANCE *spl,
-       unsigned int maxc)
-   {
-      int p0 = spl->pos;
-      int p1 = spl->pos+1;
-
-      switch (spl->loop) {
-         case ALLEGRO_PLAYMODE_ONCE:
-            if (p1 >= spl->spl_data.len)
-               p1 = p0;
-            break;
-         case ALLEGRO_PLAYMODE_LOOP:
-            if (p1 >= spl->loop_end)
-               p1 = spl->loop_start;
-            break;
-         case ALLEGRO_PLAYMODE_BIDIR:
-            if (p1 >= spl->loop_end) {
-               p1 = spl->loop_end - 1;
-               if (p1 < spl->loop_start)
-                  p1 = spl->loop_start;
-            }
-            break;
-         case _ALLEGRO_PLAYMODE_STREAM_ONCE:
-         case _ALLEGRO_PLAYMODE_STREAM_ONEDIR:""" +
-            # For audio streams, sample i+1 may be in the next buffer fragment,
-            # which may not even be generated yet.  So we lag by one sample and
-            # interpolate between sample i-1 and sample i.
-            #
-            # We arrange the buffers in memory such that indexing i-1 is always
-            # valid, even after wrapping around from the last buffer fragment to
-            # the first buffer fragment.  See _al_kcm_refill_stream.
-            """
-            p0--;
-            p1--;
-            break;
-      }
-
-      p0 *= maxc;
-      p1 *= maxc;
-
-      switch (spl->spl_data.depth) {
-      """)
+   print_header(name, fmt)
+   # Sample i+1 is clamped or wrapped once it reaches `hi'.
+   #
+   # For audio streams, sample i+1 may be in the next buffer fragment,
+   # which may not even be generated yet.  So we lag by one sample and
+   # interpolate between sample i-1 and sample i.
+   #
+   # We arrange the buffers in memory such that indexing i-1 is always
+   # valid, even after wrapping around from the last buffer fragment to
+   # the first buffer fragment.  See _al_kcm_refill_stream.
+   print("""\
+   int hi = INT_MAX;
+   int hi_to = 0;
+   int lag = 0;
+
+   switch (spl->loop) {
+   case ALLEGRO_PLAYMODE_ONCE:
+      hi = spl->spl_data.len;
+      hi_to = spl->spl_data.len - 1;
+      break;
+   case ALLEGRO_PLAYMODE_LOOP:
+      hi = spl->loop_end;
+      hi_to = spl->loop_start;
+      break;
+   case ALLEGRO_PLAYMODE_BIDIR:
+      hi = spl->loop_end;
+      hi_to = spl->loop_end - 1;
+      if (hi_to < spl->loop_start)
+         hi_to = spl->loop_start;
+      break;
+   case _ALLEGRO_PLAYMODE_STREAM_ONCE:
+   case _ALLEGRO_PLAYMODE_STREAM_ONEDIR:
+      lag = -1;
+      break;
+   }
+
+   switch (data->depth) {
+""")
 
    for depth in depths:
-      x0 = depth.index(fmt)("spl->spl_data.buffer", "p0 + i")
-      x1 = depth.index(fmt)("spl->spl_data.buffer", "p1 + i")
-      print interp("""\
-         case #{depth.constant()}:
-         {""")
+      x0 = depth.index(fmt)("data->buffer", "p0 + i")
+      x1 = depth.index(fmt)("data->buffer", "p1 + i")
+      print(interp("""\
+   case #{depth.constant()}:"""))
+      print_frame_loop_begin()
 
       if fmt == "f32":
-         print interp("""\
-            const float t = (float)spl->pos_bresenham_error / spl->step_denom;
-            int i;
-            for (i = 0; i < (int)maxc; i++) {
-               const float x0 = #{x0};
-               const float x1 = #{x1};
-               const float s = (x0 * (1.0f - t)) + (x1 * t);
-               samp_buf->f32[i] = s;
-            }""")
+         print(interp("""\
+         const float t = (float)err / step_denom;
+         int p0 = pos;
+         int p1 = pos + 1;
+         int i;
+         if (p1 >= hi)
+            p1 = hi_to;
+         p0 = (p0 + lag) * maxc;
+         p1 = (p1 + lag) * maxc;
+         for (i = 0; i < (int)maxc; i++) {
+            const float x0 = #{x0};
+            const float x1 = #{x1};
+            const float s = (x0 * (1.0f - t)) + (x1 * t);
+            dst[i] = s;
+         }"""))
       elif fmt == "s16":
-         print interp("""\
-            const int32_t t = 256 * spl->pos_bresenham_error / spl->step_denom;
-            int i;
-            for (i = 0; i < (int)maxc; i++) {
-               const int32_t x0 = #{x0};
-               const int32_t x1 = #{x1};
-               const int32_t s = ((x0 * (256 - t))>>8) + ((x1 * t)>>8);
-               samp_buf->s16[i] = (int16_t)s;
-            }""")
-
-      print interp("""\
-         }
-         break;
-         """)
-
-   print interp("""\
-      }
-      return samp_buf-> #{fmt};
-   }""")
+         print(interp("""\
+         const int32_t t = 256 * err / step_denom;
+         int p0 = pos;
+         int p1 = pos + 1;
+         int i;
+         if (p1 >= hi)
+            p1 = hi_to;
+         p0 = (p0 + lag) * maxc;
+         p1 = (p1 + lag) * maxc;
+         for (i = 0; i < (int)maxc; i++) {
+            const int32_t x0 = #{x0};
+            const int32_t x1 = #{x1};
+            const int32_t s = ((x0 * (256 - t))>>8) + ((x1 * t)>>8);
+            dst[i] = (int16_t)s;
+         }"""))
+
+      print_frame_loop_end()
+      print("""\
+      break;
+""")
+
+   print_footer()
 
 def make_cubic_interpolator(name, fmt):
    assert fmt == "f32"
 
-   print interp("""\
-   static INLINE const void *
-      #{name}
-      (SAMP_BUF *samp_buf,
-       const ALLEGRO_SAMPLE_INSTANCE *spl,
-       unsigned int maxc)
-   {
-      int p0 = spl->pos-1;
-      int p1 = spl->pos;
-      int p2 = spl->pos+1;
-      int p3 = spl->pos+2;
-
-      switch (spl->loop) {
-         case ALLEGRO_PLAYMODE_ONCE:
-            if (p0 < 0)
-               p0 = 0;
-            if (p2 >= spl->spl_data.len)
-               p2 = spl->spl_data.len - 1;
-            if (p3 >= spl->spl_data.len)
-               p3 = spl->spl_data.len - 1;
-            break;
-         case ALLEGRO_PLAYMODE_LOOP:
-         case ALLEGRO_PLAYMODE_BIDIR:
-            /* These positions should really wrap/bounce instead of clamping
-             * but it's probably unnoticeable.
-             */
-            if (p0 < spl->loop_start)
-               p0 = spl->loop_end - 1;
-            if (p2 >= spl->loop_end)
-               p2 = spl->loop_start;
-            if (p3 >= spl->loop_end)
-               p3 = spl->loop_start;
-            break;
-         case _ALLEGRO_PLAYMODE_STREAM_ONCE:
-         case _ALLEGRO_PLAYMODE_STREAM_ONEDIR:
-            /* Lag by three samples in total. */
-            p0 -= 2;
-            p1 -= 2;
-            p2 -= 2;
-            p3 -= 2;
-            break;
-      }
-
-      p0 *= maxc;
-      p1 *= maxc;
-      p2 *= maxc;
-      p3 *= maxc;
-
-      switch (spl->spl_data.depth) {
-      """)
+   print_header(name, fmt)
+   # For looping samples the outer positions should really wrap/bounce
+   # instead of clamping but it's probably unnoticeable.
+   #
+   # Audio streams lag by three samples in total.
+   print("""\
+   int lo = INT_MIN;
+   int lo_to = 0;
+   int hi = INT_MAX;
+   int hi_to = 0;
+   int lag = 0;
+
+   switch (spl->loop) {
+   case ALLEGRO_PLAYMODE_ONCE:
+      lo = 0;
+      lo_to = 0;
+      hi = spl->spl_data.len;
+      hi_to = spl->spl_data.len - 1;
+      break;
+   case ALLEGRO_PLAYMODE_LOOP:
+   case ALLEGRO_PLAYMODE_BIDIR:
+      lo = spl->loop_start;
+      lo_to = spl->loop_end - 1;
+      hi = spl->loop_end;
+      hi_to = spl->loop_start;
+      break;
+   case _ALLEGRO_PLAYMODE_STREAM_ONCE:
+   case _ALLEGRO_PLAYMODE_STREAM_ONEDIR:
+      lag = -2;
+      break;
+   }
+
+   switch (data->depth) {
+""")
 
    for depth in depths:
-      value0 = depth.index(fmt)("spl->spl_data.buffer", "p0 + i")
-      value1 = depth.index(fmt)("spl->spl_data.buffer", "p1 + i")
-      value2 = depth.index(fmt)("spl->spl_data.buffer", "p2 + i")
-      value3 = depth.index(fmt)("spl->spl_data.buffer", "p3 + i")
+      value0 = depth.index(fmt)("data->buffer", "p0 + i")
+      value1 = depth.index(fmt)("data->buffer", "p1 + i")
+      value2 = depth.index(fmt)("data->buffer", "p2 + i")
+      value3 = depth.index(fmt)("data->buffer", "p3 + i")
       # 4-point, cubic Hermite interpolation
       # Code transcribed from "Polynomial Interpolators for High-Quality
       # Resampling of Oversampled Audio" by Olli Niemitalo
       # http://yehar.com/blog/?p=197
-      print interp("""\
-         case #{depth.constant()}:
-         {
-            const float t = (float)spl->pos_bresenham_error / spl->step_denom;
-            signed int i;
-            for (i = 0; i < (signed int)maxc; i++) {
-               float x0 = #{value0};
-               float x1 = #{value1};
-               float x2 = #{value2};
-               float x3 = #{value3};
-               float c0 = x1;
-               float c1 = 0.5f * (x2 - x0);
-               float c2 = x0 - (2.5f * x1) + (2.0f * x2) - (0.5f * x3);
-               float c3 = (0.5f * (x3 - x0)) + (1.5f * (x1 - x2));
-               float s = (((((c3 * t) + c2) * t) + c1) * t) + c0;
-               samp_buf->f32[i] = s;
+      print(interp("""\
+   case #{depth.constant()}:"""))
+      print_frame_loop_begin()
+      print(interp("""\
+         const float t = (float)err / step_denom;
+         int p0 = pos - 1;
+         int p1 = pos;
+         int p2 = pos + 1;
+         int p3 = pos + 2;
+         signed int i;
+         if (p0 < lo)
+            p0 = lo_to;
+         if (p2 >= hi)
+            p2 = hi_to;
+         if (p3 >= hi)
+            p3 = hi_to;
+         p0 = (p0 + lag) * maxc;
+         p1 = (p1 + lag) * maxc;
+         p2 = (p2 + lag) * maxc;
+         p3 = (p3 + lag) * maxc;
+         for (i = 0; i < (signed int)maxc; i++) {
+            float x0 = #{value0};
+            float x1 = #{value1};
+            float x2 = #{value2};
+            float x3 = #{value3};
+            float c0 = x1;
+            float c1 = 0.5f * (x2 - x0);
+            float c2 = x0 - (2.5f * x1) + (2.0f * x2) - (0.5f * x3);
+            float c3 = (0.5f * (x3 - x0)) + (1.5f * (x1 - x2));
+            float s = (((((c3 * t) + c2) * t) + c1) * t) + c0;
+            dst[i] = s;
+         }"""))
+      print_frame_loop_end()
+      print("""\
+      break;
+""")
+
+   print_footer()
+
+def make_sinc_interpolator(name, fmt):
+   assert fmt == "f32" or fmt == "s16"
+
+   print_header(name, fmt)
+   # Band-limited interpolation with the polyphase table built by
+   # _al_kcm_init_sinc_table.  Taps that fall outside [lo, hi) are mapped
+   # by sinc_tap_position, which wraps them around the loop or returns -1
+   # for silence.
+   #
+   # Audio streams lag by half the filter length so that the last tap is
+   # the current sample.  The band is chosen from the step so that playing
+   # a sample faster lowers the cutoff with it.
+   print("""\
+   const int band = sinc_band(spl);
+   int lo = INT_MIN;
+   int hi = INT_MAX;
+   int lag = 0;
+
+   switch (spl->loop) {
+   case ALLEGRO_PLAYMODE_ONCE:
+      lo = 0;
+      hi = spl->spl_data.len;
+      break;
+   case ALLEGRO_PLAYMODE_LOOP:
+   case ALLEGRO_PLAYMODE_BIDIR:
+      lo = spl->loop_start;
+      hi = spl->loop_end;
+      break;
+   case _ALLEGRO_PLAYMODE_STREAM_ONCE:
+   case _ALLEGRO_PLAYMODE_STREAM_ONEDIR:
+      lag = -SINC_TAPS/2;
+      break;
+   }
+
+   switch (data->depth) {
+""")
+
+   for depth in depths:
+      value = depth.raw("data->buffer", "(p + k) * maxc + i")
+      tap = depth.raw("data->buffer", "q * maxc + i")
+      silence = depth.raw_silence()
+      # The filter is applied to the raw sample values and the result
+      # converted once, which is exact since each phase sums to one.  The
+      # 16-bit result is scaled like the other 16-bit readers scale samples.
+      if fmt == "f32":
+         result = depth.from_raw("sinc_dot(x, h)")
+         store = interp("dst[i] = #{result};")
+      elif fmt == "s16":
+         result = depth.s16_from_raw("sinc_dot(x, h)")
+         store = interp("dst[i] = sinc_to_s16(#{result});")
+
+      print(interp("""\
+   case #{depth.constant()}:"""))
+      print_frame_loop_begin()
+      print("""\
+         const float *h = sinc_table[band][err * SINC_PHASES / step_denom];
+         const int p = pos + lag - (SINC_TAPS/2 - 1);
+         const bool inside = (p >= lo && p + SINC_TAPS <= hi);
+         float x[SINC_TAPS];
+         int i, k;""")
+      mono_value = depth.raw("data->buffer", "p + k")
+      mono_store = store.replace("dst[i]", "dst[0]")
+      # Mono samples are filtered straight from the contiguous sample data.
+      print(interp("""\
+         if (inside && maxc == 1) {
+            for (k = 0; k < SINC_TAPS; k++) {
+               x[k] = #{mono_value};
             }
-         }
-         break;
-         """)
+            #{mono_store}
+            dst += maxc;
+            pos += delta;
+            err += delta_error;
+            if (err >= step_denom) {
+               pos++;
+               err -= step_denom;
+            }
+            continue;
+         }"""))
+      print(interp("""\
+         for (i = 0; i < (int)maxc; i++) {
+            if (inside) {
+               for (k = 0; k < SINC_TAPS; k++) {
+                  x[k] = #{value};
+               }
+            }
+            else {
+               for (k = 0; k < SINC_TAPS; k++) {
+                  const int q = sinc_tap_position(spl, p + k);
+                  x[k] = (q < 0) ? #{silence} : #{tap};
+               }
+            }
+            #{store}
+         }"""))
+      print_frame_loop_end()
+      print("""\
+      break;
+""")
 
-   print interp("""\
-      }
-      return samp_buf-> #{fmt} ;
-   }""")
+   print_footer()
 
 if __name__ == "__main__":
-   print "// Warning: This file was created by make_resamplers.py - do not edit."
-   print "// vim: set ft=c:"
+   print("// Warning: This file was created by make_mixer_helpers.py - do not edit.")
+   print("// vim: set ft=c:")
+   print()
 
    make_point_interpolator("point_spl32", "f32")
    make_point_interpolator("point_spl16", "s16")
    make_linear_interpolator("linear_spl32", "f32")
    make_linear_interpolator("linear_spl16", "s16")
    make_cubic_interpolator("cubic_spl32", "f32")
+   make_sinc_interpolator("sinc_spl32", "f32")
+   make_sinc_interpolator("sinc_spl16", "s16")
 
 # vim: set sts=3 sw=3 et:
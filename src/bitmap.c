@@ -625,6 +625,9 @@ void _al_convert_bitmap_data(
    ASSERT(!_al_pixel_format_is_video_only(src_format));
    ASSERT(!_al_pixel_format_is_video_only(dst_format));
 
+   _al_add_render_stat(al_get_current_display(),
+      ALLEGRO_RENDER_STAT_FORMAT_CONVERSIONS, 1);
+
    (_al_convert_funcs[src_format][dst_format])(src, src_pitch,
       dst, dst_pitch, sx, sy, dx, dy, width, height);
 }
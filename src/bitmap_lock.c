@@ -17,9 +17,23 @@
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_display.h"
 #include "allegro5/internal/aintern_pixels.h"
 
 
+/* Number of bytes covered by the current lock, in the locked format. */
+static int64_t locked_region_size(ALLEGRO_BITMAP *bitmap)
+{
+   int format = bitmap->locked_region.format;
+   int block_width = al_get_pixel_block_width(format);
+   int block_height = al_get_pixel_block_height(format);
+   int64_t blocks_w = _al_get_least_multiple(bitmap->lock_w, block_width) / block_width;
+   int64_t blocks_h = _al_get_least_multiple(bitmap->lock_h, block_height) / block_height;
+
+   return blocks_w * blocks_h * al_get_pixel_block_size(format);
+}
+
+
 /* Function: al_lock_bitmap_region
  */
 ALLEGRO_LOCKED_REGION *al_lock_bitmap_region(ALLEGRO_BITMAP *bitmap,
@@ -116,6 +130,8 @@ ALLEGRO_LOCKED_REGION *al_lock_bitmap_region(ALLEGRO_BITMAP *bitmap,
    lr->data = (char*)lr->data + (x - xc) * lr->pixel_size + (y - yc) * lr->pitch;
 
    bitmap->locked = true;
+   _al_add_render_stat(_al_get_bitmap_display(bitmap),
+      ALLEGRO_RENDER_STAT_BITMAP_LOCKS, 1);
 
    return lr;
 }
@@ -141,6 +157,11 @@ void al_unlock_bitmap(ALLEGRO_BITMAP *bitmap)
    }
 
    if (!(al_get_bitmap_flags(bitmap) & ALLEGRO_MEMORY_BITMAP)) {
+      if (!(bitmap->lock_flags & ALLEGRO_LOCK_READONLY)) {
+         _al_add_render_stat(_al_get_bitmap_display(bitmap),
+            ALLEGRO_RENDER_STAT_UPLOADED_BYTES,
+            locked_region_size(bitmap));
+      }
       if (_al_pixel_format_is_compressed(bitmap->locked_region.format))
          bitmap->vt->unlock_compressed_region(bitmap);
       else
@@ -243,6 +264,8 @@ ALLEGRO_LOCKED_REGION *al_lock_bitmap_region_blocked(ALLEGRO_BITMAP *bitmap,
    }
 
    bitmap->locked = true;
+   _al_add_render_stat(_al_get_bitmap_display(bitmap),
+      ALLEGRO_RENDER_STAT_BITMAP_LOCKS, 1);
 
    return lr;
 }
@@ -17,8 +17,11 @@
 #include <stdio.h>
 
 #include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_atomicops.h"
 #include "allegro5/internal/aintern_debug.h"
 #include "allegro5/internal/aintern_thread.h"
+#include "allegro5/internal/aintern_tls.h"
 #include "allegro5/internal/aintern_vector.h"
 
 #ifdef ALLEGRO_ANDROID
@@ -42,6 +45,8 @@ typedef struct TRACE_INFO
    _AL_VECTOR excluded;
    /* Whether settings have been read from allegro5.cfg or not. */
    bool configured;
+   /* Whether messages are handed to the writer thread. */
+   bool async;
 } TRACE_INFO;
 
 
@@ -54,11 +59,66 @@ static TRACE_INFO trace_info =
    7,
    _AL_VECTOR_INITIALIZER(ALLEGRO_USTR *),
    _AL_VECTOR_INITIALIZER(ALLEGRO_USTR *),
+   false,
    false
 };
 
 static char static_trace_buffer[2048];
 
+
+/* Asynchronous logging.
+ *
+ * Each thread that logs gets its own single-producer/single-consumer ring
+ * of messages.  _al_trace_prefix reserves the entry at the head and records
+ * the call site and time, _al_trace_suffix formats the message into it and
+ * publishes it.  A writer thread drains all rings and does the actual
+ * output, so the logging threads never block on a mutex or on I/O.  If a
+ * ring is full the message is dropped and counted instead.
+ */
+#define TRACE_RING_SIZE       256   /* must be a power of two */
+#define TRACE_MESSAGE_SIZE    512
+#define TRACE_WRITER_PERIOD   0.01
+
+typedef struct TRACE_ENTRY
+{
+   char const *channel;
+   char const *file;
+   char const *function;
+   int level;
+   int line;
+   double timestamp;
+   char message[TRACE_MESSAGE_SIZE];
+} TRACE_ENTRY;
+
+typedef struct TRACE_RING
+{
+   struct TRACE_RING *next;
+   volatile _AL_ATOMIC head;     /* only written by the owning thread */
+   volatile _AL_ATOMIC tail;     /* only written by the writer thread */
+   volatile _AL_ATOMIC dropped;  /* only written by the owning thread */
+   int dropped_reported;         /* only used by the writer thread */
+   bool owned;                   /* protected by the mutex */
+   TRACE_ENTRY entries[TRACE_RING_SIZE];
+} TRACE_RING;
+
+typedef struct TRACE_ASYNC
+{
+   bool running;
+   _AL_THREAD thread;
+   _AL_MUTEX mutex;     /* protects the list of rings and the cond */
+   _AL_COND cond;
+   TRACE_RING *rings;
+   /* Incremented whenever the rings are freed, so that threads notice
+    * their cached ring pointer is stale.
+    */
+   int generation;
+} TRACE_ASYNC;
+
+static TRACE_ASYNC trace_async;
+
+static void start_trace_writer(void);
+static void stop_trace_writer(void);
+
 /* run-time assertions */
 void (*_al_user_assert_handler)(char const *expr, char const *file,
    int line, char const *func);
@@ -84,6 +144,9 @@ void _al_configure_logging(void)
    char const *v;
    bool got_all = false;
 
+   /* The writer thread uses trace_mutex, which is re-initialised below. */
+   stop_trace_writer();
+
    config = al_get_system_config();
    v = al_get_config_value(config, "trace", "channels");
    if (v) {
@@ -156,8 +219,14 @@ void _al_configure_logging(void)
    else
       trace_info.flags &= ~1;
 
+   v = al_get_config_value(config, "trace", "async");
+   trace_info.async = (v && strcmp(v, "0"));
+
    _al_mutex_init(&trace_info.trace_mutex);
 
+   if (trace_info.async)
+      start_trace_writer();
+
    trace_info.configured = true;
 }
 
@@ -211,49 +280,27 @@ static void do_trace(const char *msg, ...)
 }
 
 
-/* _al_trace_prefix:
- *  Conditionally write the initial part of a trace message.  If we do, return true
- *  and continue to hold the trace_mutex lock.
- */
-bool _al_trace_prefix(char const *channel, int level,
-   char const *file, int line, char const *function)
+static double trace_time(void)
 {
-   size_t i;
-   char *name;
-   _AL_VECTOR const *v;
-
-   if (!trace_info.configured) {
-      _al_configure_logging();
-   }
-
-   if (level < trace_info.level)
-      return false;
-
-   v = &trace_info.channels;
-   if (_al_vector_is_empty(v))
-      goto channel_included;
-
-   for (i = 0; i < _al_vector_size(v); i++) {
-      ALLEGRO_USTR **iter = _al_vector_ref(v, i);
-      if (!strcmp(al_cstr(*iter), channel))
-         goto channel_included;
-   }
-
-   return false;
-
-channel_included:
+   double t = al_get_time();
+   /* Kludge:
+    * Very high timers (more than a year?) likely mean the timer
+    * subsystem isn't initialized yet, so print 0.
+    */
+   if (t > 3600 * 24 * 365)
+      t = 0;
+   return t;
+}
 
-   v = &trace_info.excluded;
-   if (_al_vector_is_nonempty(v)) {
-      for (i = 0; i < _al_vector_size(v); i++) {
-         ALLEGRO_USTR **iter = _al_vector_ref(v, i);
-         if (!strcmp(al_cstr(*iter), channel))
-            return false;
-      }
-   }
 
-   /* Avoid interleaved output from different threads. */
-   _al_mutex_lock(&trace_info.trace_mutex);
+/* write_prefix:
+ *  Write the initial part of a trace message.  The caller must hold the
+ *  trace_mutex lock.
+ */
+static void write_prefix(char const *channel, int level,
+   char const *file, int line, char const *function, double t)
+{
+   char *name;
 
    if (!_al_user_trace_handler)
       open_trace_file();
@@ -284,29 +331,17 @@ channel_included:
       do_trace("%-32s ", function);
    }
    if (trace_info.flags & 4) {
-      double t = al_get_time();
-      /* Kludge:
-       * Very high timers (more than a year?) likely mean the timer
-       * subsystem isn't initialized yet, so print 0.
-       */
-      if (t > 3600 * 24 * 365)
-         t = 0;
       do_trace("[%10.5f] ", t);
    }
-
-   /* Do not unlocked trace_mutex here; that is done by _al_trace_suffix. */
-   return true;
 }
 
 
-/* _al_trace_suffix:
- *  Output the final part of a trace message, and release the trace_mutex lock.
+/* write_suffix:
+ *  Write the final part of a trace message.  The caller must hold the
+ *  trace_mutex lock.
  */
-void _al_trace_suffix(const char *msg, ...)
+static void write_suffix(const char *msg, va_list ap)
 {
-   int olderr = errno;
-   va_list ap;
-
 #ifdef ALLEGRO_ANDROID
    if (true)
 #else
@@ -314,10 +349,8 @@ void _al_trace_suffix(const char *msg, ...)
 #endif
    {
       int s = strlen(static_trace_buffer);
-      va_start(ap, msg);
       vsnprintf(static_trace_buffer + s, sizeof(static_trace_buffer) - s,
          msg, ap);
-      va_end(ap);
 
       if (_al_user_trace_handler) {
          _al_user_trace_handler(static_trace_buffer);
@@ -331,13 +364,344 @@ void _al_trace_suffix(const char *msg, ...)
       static_trace_buffer[0] = '\0';
    }
    else if (trace_info.trace_file) {
-      va_start(ap, msg);
       vfprintf(trace_info.trace_file, msg, ap);
-      va_end(ap);
       fflush(trace_info.trace_file);
    }
+}
+
+
+static void write_entry(TRACE_ENTRY const *entry, const char *msg, ...)
+{
+   va_list ap;
+
+   write_prefix(entry->channel, entry->level, entry->file, entry->line,
+      entry->function, entry->timestamp);
+   va_start(ap, msg);
+   write_suffix(msg, ap);
+   va_end(ap);
+}
+
+
+/* drain_trace_ring:
+ *  Write out all messages published in a ring so far.  Only called from the
+ *  writer thread, or after it has been stopped.
+ */
+static void drain_trace_ring(TRACE_RING *ring)
+{
+   _AL_ATOMIC tail = ring->tail;
+   _AL_ATOMIC head = _al_atomic_load(&ring->head);
+   _AL_ATOMIC dropped = _al_atomic_load(&ring->dropped);
+
+   if (tail == head && dropped == ring->dropped_reported)
+      return;
+
+   _al_mutex_lock(&trace_info.trace_mutex);
+
+   while (tail != head) {
+      TRACE_ENTRY *entry = &ring->entries[tail & (TRACE_RING_SIZE - 1)];
+      write_entry(entry, "%s", entry->message);
+      tail++;
+      /* Hand the entry back to the logging thread. */
+      _al_atomic_store(&ring->tail, tail);
+   }
+
+   if (dropped != ring->dropped_reported) {
+      TRACE_ENTRY note;
+      note.channel = "trace";
+      note.file = __FILE__;
+      note.function = __func__;
+      note.level = 2;
+      note.line = __LINE__;
+      note.timestamp = trace_time();
+      write_entry(&note, "Dropped %d messages, ring buffer was full.\n",
+         (int)(dropped - ring->dropped_reported));
+      ring->dropped_reported = dropped;
+   }
 
    _al_mutex_unlock(&trace_info.trace_mutex);
+}
+
+
+static void drain_trace_rings(void)
+{
+   TRACE_RING *ring;
+
+   /* The list only ever grows while the writer runs, and new rings are
+    * prepended, so it is safe to walk it after reading the head.
+    */
+   _al_mutex_lock(&trace_async.mutex);
+   ring = trace_async.rings;
+   _al_mutex_unlock(&trace_async.mutex);
+
+   for (; ring; ring = ring->next) {
+      drain_trace_ring(ring);
+   }
+}
+
+
+static void trace_writer_proc(_AL_THREAD *thread, void *arg)
+{
+   ALLEGRO_TIMEOUT timeout;
+   (void)arg;
+
+   _al_mutex_lock(&trace_async.mutex);
+   while (!_al_get_thread_should_stop(thread)) {
+      _al_mutex_unlock(&trace_async.mutex);
+      drain_trace_rings();
+      _al_mutex_lock(&trace_async.mutex);
+
+      /* Logging threads never wake us, so that they never have to take a
+       * lock; poll instead.  We are only signalled when asked to stop.
+       */
+      al_init_timeout(&timeout, TRACE_WRITER_PERIOD);
+      _al_cond_timedwait(&trace_async.cond, &trace_async.mutex, &timeout);
+   }
+   _al_mutex_unlock(&trace_async.mutex);
+}
+
+
+static void start_trace_writer(void)
+{
+   if (trace_async.running)
+      return;
+
+   if (trace_async.generation == 0) {
+      _al_mutex_init(&trace_async.mutex);
+      _al_cond_init(&trace_async.cond);
+      trace_async.generation = 1;
+   }
+
+   _al_thread_create(&trace_async.thread, trace_writer_proc, NULL);
+   trace_async.running = true;
+}
+
+
+/* stop_trace_writer:
+ *  Stop the writer thread and write out anything left in the rings.
+ */
+static void stop_trace_writer(void)
+{
+   if (!trace_async.running)
+      return;
+
+   _al_mutex_lock(&trace_async.mutex);
+   _al_thread_set_should_stop(&trace_async.thread);
+   _al_cond_signal(&trace_async.cond);
+   _al_mutex_unlock(&trace_async.mutex);
+   _al_thread_join(&trace_async.thread);
+   trace_async.running = false;
+
+   drain_trace_rings();
+}
+
+
+static void free_trace_rings(void)
+{
+   ASSERT(!trace_async.running);
+
+   while (trace_async.rings) {
+      TRACE_RING *next = trace_async.rings->next;
+      al_free(trace_async.rings);
+      trace_async.rings = next;
+   }
+
+   if (trace_async.generation != 0) {
+      _al_cond_destroy(&trace_async.cond);
+      _al_mutex_destroy(&trace_async.mutex);
+      /* Invalidate all per-thread ring pointers. */
+      trace_async.generation++;
+   }
+}
+
+
+/* get_trace_ring:
+ *  Return the ring of the calling thread, taking over a ring released by
+ *  a thread which has exited or creating a new one if necessary.
+ */
+static TRACE_RING *get_trace_ring(void)
+{
+   int *generation;
+   void **slot = _al_tls_get_trace_ring(&generation);
+   TRACE_RING *ring;
+
+   if (!slot)
+      return NULL;
+   if (*slot && *generation == trace_async.generation)
+      return *slot;
+
+   /* This is the only time a logging thread takes the mutex. */
+   _al_mutex_lock(&trace_async.mutex);
+   for (ring = trace_async.rings; ring; ring = ring->next) {
+      if (!ring->owned)
+         break;
+   }
+   if (!ring) {
+      ring = al_calloc(1, sizeof *ring);
+      if (ring) {
+         ring->next = trace_async.rings;
+         trace_async.rings = ring;
+      }
+   }
+   if (ring)
+      ring->owned = true;
+   _al_mutex_unlock(&trace_async.mutex);
+   if (!ring)
+      return NULL;
+
+   *slot = ring;
+   *generation = trace_async.generation;
+   return ring;
+}
+
+
+/* _al_release_trace_ring:
+ *  Called when a thread exits with the ring it was logging into and the
+ *  generation it was obtained in.  The ring stays on the list so the
+ *  writer can drain what is left in it, and is handed to the next thread
+ *  which needs one.
+ */
+void _al_release_trace_ring(void *ring, int generation)
+{
+   if (!ring || generation == 0 || generation != trace_async.generation)
+      return;
+
+   _al_mutex_lock(&trace_async.mutex);
+   ((TRACE_RING *)ring)->owned = false;
+   _al_mutex_unlock(&trace_async.mutex);
+}
+
+
+/* _al_trace_async_used:
+ *  Whether asynchronous logging has been enabled at any point, i.e.
+ *  whether any thread may hold a ring.
+ */
+bool _al_trace_async_used(void)
+{
+   return trace_async.generation != 0;
+}
+
+
+/* async_trace_prefix:
+ *  Reserve the head entry of this thread's ring, recording the call site.
+ *  Returns false if the message is to be dropped.
+ */
+static bool async_trace_prefix(char const *channel, int level,
+   char const *file, int line, char const *function)
+{
+   TRACE_RING *ring = get_trace_ring();
+   TRACE_ENTRY *entry;
+   _AL_ATOMIC head;
+
+   if (!ring)
+      return false;
+
+   head = ring->head;
+   if (head - _al_atomic_load(&ring->tail) >= TRACE_RING_SIZE) {
+      _al_atomic_store(&ring->dropped, ring->dropped + 1);
+      return false;
+   }
+
+   entry = &ring->entries[head & (TRACE_RING_SIZE - 1)];
+   entry->channel = channel;
+   entry->file = file;
+   entry->function = function;
+   entry->level = level;
+   entry->line = line;
+   entry->timestamp = trace_time();
+   return true;
+}
+
+
+/* async_trace_suffix:
+ *  Format the message into the entry reserved by async_trace_prefix and
+ *  publish it to the writer thread.
+ */
+static void async_trace_suffix(const char *msg, va_list ap)
+{
+   TRACE_RING *ring = get_trace_ring();
+   TRACE_ENTRY *entry;
+   _AL_ATOMIC head;
+
+   ASSERT(ring);
+   head = ring->head;
+   entry = &ring->entries[head & (TRACE_RING_SIZE - 1)];
+   vsnprintf(entry->message, sizeof(entry->message), msg, ap);
+   _al_atomic_store(&ring->head, head + 1);
+}
+
+
+/* _al_trace_prefix:
+ *  Conditionally write the initial part of a trace message.  If we do, return true
+ *  and continue to hold the trace_mutex lock.  In asynchronous mode nothing
+ *  is written and no lock is held; the message is queued by _al_trace_suffix.
+ */
+bool _al_trace_prefix(char const *channel, int level,
+   char const *file, int line, char const *function)
+{
+   size_t i;
+   _AL_VECTOR const *v;
+
+   if (!trace_info.configured) {
+      _al_configure_logging();
+   }
+
+   if (level < trace_info.level)
+      return false;
+
+   v = &trace_info.channels;
+   if (_al_vector_is_empty(v))
+      goto channel_included;
+
+   for (i = 0; i < _al_vector_size(v); i++) {
+      ALLEGRO_USTR **iter = _al_vector_ref(v, i);
+      if (!strcmp(al_cstr(*iter), channel))
+         goto channel_included;
+   }
+
+   return false;
+
+channel_included:
+
+   v = &trace_info.excluded;
+   if (_al_vector_is_nonempty(v)) {
+      for (i = 0; i < _al_vector_size(v); i++) {
+         ALLEGRO_USTR **iter = _al_vector_ref(v, i);
+         if (!strcmp(al_cstr(*iter), channel))
+            return false;
+      }
+   }
+
+   if (trace_info.async)
+      return async_trace_prefix(channel, level, file, line, function);
+
+   /* Avoid interleaved output from different threads. */
+   _al_mutex_lock(&trace_info.trace_mutex);
+
+   write_prefix(channel, level, file, line, function,
+      (trace_info.flags & 4) ? trace_time() : 0);
+
+   /* Do not unlocked trace_mutex here; that is done by _al_trace_suffix. */
+   return true;
+}
+
+
+/* _al_trace_suffix:
+ *  Output the final part of a trace message, and release the trace_mutex lock.
+ */
+void _al_trace_suffix(const char *msg, ...)
+{
+   int olderr = errno;
+   va_list ap;
+
+   va_start(ap, msg);
+   if (trace_info.async) {
+      async_trace_suffix(msg, ap);
+   }
+   else {
+      write_suffix(msg, ap);
+      _al_mutex_unlock(&trace_info.trace_mutex);
+   }
+   va_end(ap);
 
    errno = olderr;
 }
@@ -345,6 +709,10 @@ void _al_trace_suffix(const char *msg, ...)
 
 void _al_shutdown_logging(void)
 {
+   stop_trace_writer();
+   free_trace_rings();
+   trace_info.async = false;
+
    if (trace_info.configured) {
       _al_mutex_destroy(&trace_info.trace_mutex);
 
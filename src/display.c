@@ -194,6 +194,7 @@ void al_flip_display(void)
    if (display) {
       ASSERT(display->vt);
       display->vt->flip_display(display);
+      _al_add_render_stat(display, ALLEGRO_RENDER_STAT_FLIPS, 1);
    }
 }
 
@@ -208,6 +209,7 @@ void al_update_display_region(int x, int y, int width, int height)
    if (display) {
       ASSERT(display->vt);
       display->vt->update_display_region(display, x, y, width, height);
+      _al_add_render_stat(display, ALLEGRO_RENDER_STAT_FLIPS, 1);
    }
 }
 
@@ -212,6 +212,7 @@ static void draw_quad(ALLEGRO_BITMAP *bitmap,
    (void)flags;
 
    if (disp->num_cache_vertices != 0 && ogl_bitmap->texture != disp->cache_texture) {
+      _al_add_render_stat(disp, ALLEGRO_RENDER_STAT_TEXTURE_SWITCHES, 1);
       disp->vt->flush_vertex_cache(disp);
    }
    disp->cache_texture = ogl_bitmap->texture;
@@ -0,0 +1,64 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Render statistics counters.
+ *
+ *      See readme.txt for copyright information.
+ */
+
+
+#include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_display.h"
+
+
+/* Counters summed over all displays, plus work done without a display
+ * (e.g. memory bitmap locks and conversions).  These are not protected
+ * by a lock: if several threads draw at the same time the global totals
+ * are only approximate, while the per-display counters stay exact.
+ */
+static int64_t global_render_stats[ALLEGRO_RENDER_STAT_COUNT];
+
+
+void _al_add_render_stat(ALLEGRO_DISPLAY *display, int stat, int64_t amount)
+{
+   ASSERT(stat >= 0 && stat < ALLEGRO_RENDER_STAT_COUNT);
+
+   if (display)
+      display->render_stats[stat] += amount;
+   global_render_stats[stat] += amount;
+}
+
+
+/* Function: al_get_render_stat
+ */
+int64_t al_get_render_stat(ALLEGRO_DISPLAY *display, int stat)
+{
+   if (stat < 0 || stat >= ALLEGRO_RENDER_STAT_COUNT)
+      return 0;
+
+   if (display)
+      return display->render_stats[stat];
+
+   return global_render_stats[stat];
+}
+
+
+/* Function: al_reset_render_stats
+ */
+void al_reset_render_stats(ALLEGRO_DISPLAY *display)
+{
+   if (display)
+      memset(display->render_stats, 0, sizeof(display->render_stats));
+   else
+      memset(global_render_stats, 0, sizeof(global_render_stats));
+}
+
+/* vim: set sts=3 sw=3 et: */
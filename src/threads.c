@@ -20,6 +20,7 @@
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_thread.h"
 #include "allegro5/internal/aintern_system.h"
+#include "allegro5/internal/aintern_tls.h"
 
 
 
@@ -83,6 +84,8 @@ static void thread_func_trampoline(_AL_THREAD *inner, void *_outer)
    if (system && system->vt && system->vt->thread_exit) {
       system->vt->thread_exit(outer);
    }
+
+   _al_tls_release_trace_ring();
 }
 
 
@@ -92,6 +95,7 @@ static void detached_thread_func_trampoline(_AL_THREAD *inner, void *_outer)
    (void)inner;
 
    ((void *(*)(void *))outer->proc)(outer->arg);
+   _al_tls_release_trace_ring();
    al_free(outer);
 }
 
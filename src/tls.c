@@ -39,6 +39,7 @@
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_debug.h"
 #include "allegro5/internal/aintern_display.h"
 #include "allegro5/internal/aintern_file.h"
 #include "allegro5/internal/aintern_fshook.h"
@@ -105,6 +106,10 @@ typedef struct thread_local_state {
 
    /* Destructor ownership count */
    int dtor_owner_count;
+
+   /* Asynchronous logging buffer, owned by debug.c */
+   void *trace_ring;
+   int trace_ring_generation;
 } thread_local_state;
 
 
@@ -150,6 +155,16 @@ static void initialize_tls_values(thread_local_state *tls)
 }
 
 
+/* Hand back resources owned by other modules when a thread's state is
+ * freed.
+ */
+static void release_tls_values(thread_local_state *tls)
+{
+   _al_release_trace_ring(tls->trace_ring, tls->trace_ring_generation);
+   tls->trace_ring = NULL;
+}
+
+
 // FIXME: The TLS implementation below only works for dynamic linking
 // right now - instead of using DllMain we should simply initialize
 // on first request.
@@ -955,4 +970,32 @@ int *_al_tls_get_dtor_owner_count(void)
 }
 
 
+void **_al_tls_get_trace_ring(int **generation)
+{
+   thread_local_state *tls;
+
+   if ((tls = tls_get()) == NULL)
+      return NULL;
+   *generation = &tls->trace_ring_generation;
+   return &tls->trace_ring;
+}
+
+
+/* Release the calling thread's logging ring, for threads about to exit.
+ * Not every TLS implementation can do this itself when a thread exits.
+ * Threads never get a ring unless asynchronous logging was enabled, so
+ * don't create their state just to find that out.
+ */
+void _al_tls_release_trace_ring(void)
+{
+   thread_local_state *tls;
+
+   if (!_al_trace_async_used())
+      return;
+   if ((tls = tls_get()) == NULL)
+      return;
+   release_tls_values(tls);
+}
+
+
 /* vim: set sts=3 sw=3 et: */
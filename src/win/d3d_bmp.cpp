@@ -156,6 +156,7 @@ static void d3d_draw_textured_quad(
    ALLEGRO_DISPLAY* aldisp = (ALLEGRO_DISPLAY*)disp;
 
    if (aldisp->num_cache_vertices != 0 && (uintptr_t)bmp != aldisp->cache_texture) {
+      _al_add_render_stat(aldisp, ALLEGRO_RENDER_STAT_TEXTURE_SWITCHES, 1);
       aldisp->vt->flush_vertex_cache(aldisp);
    }
    aldisp->cache_texture = (uintptr_t)bmp;
@@ -2693,6 +2693,8 @@ static void d3d_flush_vertex_cache(ALLEGRO_DISPLAY* disp)
    if (d3d_disp->device_lost)
       return;
 
+   _al_add_render_stat(disp, ALLEGRO_RENDER_STAT_VERTEX_FLUSHES, 1);
+
    if (bitmap_flags & ALLEGRO_MIN_LINEAR) {
       d3d_disp->device->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
    }